@@ -0,0 +1,25 @@
+// exit code: 14
+// Division and remainder cases the strength reduction special-cases. Each check adds one.
+int main(void) {
+    int min = -2147483647 - 1;
+    int x = 1000;
+    int y = -1000;
+    int byMinusOne = x / -1;
+    int remOne = y % 1;
+    int minBy8 = min / 8;
+    int minBy65536 = min / 65536;
+    int minRem8 = min % 8;
+    int negBy8 = -9 / 8;
+    int negRem16 = -17 % 16;
+    int by7 = x / 7;
+    int negBy7 = y / 7;
+    int byMinus7 = x / -7;
+    int rem7 = y % 7;
+    int remMinus7 = x % -7;
+    int minBy7 = min / 7;
+    int minByMinus7 = min / -7;
+    return (byMinusOne == -1000) + (remOne == 0) + (minBy8 == -268435456) +
+           (minBy65536 == -32768) + (minRem8 == 0) + (negBy8 == -1) + (negRem16 == -1) +
+           (by7 == 142) + (negBy7 == -142) + (byMinus7 == -142) + (rem7 == -6) +
+           (remMinus7 == 6) + (minBy7 == -306783378) + (minByMinus7 == 306783378);
+}
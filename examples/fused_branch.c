@@ -0,0 +1,9 @@
+// exit code: 10
+// A comparison fused into the jump that tests it, whose 0/1 result the jump target still reads
+int main(void) {
+    int a = 9;
+    int b = 7;
+    int c = a < b;
+    int d = c && (c = a - b);
+    return c + d + 10;
+}
@@ -0,0 +1,18 @@
+// exit code: 6
+// Multiples of powers of two, negative ones included, whose low bits value-range tracks.
+int main(void) {
+    int x = -37;
+    int y = x * 8;
+    int quarter = y / 4;
+    int rem = y % 4;
+    int odd = x * 2 + 1;
+    int negated = -y;
+    int score = 0;
+    score = score + (quarter == -74);
+    score = score + (rem == 0);
+    score = score + (odd != 0);
+    score = score + (negated % 8 == 0);
+    score = score + (negated / 8 == 37);
+    score = score + (odd % 2 == -1);
+    return score;
+}
@@ -0,0 +1,94 @@
+// exit code: 33
+// Enough values live at once that the frame is over the 128-byte red zone
+int main(void) {
+    int seed = 5;
+    int w0 = seed + 0;
+    int w1 = seed + 3;
+    int w2 = seed + 6;
+    int w3 = seed + 9;
+    int w4 = seed + 12;
+    int w5 = seed + 15;
+    int w6 = seed + 18;
+    int w7 = seed + 21;
+    int w8 = seed + 24;
+    int w9 = seed + 27;
+    int w10 = seed + 30;
+    int w11 = seed + 33;
+    int w12 = seed + 36;
+    int w13 = seed + 39;
+    int w14 = seed + 42;
+    int w15 = seed + 45;
+    int w16 = seed + 48;
+    int w17 = seed + 51;
+    int w18 = seed + 54;
+    int w19 = seed + 57;
+    int w20 = seed + 60;
+    int w21 = seed + 63;
+    int w22 = seed + 66;
+    int w23 = seed + 69;
+    int w24 = seed + 72;
+    int w25 = seed + 75;
+    int w26 = seed + 78;
+    int w27 = seed + 81;
+    int w28 = seed + 84;
+    int w29 = seed + 87;
+    int w30 = seed + 90;
+    int w31 = seed + 93;
+    int w32 = seed + 96;
+    int w33 = seed + 99;
+    int w34 = seed + 102;
+    int w35 = seed + 105;
+    int w36 = seed + 108;
+    int w37 = seed + 111;
+    int w38 = seed + 114;
+    int w39 = seed + 117;
+    int w40 = seed + 120;
+    int w41 = seed + 123;
+    int w42 = seed + 126;
+    int w43 = seed + 129;
+    w0 = w7 * w13 - w0;
+    w1 = w8 * w14 - w1;
+    w2 = w9 * w15 - w2;
+    w3 = w10 * w16 - w3;
+    w4 = w11 * w17 - w4;
+    w5 = w12 * w18 - w5;
+    w6 = w13 * w19 - w6;
+    w7 = w14 * w20 - w7;
+    w8 = w15 * w21 - w8;
+    w9 = w16 * w22 - w9;
+    w10 = w17 * w23 - w10;
+    w11 = w18 * w24 - w11;
+    w12 = w19 * w25 - w12;
+    w13 = w20 * w26 - w13;
+    w14 = w21 * w27 - w14;
+    w15 = w22 * w28 - w15;
+    w16 = w23 * w29 - w16;
+    w17 = w24 * w30 - w17;
+    w18 = w25 * w31 - w18;
+    w19 = w26 * w32 - w19;
+    w20 = w27 * w33 - w20;
+    w21 = w28 * w34 - w21;
+    w22 = w29 * w35 - w22;
+    w23 = w30 * w36 - w23;
+    w24 = w31 * w37 - w24;
+    w25 = w32 * w38 - w25;
+    w26 = w33 * w39 - w26;
+    w27 = w34 * w40 - w27;
+    w28 = w35 * w41 - w28;
+    w29 = w36 * w42 - w29;
+    w30 = w37 * w43 - w30;
+    w31 = w38 * w0 - w31;
+    w32 = w39 * w1 - w32;
+    w33 = w40 * w2 - w33;
+    w34 = w41 * w3 - w34;
+    w35 = w42 * w4 - w35;
+    w36 = w43 * w5 - w36;
+    w37 = w0 * w6 - w37;
+    w38 = w1 * w7 - w38;
+    w39 = w2 * w8 - w39;
+    w40 = w3 * w9 - w40;
+    w41 = w4 * w10 - w41;
+    w42 = w5 * w11 - w42;
+    w43 = w6 * w12 - w43;
+    return (w0 + w1 + w2 + w3 + w4 + w5 + w6 + w7 + w8 + w9 + w10 + w11 + w12 + w13 + w14 + w15 + w16 + w17 + w18 + w19 + w20 + w21 + w22 + w23 + w24 + w25 + w26 + w27 + w28 + w29 + w30 + w31 + w32 + w33 + w34 + w35 + w36 + w37 + w38 + w39 + w40 + w41 + w42 + w43) % 199;
+}
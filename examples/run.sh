@@ -0,0 +1,34 @@
+#!/bin/sh
+# Builds every example that starts with "// exit code: N" with each flag set below and checks
+# the exit code. The folding passes are switched off in most sets, so the arithmetic runs in
+# the compiled program rather than at compile time.
+# usage: examples/run.sh [path to antcc]
+antcc=$(realpath "${1:-./antcc}")
+examples=$(dirname "$(realpath "$0")")
+nofold=-fpass=-partial-eval,-sccp,-value-range,-gvn,-reassociate,-dce
+# value-range rewrites what it can prove but nothing folds after it
+rangeonly=-fpass=-partial-eval,-sccp
+# nothing folds, but gvn still propagates copies of comparison results into the branches
+copyprop=-fpass=-partial-eval,-sccp,-value-range,-reassociate
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+cd "$work" || exit 1
+
+failed=0
+for source in "$examples"/*.c; do
+    expected=$(sed -n '1s|^// exit code: \([0-9]*\)$|\1|p' "$source")
+    [ -n "$expected" ] || continue
+    name=$(basename "$source" .c)
+    for flags in "" -O0 -O1 "$nofold" "$nofold -fpass=-regalloc" "$nofold -fpass=+egraph" "$rangeonly" "$copyprop" "-O0 -fpass=+regalloc"; do
+        rm -f "$name" "$name.s"
+        "$antcc" "$source" --emit $flags > /dev/null && gcc "$name.s" -o "$name" 2> /dev/null
+        ./"$name"
+        actual=$?
+        if [ "$actual" != "$expected" ]; then
+            echo "FAIL $name ($flags): exit code $actual, expected $expected"
+            failed=1
+        fi
+    done
+done
+[ "$failed" = 0 ] && echo "all examples passed"
+exit $failed
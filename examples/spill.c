@@ -0,0 +1,30 @@
+// exit code: 64
+// More values live at once than there are allocatable registers, so some must spill
+int main(void) {
+    int seed = 3;
+    int v0 = seed * 2 + 0;
+    int v1 = seed * 3 + 1;
+    int v2 = seed * 4 + 4;
+    int v3 = seed * 5 + 9;
+    int v4 = seed * 6 + 16;
+    int v5 = seed * 7 + 25;
+    int v6 = seed * 8 + 36;
+    int v7 = seed * 9 + 49;
+    int v8 = seed * 10 + 64;
+    int v9 = seed * 11 + 81;
+    int v10 = seed * 12 + 100;
+    int v11 = seed * 13 + 121;
+    v0 = v0 + v1 * v5;
+    v1 = v1 + v2 * v6;
+    v2 = v2 + v3 * v7;
+    v3 = v3 + v4 * v8;
+    v4 = v4 + v5 * v9;
+    v5 = v5 + v6 * v10;
+    v6 = v6 + v7 * v11;
+    v7 = v7 + v8 * v0;
+    v8 = v8 + v9 * v1;
+    v9 = v9 + v10 * v2;
+    v10 = v10 + v11 * v3;
+    v11 = v11 + v0 * v4;
+    return (v0 * 1 + v1 * 2 + v2 * 3 + v3 * 4 + v4 * 5 + v5 * 6 + v6 * 7 + v7 * 8 + v8 * 9 + v9 * 10 + v10 * 11 + v11 * 12) % 251;
+}
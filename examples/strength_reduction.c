@@ -0,0 +1,8 @@
+// exit code: 66
+// Multiply by 3 (lea), divide by 8 and remainder by 16 (shifts), and divide by 100 (magic number)
+int main(void) {
+    int a = 37;
+    int b = a * 3;
+    int c = (b / 8) + (b % 16) + ((a < b) <= 1) + (a % 100);
+    return c;
+}
@@ -1,104 +1,142 @@
 #include "asm_ir.h"
 #include <memory>
+#include <unordered_map>
 
-// -------- AsmIR Node Constructors --------
-AsmIRRet::AsmIRRet() {
-    type = AsmIRNodeType::RETURN;
+// -------- AsmIR Operands --------
+AsmIROperand asmImm(int64_t value) {
+    AsmIROperand operand;
+    operand.type = AsmIRNodeType::IMMEDIATE;
+    operand.value = value;
+    return operand;
 }
 
-AsmIRMov::AsmIRMov(std::unique_ptr<AsmIRNode> s, std::unique_ptr<AsmIRNode> d) {
-    type = AsmIRNodeType::MOV;
-    src = std::move(s);
-    dst = std::move(d);
+AsmIROperand asmReg(AsmIRRegister reg) {
+    AsmIROperand operand;
+    operand.type = AsmIRNodeType::REGISTER;
+    operand.reg = reg;
+    return operand;
 }
 
-AsmIRUnary::AsmIRUnary(std::unique_ptr<AsmIRNode> unary_operator, std::unique_ptr<AsmIRNode> operand) 
-    : unary_operator(std::move(unary_operator)), operand(std::move(operand)) {
-    type = AsmIRNodeType::UNARY;
+AsmIROperand asmStack(int offset) {
+    AsmIROperand operand;
+    operand.type = AsmIRNodeType::STACK;
+    operand.value = offset;
+    return operand;
 }
 
-AsmIRBinary::AsmIRBinary(std::unique_ptr<AsmIRNode> binary_operator, std::unique_ptr<AsmIRNode> operand1, std::unique_ptr<AsmIRNode> operand2)
-    : binary_operator(std::move(binary_operator)), operand1(std::move(operand1)), operand2(std::move(operand2)) {
-    type = AsmIRNodeType::BINARY;
+static std::vector<std::string> pseudoNames;
+static std::unordered_map<std::string, int64_t> pseudoIds;
+
+AsmIROperand asmPseudo(const std::string& name) {
+    auto it = pseudoIds.find(name);
+    if (it == pseudoIds.end()) {
+        it = pseudoIds.emplace(name, static_cast<int64_t>(pseudoNames.size())).first;
+        pseudoNames.push_back(name);
+    }
+    AsmIROperand operand;
+    operand.type = AsmIRNodeType::PSEUDO;
+    operand.value = it->second;
+    return operand;
 }
 
-AsmIRCmp::AsmIRCmp(std::unique_ptr<AsmIRNode> operand1, std::unique_ptr<AsmIRNode> operand2)
-    : operand1(std::move(operand1)), operand2(std::move(operand2)) {
-    type = AsmIRNodeType::CMP;
+const std::string& asmPseudoName(int64_t id) {
+    return pseudoNames[static_cast<size_t>(id)];
 }
 
-AsmIRIdiv::AsmIRIdiv(std::unique_ptr<AsmIRNode> operand)
-    : operand(std::move(operand)) {
-    type = AsmIRNodeType::IDIV;
+AsmIRCondCode asmNegateCondition(AsmIRCondCode cond_code) {
+    switch (cond_code) {
+        case AsmIRCondCode::E: return AsmIRCondCode::NE;
+        case AsmIRCondCode::NE: return AsmIRCondCode::E;
+        case AsmIRCondCode::L: return AsmIRCondCode::GE;
+        case AsmIRCondCode::GE: return AsmIRCondCode::L;
+        case AsmIRCondCode::G: return AsmIRCondCode::LE;
+        case AsmIRCondCode::LE: return AsmIRCondCode::G;
+    }
+    return cond_code;
 }
 
-AsmIRCdq::AsmIRCdq() {
-    type = AsmIRNodeType::CDQ;
+// -------- AsmIR Node Constructors --------
+AsmIRRet::AsmIRRet() {
+    type = AsmIRNodeType::RETURN;
 }
 
-AsmIRJmp::AsmIRJmp(std::string identifier)
-    : identifier(std::move(identifier)) {
-    type = AsmIRNodeType::JMP;
+AsmIRMov::AsmIRMov(AsmIROperand s, AsmIROperand d)
+    : src(s), dst(d) {
+    type = AsmIRNodeType::MOV;
 }
 
-AsmIRJmpCC::AsmIRJmpCC(std::string cond_code, std::string identifier)
-    : cond_code(std::move(cond_code)), identifier(std::move(identifier)) {
-    type = AsmIRNodeType::JMP_CC;
+AsmIRUnary::AsmIRUnary(AsmIRNodeType unary_operator, AsmIROperand operand)
+    : unary_operator(unary_operator), operand(operand) {
+    type = AsmIRNodeType::UNARY;
 }
 
-AsmIRSetCC::AsmIRSetCC(std::string cond_code, std::unique_ptr<AsmIRNode> operand)
-    : cond_code(std::move(cond_code)), operand(std::move(operand)) {
-    type = AsmIRNodeType::SET_CC;
+AsmIRBinary::AsmIRBinary(AsmIRNodeType binary_operator, AsmIROperand operand1, AsmIROperand operand2)
+    : binary_operator(binary_operator), operand1(operand1), operand2(operand2) {
+    type = AsmIRNodeType::BINARY;
 }
 
-AsmIRLabel::AsmIRLabel(std::string identifier) 
-    : identifier(std::move(identifier)) {
-    type = AsmIRNodeType::LABEL;
+AsmIRCmp::AsmIRCmp(AsmIROperand operand1, AsmIROperand operand2)
+    : operand1(operand1), operand2(operand2) {
+    type = AsmIRNodeType::CMP;
 }
 
-AsmIRAllocateStack::AsmIRAllocateStack(int stack_size) 
-    : stack_size(stack_size) {
-    type = AsmIRNodeType::ALLOCATE_STACK;
+AsmIRTest::AsmIRTest(AsmIROperand operand1, AsmIROperand operand2)
+    : operand1(operand1), operand2(operand2) {
+    type = AsmIRNodeType::TEST;
 }
 
-AsmIRNeg::AsmIRNeg() {
-    type = AsmIRNodeType::NEG;
+AsmIRMovZeroExtend::AsmIRMovZeroExtend(AsmIROperand src, AsmIROperand dst)
+    : src(src), dst(dst) {
+    type = AsmIRNodeType::MOVZX;
 }
 
-AsmIRNot::AsmIRNot() {
-    type = AsmIRNodeType::NOT;
+AsmIRImulWide::AsmIRImulWide(AsmIROperand operand)
+    : operand(operand) {
+    type = AsmIRNodeType::IMUL_WIDE;
 }
 
-AsmIRAdd::AsmIRAdd() {
-    type = AsmIRNodeType::ADD;
+AsmIRLea::AsmIRLea(AsmIROperand base, AsmIROperand index, int scale, int displacement, AsmIROperand dst)
+    : base(base), index(index), scale(scale), displacement(displacement), dst(dst) {
+    type = AsmIRNodeType::LEA;
 }
 
-AsmIRSubtract::AsmIRSubtract() {
-    type = AsmIRNodeType::SUBTRACT;
+AsmIRIdiv::AsmIRIdiv(AsmIROperand operand)
+    : operand(operand) {
+    type = AsmIRNodeType::IDIV;
 }
 
-AsmIRMultiply::AsmIRMultiply() {
-    type = AsmIRNodeType::MULTIPLY;
+AsmIRCdq::AsmIRCdq() {
+    type = AsmIRNodeType::CDQ;
 }
 
-AsmIRImm::AsmIRImm(std::string v) {
-    type = AsmIRNodeType::IMMEDIATE;
-    value = std::move(v);
+AsmIRCountEdge::AsmIRCountEdge(int counter)
+    : counter(counter) {
+    type = AsmIRNodeType::COUNT_EDGE;
 }
 
-AsmIRReg::AsmIRReg(std::string v) {
-    type = AsmIRNodeType::REGISTER;
-    value = std::move(v);
+AsmIRJmp::AsmIRJmp(std::string identifier)
+    : identifier(std::move(identifier)) {
+    type = AsmIRNodeType::JMP;
+}
+
+AsmIRJmpCC::AsmIRJmpCC(AsmIRCondCode cond_code, std::string identifier)
+    : cond_code(cond_code), identifier(std::move(identifier)) {
+    type = AsmIRNodeType::JMP_CC;
+}
+
+AsmIRSetCC::AsmIRSetCC(AsmIRCondCode cond_code, AsmIROperand operand)
+    : cond_code(cond_code), operand(operand) {
+    type = AsmIRNodeType::SET_CC;
 }
 
-AsmIRPseudo::AsmIRPseudo(std::string identifier)
-    : identifier(identifier) {
-    type = AsmIRNodeType::PSEUDO;
+AsmIRLabel::AsmIRLabel(std::string identifier)
+    : identifier(std::move(identifier)) {
+    type = AsmIRNodeType::LABEL;
 }
 
-AsmIRStack::AsmIRStack(int stack_size)
+AsmIRAllocateStack::AsmIRAllocateStack(int stack_size)
     : stack_size(stack_size) {
-    type = AsmIRNodeType::STACK;
+    type = AsmIRNodeType::ALLOCATE_STACK;
 }
 
 AsmIRInstructions::AsmIRInstructions() {}
@@ -1,11 +1,12 @@
 #ifndef ASM_IR_H
 #define ASM_IR_H
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <memory>
 
-enum class AsmIRNodeType { PROGRAM, FUNCTION, MOV, IMMEDIATE, RETURN, REGISTER, INSTRUCTIONS, ALLOCATE_STACK, NEG, NOT, PSEUDO, STACK, UNARY, BINARY, CMP, IDIV, CDQ, JMP, JMP_CC, SET_CC, LABEL, ADD, SUBTRACT, MULTIPLY };
+enum class AsmIRNodeType { PROGRAM, FUNCTION, MOV, IMMEDIATE, RETURN, REGISTER, INSTRUCTIONS, ALLOCATE_STACK, NEG, NOT, PSEUDO, STACK, UNARY, BINARY, CMP, IDIV, CDQ, JMP, JMP_CC, SET_CC, LABEL, ADD, SUBTRACT, MULTIPLY, SAR, AND, XOR, TEST, MOVZX, SHL, SHR, IMUL_WIDE, LEA, OR, COUNT_EDGE, NONE };
 
 class AsmIRNode {
 public:
@@ -13,118 +14,155 @@ public:
     virtual ~AsmIRNode() = default;
 };
 
+// --- Operands ---
+// Hard registers, in the order the emitter's name table lists them
+enum class AsmIRRegister : uint8_t { AX, CX, DX, SI, DI, R8, R9, R10, R11, COUNT };
+enum class AsmIRCondCode : uint8_t { E, NE, L, LE, G, GE };
+
+// An instruction operand, held inline. type is IMMEDIATE, REGISTER, STACK or PSEUDO, or
+// NONE for a Lea base or index that isn't there. value is the immediate, the stack offset
+// or the pseudo's ID; reg is only meaningful for registers.
+struct AsmIROperand {
+    AsmIRNodeType type = AsmIRNodeType::NONE;
+    AsmIRRegister reg = AsmIRRegister::AX;
+    int64_t value = 0;
+
+    explicit operator bool() const { return type != AsmIRNodeType::NONE; }
+    bool operator==(const AsmIROperand& other) const {
+        return type == other.type && (type == AsmIRNodeType::REGISTER ? reg == other.reg : value == other.value);
+    }
+    bool operator!=(const AsmIROperand& other) const { return !(*this == other); }
+};
+
+AsmIROperand asmImm(int64_t value);
+AsmIROperand asmReg(AsmIRRegister reg);
+AsmIROperand asmStack(int offset);
+// Pseudos are interned, so every mention of a TACKY name gets the same ID
+AsmIROperand asmPseudo(const std::string& name);
+const std::string& asmPseudoName(int64_t id);
+// The condition that holds exactly when cond_code doesn't
+AsmIRCondCode asmNegateCondition(AsmIRCondCode cond_code);
+
+// --- Instructions ---
 class AsmIRRet : public AsmIRNode {
 public:
     AsmIRRet();
 };
 
-class AsmIRImm : public AsmIRNode {
-public:
-    std::string value;
-    AsmIRImm(std::string v);
-};
-
 class AsmIRMov : public AsmIRNode {
 public:
-    std::unique_ptr<AsmIRNode> src;
-    std::unique_ptr<AsmIRNode> dst;
-    AsmIRMov(std::unique_ptr<AsmIRNode> s, std::unique_ptr<AsmIRNode> d);
+    AsmIROperand src;
+    AsmIROperand dst;
+    AsmIRMov(AsmIROperand s, AsmIROperand d);
 };
 
+// unary_operator is NEG or NOT
 class AsmIRUnary : public AsmIRNode {
 public:
-    std::unique_ptr<AsmIRNode> unary_operator;
-    std::unique_ptr<AsmIRNode> operand;
-    AsmIRUnary(std::unique_ptr<AsmIRNode> unary_operator, std::unique_ptr<AsmIRNode> operand);
+    AsmIRNodeType unary_operator;
+    AsmIROperand operand;
+    AsmIRUnary(AsmIRNodeType unary_operator, AsmIROperand operand);
 };
 
+// binary_operator is ADD, SUBTRACT, MULTIPLY, AND, OR, XOR or one of the shifts. Shift
+// counts are always immediates.
 class AsmIRBinary : public AsmIRNode {
 public:
-    std::unique_ptr<AsmIRNode> binary_operator;
-    std::unique_ptr<AsmIRNode> operand1;
-    std::unique_ptr<AsmIRNode> operand2;
-    AsmIRBinary(std::unique_ptr<AsmIRNode> binary_operator, std::unique_ptr<AsmIRNode> operand1, std::unique_ptr<AsmIRNode> operand2);
+    AsmIRNodeType binary_operator;
+    AsmIROperand operand1;
+    AsmIROperand operand2;
+    AsmIRBinary(AsmIRNodeType binary_operator, AsmIROperand operand1, AsmIROperand operand2);
 };
 
 class AsmIRCmp : public AsmIRNode {
 public:
-    std::unique_ptr<AsmIRNode> operand1;
-    std::unique_ptr<AsmIRNode> operand2;
-    AsmIRCmp(std::unique_ptr<AsmIRNode> operand1, std::unique_ptr<AsmIRNode> operand2);
+    AsmIROperand operand1;
+    AsmIROperand operand2;
+    AsmIRCmp(AsmIROperand operand1, AsmIROperand operand2);
 };
 
-class AsmIRIdiv : public AsmIRNode {
+class AsmIRTest : public AsmIRNode {
 public:
-    std::unique_ptr<AsmIRNode> operand;
-    AsmIRIdiv(std::unique_ptr<AsmIRNode> operand);
+    AsmIROperand operand1;
+    AsmIROperand operand2;
+    AsmIRTest(AsmIROperand operand1, AsmIROperand operand2);
 };
 
-class AsmIRCdq : public AsmIRNode {
+// Zero-extends the low byte of src into dst (movzbl)
+class AsmIRMovZeroExtend : public AsmIRNode {
 public:
-    AsmIRCdq();
-};
-
-class AsmIRJmp : public AsmIRNode {
-public:
-    std::string identifier;
-    AsmIRJmp(std::string identifier);
+    AsmIROperand src;
+    AsmIROperand dst;
+    AsmIRMovZeroExtend(AsmIROperand src, AsmIROperand dst);
 };
 
-class AsmIRJmpCC : public AsmIRNode {
+// One-operand imull: EDX:EAX = EAX * operand, signed
+class AsmIRImulWide : public AsmIRNode {
 public:
-    std::string cond_code;
-    std::string identifier;
-    AsmIRJmpCC(std::string cond_code, std::string identifier);
+    AsmIROperand operand;
+    AsmIRImulWide(AsmIROperand operand);
 };
 
-class AsmIRSetCC : public AsmIRNode {
+// dst = base + index * scale + displacement, computed by leal without touching the flags.
+// Either base or index may be absent; whichever is present must end up in a register.
+class AsmIRLea : public AsmIRNode {
 public:
-    std::string cond_code;
-    std::unique_ptr<AsmIRNode> operand;
-    AsmIRSetCC(std::string cond_code, std::unique_ptr<AsmIRNode> operand);
+    AsmIROperand base;
+    AsmIROperand index;
+    int scale;
+    int displacement;
+    AsmIROperand dst;
+    AsmIRLea(AsmIROperand base, AsmIROperand index, int scale, int displacement, AsmIROperand dst);
 };
 
-class AsmIRLabel : public AsmIRNode {
+class AsmIRIdiv : public AsmIRNode {
 public:
-    std::string identifier;
-    AsmIRLabel(std::string identifier);
+    AsmIROperand operand;
+    AsmIRIdiv(AsmIROperand operand);
 };
 
-class AsmIRAllocateStack : public AsmIRNode {
+class AsmIRCdq : public AsmIRNode {
 public:
-    int stack_size;
-    AsmIRAllocateStack(int stack_size);
+    AsmIRCdq();
 };
 
-class AsmIRNeg : public AsmIRNode {
+// Bumps one 64-bit edge counter of an instrumented build through R11, leaving the flags alone
+class AsmIRCountEdge : public AsmIRNode {
 public:
-    AsmIRNeg();
+    int counter;
+    AsmIRCountEdge(int counter);
 };
 
-class AsmIRNot : public AsmIRNode {
+class AsmIRJmp : public AsmIRNode {
 public:
-    AsmIRNot();
+    std::string identifier;
+    AsmIRJmp(std::string identifier);
 };
 
-class AsmIRAdd : public AsmIRNode {
+class AsmIRJmpCC : public AsmIRNode {
 public:
-    AsmIRAdd();
+    AsmIRCondCode cond_code;
+    std::string identifier;
+    AsmIRJmpCC(AsmIRCondCode cond_code, std::string identifier);
 };
 
-class AsmIRSubtract : public AsmIRNode {
+class AsmIRSetCC : public AsmIRNode {
 public:
-    AsmIRSubtract();
+    AsmIRCondCode cond_code;
+    AsmIROperand operand;
+    AsmIRSetCC(AsmIRCondCode cond_code, AsmIROperand operand);
 };
 
-class AsmIRMultiply : public AsmIRNode {
+class AsmIRLabel : public AsmIRNode {
 public:
-    AsmIRMultiply();
+    std::string identifier;
+    AsmIRLabel(std::string identifier);
 };
 
-class AsmIRReg : public AsmIRNode {
+class AsmIRAllocateStack : public AsmIRNode {
 public:
-    std::string value;
-    AsmIRReg(std::string v);
+    int stack_size;
+    AsmIRAllocateStack(int stack_size);
 };
 
 class AsmIRInstructions : public AsmIRNode {
@@ -134,18 +172,6 @@ public:
     AsmIRInstructions();
 };
 
-class AsmIRPseudo : public AsmIRNode {
-public:
-    std::string identifier;
-    AsmIRPseudo(std::string identifier);
-};
-
-class AsmIRStack : public AsmIRNode {
-public:
-    int stack_size;
-    AsmIRStack(int stack_size);
-};
-
 class AsmIRFunction : public AsmIRNode {
 public:
     std::string name;
@@ -0,0 +1,249 @@
+#include "asm_liveness.h"
+#include <iostream>
+
+int asmLocation(const AsmIROperand& operand) {
+    if (operand.type == AsmIRNodeType::PSEUDO) return asmRegisterLocations + static_cast<int>(operand.value);
+    if (operand.type == AsmIRNodeType::REGISTER) return asmLocation(operand.reg);
+    return -1;
+}
+
+std::vector<AsmIROperand*> asmUses(AsmIRNode* instr) {
+    std::vector<AsmIROperand*> uses;
+    switch (instr->type) {
+        case AsmIRNodeType::MOV:
+            uses.push_back(&static_cast<AsmIRMov*>(instr)->src);
+            break;
+        case AsmIRNodeType::UNARY:
+            uses.push_back(&static_cast<AsmIRUnary*>(instr)->operand);
+            break;
+        case AsmIRNodeType::BINARY: {
+            auto* binary = static_cast<AsmIRBinary*>(instr);
+            uses.push_back(&binary->operand1);
+            uses.push_back(&binary->operand2);
+            break;
+        }
+        case AsmIRNodeType::CMP: {
+            auto* cmp = static_cast<AsmIRCmp*>(instr);
+            uses.push_back(&cmp->operand1);
+            uses.push_back(&cmp->operand2);
+            break;
+        }
+        case AsmIRNodeType::TEST: {
+            auto* test = static_cast<AsmIRTest*>(instr);
+            uses.push_back(&test->operand1);
+            uses.push_back(&test->operand2);
+            break;
+        }
+        case AsmIRNodeType::MOVZX:
+            uses.push_back(&static_cast<AsmIRMovZeroExtend*>(instr)->src);
+            break;
+        case AsmIRNodeType::IDIV:
+            uses.push_back(&static_cast<AsmIRIdiv*>(instr)->operand);
+            break;
+        case AsmIRNodeType::IMUL_WIDE:
+            uses.push_back(&static_cast<AsmIRImulWide*>(instr)->operand);
+            break;
+        case AsmIRNodeType::LEA: {
+            auto* lea = static_cast<AsmIRLea*>(instr);
+            if (lea->base) uses.push_back(&lea->base);
+            if (lea->index) uses.push_back(&lea->index);
+            break;
+        }
+        default:
+            break;
+    }
+    return uses;
+}
+
+std::vector<AsmIROperand*> asmDefinitions(AsmIRNode* instr) {
+    std::vector<AsmIROperand*> defs;
+    switch (instr->type) {
+        case AsmIRNodeType::MOV:
+            defs.push_back(&static_cast<AsmIRMov*>(instr)->dst);
+            break;
+        case AsmIRNodeType::UNARY:
+            defs.push_back(&static_cast<AsmIRUnary*>(instr)->operand);
+            break;
+        case AsmIRNodeType::BINARY:
+            defs.push_back(&static_cast<AsmIRBinary*>(instr)->operand2);
+            break;
+        case AsmIRNodeType::SET_CC:
+            // only the low byte is written; instruction selection always zero-extends it afterwards
+            defs.push_back(&static_cast<AsmIRSetCC*>(instr)->operand);
+            break;
+        case AsmIRNodeType::MOVZX:
+            defs.push_back(&static_cast<AsmIRMovZeroExtend*>(instr)->dst);
+            break;
+        case AsmIRNodeType::LEA:
+            defs.push_back(&static_cast<AsmIRLea*>(instr)->dst);
+            break;
+        default:
+            break;
+    }
+    return defs;
+}
+
+std::vector<AsmIRRegister> asmImplicitUses(const AsmIRNode* instr) {
+    switch (instr->type) {
+        case AsmIRNodeType::IDIV: return {AsmIRRegister::AX, AsmIRRegister::DX};
+        case AsmIRNodeType::CDQ: return {AsmIRRegister::AX};
+        case AsmIRNodeType::IMUL_WIDE: return {AsmIRRegister::AX};
+        case AsmIRNodeType::RETURN: return {AsmIRRegister::AX};
+        default: return {};
+    }
+}
+
+std::vector<AsmIRRegister> asmImplicitDefinitions(const AsmIRNode* instr) {
+    switch (instr->type) {
+        case AsmIRNodeType::IDIV: return {AsmIRRegister::AX, AsmIRRegister::DX};
+        case AsmIRNodeType::CDQ: return {AsmIRRegister::DX};
+        case AsmIRNodeType::IMUL_WIDE: return {AsmIRRegister::AX, AsmIRRegister::DX};
+        case AsmIRNodeType::COUNT_EDGE: return {AsmIRRegister::R11};
+        default: return {};
+    }
+}
+
+bool asmReadsFlags(const AsmIRNode* instr) {
+    return instr->type == AsmIRNodeType::JMP_CC || instr->type == AsmIRNodeType::SET_CC;
+}
+
+bool asmWritesFlags(const AsmIRNode* instr) {
+    switch (instr->type) {
+        case AsmIRNodeType::CMP:
+        case AsmIRNodeType::TEST:
+        case AsmIRNodeType::BINARY:
+        case AsmIRNodeType::IDIV:
+        case AsmIRNodeType::IMUL_WIDE:
+            return true;
+        case AsmIRNodeType::UNARY:
+            // notl leaves the flags alone
+            return static_cast<const AsmIRUnary*>(instr)->unary_operator == AsmIRNodeType::NEG;
+        default:
+            return false;
+    }
+}
+
+// --- Basic Blocks ---
+std::vector<AsmBlock> buildAsmBlocks(const std::vector<std::unique_ptr<AsmIRNode>>& instrs) {
+    std::vector<AsmBlock> blocks;
+    std::unordered_map<std::string, int> labelToBlock;
+
+    size_t begin = 0;
+    for (size_t i = 0; i < instrs.size(); ++i) {
+        AsmIRNodeType type = instrs[i]->type;
+        if (type == AsmIRNodeType::LABEL && i > begin) {
+            blocks.push_back({begin, i, {}});
+            begin = i;
+        }
+        if (type == AsmIRNodeType::LABEL)
+            labelToBlock[static_cast<const AsmIRLabel*>(instrs[i].get())->identifier] = static_cast<int>(blocks.size());
+        if (type == AsmIRNodeType::JMP || type == AsmIRNodeType::JMP_CC || type == AsmIRNodeType::RETURN) {
+            blocks.push_back({begin, i + 1, {}});
+            begin = i + 1;
+        }
+    }
+    if (begin < instrs.size()) blocks.push_back({begin, instrs.size(), {}});
+
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        const AsmIRNode* last = instrs[blocks[b].end - 1].get();
+        int next = b + 1 < blocks.size() ? static_cast<int>(b + 1) : -1;
+        if (last->type == AsmIRNodeType::JMP || last->type == AsmIRNodeType::JMP_CC) {
+            const std::string& target = last->type == AsmIRNodeType::JMP
+                ? static_cast<const AsmIRJmp*>(last)->identifier
+                : static_cast<const AsmIRJmpCC*>(last)->identifier;
+            auto it = labelToBlock.find(target);
+            if (it == labelToBlock.end()) std::cout << "Error: jump to unknown label " << target << std::endl;
+            else blocks[b].successors.push_back(it->second);
+        }
+        if (last->type != AsmIRNodeType::JMP && last->type != AsmIRNodeType::RETURN && next != -1)
+            blocks[b].successors.push_back(next);
+    }
+    return blocks;
+}
+
+// --- Liveness ---
+void asmLiveTransfer(AsmIRNode* instr, std::vector<bool>& live, const AsmLiveness& liveness) {
+    auto bit = [&](int location) {
+        auto it = liveness.index.find(location);
+        return it == liveness.index.end() ? -1 : it->second;
+    };
+
+    for (auto* def : asmDefinitions(instr)) {
+        int b = bit(asmLocation(*def));
+        if (b != -1) live[b] = false;
+    }
+    for (AsmIRRegister reg : asmImplicitDefinitions(instr)) {
+        int b = bit(asmLocation(reg));
+        if (b != -1) live[b] = false;
+    }
+    for (auto* use : asmUses(instr)) {
+        int b = bit(asmLocation(*use));
+        if (b != -1) live[b] = true;
+    }
+    for (AsmIRRegister reg : asmImplicitUses(instr)) {
+        int b = bit(asmLocation(reg));
+        if (b != -1) live[b] = true;
+    }
+}
+
+AsmLiveness computeAsmLiveness(std::vector<std::unique_ptr<AsmIRNode>>& instrs) {
+    AsmLiveness liveness;
+    auto addLocation = [&](int location) {
+        if (location == -1 || liveness.index.count(location)) return;
+        liveness.index[location] = static_cast<int>(liveness.locations.size());
+        liveness.locations.push_back(location);
+    };
+    for (auto& instr : instrs) {
+        for (auto* use : asmUses(instr.get())) addLocation(asmLocation(*use));
+        for (auto* def : asmDefinitions(instr.get())) addLocation(asmLocation(*def));
+        for (AsmIRRegister reg : asmImplicitUses(instr.get())) addLocation(asmLocation(reg));
+        for (AsmIRRegister reg : asmImplicitDefinitions(instr.get())) addLocation(asmLocation(reg));
+    }
+
+    liveness.blocks = buildAsmBlocks(instrs);
+    size_t count = liveness.locations.size();
+    std::vector<std::vector<bool>> liveIn(liveness.blocks.size(), std::vector<bool>(count, false));
+    liveness.liveOut.assign(liveness.blocks.size(), std::vector<bool>(count, false));
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t b = liveness.blocks.size(); b-- > 0;) {
+            const AsmBlock& block = liveness.blocks[b];
+            std::vector<bool> live(count, false);
+            for (int succ : block.successors) {
+                for (size_t i = 0; i < count; ++i) {
+                    if (liveIn[succ][i]) live[i] = true;
+                }
+            }
+            liveness.liveOut[b] = live;
+            for (size_t i = block.end; i-- > block.begin;) asmLiveTransfer(instrs[i].get(), live, liveness);
+            if (live != liveIn[b]) {
+                liveIn[b] = std::move(live);
+                changed = true;
+            }
+        }
+    }
+    return liveness;
+}
+
+// --- Cached Analyses ---
+const std::vector<AsmBlock>& AsmAnalyses::blocks(const std::vector<std::unique_ptr<AsmIRNode>>& instrs) {
+    if (!haveBlocks) {
+        cached.blocks = buildAsmBlocks(instrs);
+        haveBlocks = true;
+    }
+    return cached.blocks;
+}
+
+const AsmLiveness& AsmAnalyses::liveness(std::vector<std::unique_ptr<AsmIRNode>>& instrs) {
+    if (!haveLiveness) {
+        cached = computeAsmLiveness(instrs);
+        haveBlocks = haveLiveness = true;
+    }
+    return cached;
+}
+
+void AsmAnalyses::invalidate() {
+    haveBlocks = haveLiveness = false;
+}
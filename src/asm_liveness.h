@@ -0,0 +1,66 @@
+#ifndef ASM_LIVENESS_H
+#define ASM_LIVENESS_H
+
+#include "asm_ir.h"
+#include <vector>
+#include <memory>
+#include <unordered_map>
+
+/*
+    Liveness over a flat AsmIR instruction list. Pseudos and hard registers
+    are both "locations", numbered densely so live sets are bit vectors.
+    Results are kept per basic block, and asmLiveTransfer steps a live set
+    backwards across a single instruction when finer detail is needed.
+*/
+struct AsmBlock {
+    size_t begin;
+    size_t end; // one past the last instruction
+    std::vector<int> successors;
+};
+
+struct AsmLiveness {
+    std::unordered_map<int, int> index; // location -> bit
+    std::vector<int> locations;
+    std::vector<AsmBlock> blocks;
+    std::vector<std::vector<bool>> liveOut;     // per block
+};
+
+// Registers are locations 0 .. asmRegisterLocations - 1 and pseudo n is asmRegisterLocations + n;
+// anything else is -1
+constexpr int asmRegisterLocations = static_cast<int>(AsmIRRegister::COUNT);
+int asmLocation(const AsmIROperand& operand);
+inline int asmLocation(AsmIRRegister reg) { return static_cast<int>(reg); }
+inline bool isAsmRegisterLocation(int location) { return location >= 0 && location < asmRegisterLocations; }
+
+// Operand slots an instruction reads or writes, so passes can rewrite them in place
+std::vector<AsmIROperand*> asmUses(AsmIRNode* instr);
+std::vector<AsmIROperand*> asmDefinitions(AsmIRNode* instr);
+// Registers read or written without appearing as operands (idivl, cdq, ret)
+std::vector<AsmIRRegister> asmImplicitUses(const AsmIRNode* instr);
+std::vector<AsmIRRegister> asmImplicitDefinitions(const AsmIRNode* instr);
+// The condition flags aren't a location; these say which instructions touch them
+bool asmReadsFlags(const AsmIRNode* instr);
+bool asmWritesFlags(const AsmIRNode* instr);
+
+std::vector<AsmBlock> buildAsmBlocks(const std::vector<std::unique_ptr<AsmIRNode>>& instrs);
+AsmLiveness computeAsmLiveness(std::vector<std::unique_ptr<AsmIRNode>>& instrs);
+void asmLiveTransfer(AsmIRNode* instr, std::vector<bool>& live, const AsmLiveness& liveness);
+
+/*
+    Blocks and liveness of one instruction list, computed on first request and kept
+    until invalidate(). A pass that edits the list calls invalidate() before asking
+    again; the pass manager calls it after every AsmIR pass not registered as leaving
+    the instructions alone.
+*/
+struct AsmAnalyses {
+    const std::vector<AsmBlock>& blocks(const std::vector<std::unique_ptr<AsmIRNode>>& instrs);
+    const AsmLiveness& liveness(std::vector<std::unique_ptr<AsmIRNode>>& instrs);
+    void invalidate();
+
+private:
+    bool haveBlocks = false;
+    bool haveLiveness = false;
+    AsmLiveness cached; // cached.blocks is filled whenever haveBlocks is
+};
+
+#endif
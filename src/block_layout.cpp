@@ -0,0 +1,209 @@
+#include "block_layout.h"
+#include "asm_liveness.h"
+#include "profile.h"
+#include "tacky_cfg.h"
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+using AsmInstructions = std::vector<std::unique_ptr<AsmIRNode>>;
+
+struct LayoutBlock {
+    size_t begin;
+    size_t end;
+    std::string label;
+    int taken = -1;       // block a trailing jump goes to
+    int fallthrough = -1; // block reached when the last instruction doesn't jump
+    bool reachable = false;
+    double frequency = 0;
+    std::string site; // profile site of a trailing conditional jump
+};
+
+static const std::string* jumpTarget(const AsmIRNode* instr) {
+    if (instr->type == AsmIRNodeType::JMP) return &static_cast<const AsmIRJmp*>(instr)->identifier;
+    if (instr->type == AsmIRNodeType::JMP_CC) return &static_cast<const AsmIRJmpCC*>(instr)->identifier;
+    return nullptr;
+}
+
+static std::vector<LayoutBlock> buildLayoutBlocks(const AsmInstructions& instrs) {
+    std::vector<LayoutBlock> blocks;
+    std::unordered_map<std::string, int> labelToBlock;
+    std::vector<std::string> sites = branchSiteKeys(instrs);
+    for (const AsmBlock& block : buildAsmBlocks(instrs)) {
+        LayoutBlock layoutBlock{block.begin, block.end, "", -1, -1, false, 0, sites[block.end - 1]};
+        if (instrs[block.begin]->type == AsmIRNodeType::LABEL) {
+            layoutBlock.label = static_cast<const AsmIRLabel*>(instrs[block.begin].get())->identifier;
+            labelToBlock[layoutBlock.label] = static_cast<int>(blocks.size());
+        }
+        blocks.push_back(layoutBlock);
+    }
+
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        const AsmIRNode* last = instrs[blocks[b].end - 1].get();
+        if (const std::string* target = jumpTarget(last)) {
+            auto it = labelToBlock.find(*target);
+            if (it != labelToBlock.end()) blocks[b].taken = it->second;
+        }
+        if (last->type != AsmIRNodeType::JMP && last->type != AsmIRNodeType::RETURN && b + 1 < blocks.size())
+            blocks[b].fallthrough = static_cast<int>(b + 1);
+    }
+    return blocks;
+}
+
+// --- Branch Prediction ---
+// With -fprofile-use the measured ratio decides. Otherwise a backward conditional jump closes
+// a loop and is usually taken, and anything else is a coin flip that the edge sort below
+// breaks in favour of the original fallthrough.
+static double takenProbability(const std::vector<LayoutBlock>& blocks, int block) {
+    const LayoutBlock& from = blocks[static_cast<size_t>(block)];
+    if (profileMode == ProfileMode::USE) {
+        const BranchCounts* counts = profileCounts(from.site);
+        if (counts && counts->taken + counts->notTaken > 0)
+            return static_cast<double>(counts->taken) / static_cast<double>(counts->taken + counts->notTaken);
+    }
+    return from.taken <= block ? 0.9 : 0.5;
+}
+
+// (successor, probability) pairs for the ways out of a block
+static std::vector<std::pair<int, double>> outEdges(const std::vector<LayoutBlock>& blocks, int b) {
+    const LayoutBlock& block = blocks[static_cast<size_t>(b)];
+    if (block.taken != -1 && block.fallthrough != -1 && block.taken != block.fallthrough) {
+        double p = takenProbability(blocks, b);
+        return {{block.taken, p}, {block.fallthrough, 1 - p}};
+    }
+    if (block.taken != -1) return {{block.taken, 1}};
+    if (block.fallthrough != -1) return {{block.fallthrough, 1}};
+    return {};
+}
+
+static void markReachable(std::vector<LayoutBlock>& blocks) {
+    std::vector<int> stack = {0};
+    blocks[0].reachable = true;
+    while (!stack.empty()) {
+        int b = stack.back();
+        stack.pop_back();
+        for (auto [succ, p] : outEdges(blocks, b)) {
+            if (blocks[succ].reachable) continue;
+            blocks[succ].reachable = true;
+            stack.push_back(succ);
+        }
+    }
+}
+
+// Frequencies flow forward in block order; back edges only add weight inside a loop,
+// which the taken probability already accounts for
+static void estimateFrequencies(std::vector<LayoutBlock>& blocks) {
+    blocks[0].frequency = 1;
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        if (!blocks[b].reachable) continue;
+        for (auto [succ, p] : outEdges(blocks, static_cast<int>(b))) {
+            if (succ > static_cast<int>(b)) blocks[succ].frequency += blocks[b].frequency * p;
+        }
+    }
+}
+
+// --- Chaining ---
+struct LayoutEdge {
+    double weight;
+    int from;
+    int to;
+    bool fallthrough;
+};
+
+// Heaviest edges first: each one joins the chain ending at its source to the chain
+// starting at its target. The entry chain goes first, the rest in original order.
+static std::vector<int> chainBlocks(const std::vector<LayoutBlock>& blocks) {
+    std::vector<LayoutEdge> edges;
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        if (!blocks[b].reachable) continue;
+        for (auto [succ, p] : outEdges(blocks, static_cast<int>(b)))
+            edges.push_back({blocks[b].frequency * p, static_cast<int>(b), succ, succ == blocks[b].fallthrough});
+    }
+    std::stable_sort(edges.begin(), edges.end(), [](const LayoutEdge& a, const LayoutEdge& b) {
+        if (a.weight != b.weight) return a.weight > b.weight;
+        return a.fallthrough && !b.fallthrough;
+    });
+
+    std::vector<int> chainOf(blocks.size());
+    std::vector<std::vector<int>> chains(blocks.size());
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        chainOf[b] = static_cast<int>(b);
+        chains[b] = {static_cast<int>(b)};
+    }
+    for (const LayoutEdge& edge : edges) {
+        if (edge.to == 0) continue;
+        int from = chainOf[edge.from], to = chainOf[edge.to];
+        if (from == to || chains[from].back() != edge.from || chains[to].front() != edge.to) continue;
+        for (int b : chains[to]) {
+            chains[from].push_back(b);
+            chainOf[b] = from;
+        }
+        chains[to].clear();
+    }
+
+    std::vector<int> order = chains[chainOf[0]];
+    for (size_t c = 0; c < chains.size(); ++c) {
+        if (static_cast<int>(c) == chainOf[0] || chains[c].empty() || !blocks[chains[c].front()].reachable) continue;
+        order.insert(order.end(), chains[c].begin(), chains[c].end());
+    }
+    return order;
+}
+
+// --- Placement ---
+void passLayoutBlocks(AsmIRNode* node) {
+    if (!node || node->type != AsmIRNodeType::PROGRAM) return;
+    auto* fn = static_cast<AsmIRProgram*>(node)->function.get();
+    if (!fn || !fn->instructions || fn->instructions->instructions.empty()) return;
+    auto& instrs = fn->instructions->instructions;
+
+    std::vector<LayoutBlock> blocks = buildLayoutBlocks(instrs);
+    markReachable(blocks);
+    estimateFrequencies(blocks);
+    std::vector<int> order = chainBlocks(blocks);
+
+    // any block may turn into a jump target once its predecessor moves away
+    for (LayoutBlock& block : blocks) {
+        if (block.reachable && block.label.empty()) block.label = makeBlockLabel();
+    }
+
+    AsmInstructions placed;
+    placed.reserve(instrs.size() + order.size());
+    for (size_t k = 0; k < order.size(); ++k) {
+        const LayoutBlock& block = blocks[static_cast<size_t>(order[k])];
+        int next = k + 1 < order.size() ? order[k + 1] : -1;
+
+        size_t first = block.begin;
+        if (instrs[first]->type == AsmIRNodeType::LABEL) placed.push_back(std::move(instrs[first++]));
+        else placed.push_back(std::make_unique<AsmIRLabel>(block.label));
+
+        AsmIRNode* last = instrs[block.end - 1].get();
+        bool endsInJump = first < block.end && jumpTarget(last);
+        for (size_t i = first; i < block.end - (endsInJump ? 1 : 0); ++i) placed.push_back(std::move(instrs[i]));
+
+        int fallthrough = block.fallthrough;
+        if (endsInJump && last->type == AsmIRNodeType::JMP) {
+            if (block.taken == -1 || block.taken != next) placed.push_back(std::move(instrs[block.end - 1]));
+        } else if (endsInJump && block.taken != block.fallthrough) {
+            auto* jumpNode = static_cast<AsmIRJmpCC*>(last);
+            if (fallthrough != next && block.taken == next && block.taken != -1) {
+                jumpNode->cond_code = asmNegateCondition(jumpNode->cond_code);
+                jumpNode->identifier = blocks[static_cast<size_t>(fallthrough)].label;
+                fallthrough = block.taken;
+            }
+            placed.push_back(std::move(instrs[block.end - 1]));
+        }
+        // a conditional jump whose sides agree only reads the flags, so it just falls through
+        if (fallthrough != -1 && fallthrough != next)
+            placed.push_back(std::make_unique<AsmIRJmp>(blocks[static_cast<size_t>(fallthrough)].label));
+    }
+
+    std::unordered_set<std::string> referenced;
+    for (const auto& instr : placed) {
+        if (const std::string* target = jumpTarget(instr.get())) referenced.insert(*target);
+    }
+    instrs.clear();
+    for (auto& instr : placed) {
+        if (instr->type == AsmIRNodeType::LABEL && !referenced.count(static_cast<const AsmIRLabel*>(instr.get())->identifier)) continue;
+        instrs.push_back(std::move(instr));
+    }
+}
@@ -0,0 +1,13 @@
+#ifndef BLOCK_LAYOUT_H
+#define BLOCK_LAYOUT_H
+
+#include "asm_ir.h"
+
+// Reorders basic blocks so the likely successor of each block follows it (Pettis-Hansen
+// chaining over edge frequencies, estimated statically or read from -fprofile-use).
+// Conditional jumps are inverted where that lets the taken side fall through, jumps to
+// the next block are deleted, and blocks unreachable from the entry are dropped along
+// with labels nothing jumps to.
+void passLayoutBlocks(AsmIRNode* node);
+
+#endif
@@ -1,32 +1,128 @@
 #include "codegen.h"
 #include "asm_ir.h"
 #include "tacky_ir.h"
+#include "asm_liveness.h"
+#include "pass_manager.h"
+#include "strength_reduction.h"
+#include "isel.h"
+#include "tacky_eval.h"
 #include <iostream>
 #include <memory>
 #include <unordered_map>
 
-// --- Flatten nested AsmIRInstructions ---
-std::unique_ptr<AsmIRInstructions> passUnnest(std::unique_ptr<AsmIRInstructions> node) {
-    auto flat = std::make_unique<AsmIRInstructions>();
-    if (!node) return flat;
+// --- Instruction Selection Helpers ---
+static bool isTackyVar(const TackyIRNode* operand, const std::string* name = nullptr) {
+    if (!operand || operand->type != TackyIRNodeType::VAR) return false;
+    return !name || static_cast<const TackyIRVar*>(operand)->value == *name;
+}
 
-    for (auto& instr : node->instructions) {
-        if (!instr) continue;
+static bool isTackyZero(const TackyIRNode* operand) {
+    int32_t value;
+    return parseTackyConstant(operand, value) && value == 0;
+}
 
-        if (instr->type == AsmIRNodeType::INSTRUCTIONS) {
-            auto nested = static_cast<AsmIRInstructions*>(instr.release());
-            auto nestedFlat = passUnnest(std::unique_ptr<AsmIRInstructions>(nested));
-            for (auto& nestedInstr : nestedFlat->instructions)
-                flat->instructions.push_back(std::move(nestedInstr));
-        } else {
-            flat->instructions.push_back(std::move(instr));
-        }
+// The condition that holds with the operands of the comparison swapped
+static AsmIRCondCode swapCondition(AsmIRCondCode cond_code) {
+    switch (cond_code) {
+        case AsmIRCondCode::L: return AsmIRCondCode::G;
+        case AsmIRCondCode::G: return AsmIRCondCode::L;
+        case AsmIRCondCode::LE: return AsmIRCondCode::GE;
+        case AsmIRCondCode::GE: return AsmIRCondCode::LE;
+        default: return cond_code;
+    }
+}
+
+// Sets the flags for `value == 0`: test for a variable, cmp for a constant
+static void selectZeroCheck(const TackyIRNode* value, AsmIRInstructions* instructions) {
+    AsmIROperand operand = buildAsmIROperand(value);
+    if (isTackyVar(value)) {
+        instructions->instructions.push_back(std::make_unique<AsmIRTest>(operand, operand));
+    } else {
+        instructions->instructions.push_back(std::make_unique<AsmIRCmp>(asmImm(0), operand));
+    }
+}
+
+/*
+    SetCC(cond_code, dst)
+    MovZeroExtend(dst, dst)
+*/
+static void selectSetCC(AsmIRCondCode cond_code, const TackyIRNode* dst, AsmIRInstructions* instructions) {
+    AsmIROperand operand = buildAsmIROperand(dst);
+    instructions->instructions.push_back(std::make_unique<AsmIRSetCC>(cond_code, operand));
+    instructions->instructions.push_back(std::make_unique<AsmIRMovZeroExtend>(operand, operand));
+}
+
+// Emits the cmp or test for a relational Binary and returns the condition code under
+// which it holds
+static AsmIRCondCode selectComparison(const TackyIRBinary* binaryNode, AsmIRInstructions* instructions) {
+    AsmIRCondCode cond_code = AsmIRCondCode::E;
+
+    if (binaryNode->op->type == TackyIRNodeType::EQUAL) {
+        cond_code = AsmIRCondCode::E;
+    } else if (binaryNode->op->type == TackyIRNodeType::NOT_EQUAL) {
+        cond_code = AsmIRCondCode::NE;
+    } else if (binaryNode->op->type == TackyIRNodeType::LESS_THAN) {
+        cond_code = AsmIRCondCode::L;
+    } else if (binaryNode->op->type == TackyIRNodeType::GREATER_THAN) {
+        cond_code = AsmIRCondCode::G;
+    } else if (binaryNode->op->type == TackyIRNodeType::LESS_OR_EQUAL) {
+        cond_code = AsmIRCondCode::LE;
+    } else if (binaryNode->op->type == TackyIRNodeType::GREATER_OR_EQUAL) {
+        cond_code = AsmIRCondCode::GE;
+    }
+
+    const TackyIRNode* lhs = binaryNode->src1.get();
+    const TackyIRNode* rhs = binaryNode->src2.get();
+    bool equality = cond_code == AsmIRCondCode::E || cond_code == AsmIRCondCode::NE;
+    if (equality && isTackyVar(lhs) && isTackyZero(rhs)) {
+        selectZeroCheck(lhs, instructions);
+    } else if (equality && isTackyZero(lhs) && isTackyVar(rhs)) {
+        selectZeroCheck(rhs, instructions);
+    } else if (!isTackyVar(lhs) && isTackyVar(rhs)) {
+        // cmpl can't take an immediate as its second operand, so swap the sides
+        instructions->instructions.push_back(std::make_unique<AsmIRCmp>(buildAsmIROperand(lhs), buildAsmIROperand(rhs)));
+        cond_code = swapCondition(cond_code);
+    } else {
+        instructions->instructions.push_back(std::make_unique<AsmIRCmp>(buildAsmIROperand(rhs), buildAsmIROperand(lhs)));
+    }
+    return cond_code;
+}
+
+/*
+    Cmp(src2, src1)
+    JmpCC(cond_code, target)
+*/
+bool selectCompareAndBranch(const TackyIRNode* condition, const TackyIRNode* jump, AsmIRInstructions* instructions) {
+    AsmIRCondCode cond_code;
+    if (condition->type == TackyIRNodeType::BINARY && isTackyComparison(static_cast<const TackyIRBinary*>(condition)->op->type)) {
+        cond_code = selectComparison(static_cast<const TackyIRBinary*>(condition), instructions);
+    } else if (condition->type == TackyIRNodeType::UNARY && static_cast<const TackyIRUnary*>(condition)->op->type == TackyIRNodeType::NOT) {
+        selectZeroCheck(static_cast<const TackyIRUnary*>(condition)->src.get(), instructions);
+        cond_code = AsmIRCondCode::E;
+    } else {
+        return false;
     }
 
-    return flat;
+    if (jump->type == TackyIRNodeType::JUMP_IF_ZERO) {
+        const auto* jumpNode = static_cast<const TackyIRJumpIfZero*>(jump);
+        instructions->instructions.push_back(std::make_unique<AsmIRJmpCC>(asmNegateCondition(cond_code), jumpNode->target));
+    } else {
+        const auto* jumpNode = static_cast<const TackyIRJumpIfNotZero*>(jump);
+        instructions->instructions.push_back(std::make_unique<AsmIRJmpCC>(cond_code, jumpNode->target));
+    }
+    return true;
 }
 
 // --- 1st Asm IR Pass---
+// Most TACKY instructions lower to one or two AsmIR instructions; division and compares
+// that materialize a boolean take up to four
+constexpr size_t asmInstructionsPerTacky = 2;
+
+AsmIROperand buildAsmIROperand(const TackyIRNode* node) {
+    if (node->type == TackyIRNodeType::CONSTANT) return asmImm(std::stoll(static_cast<const TackyIRConstant*>(node)->value));
+    return asmPseudo(static_cast<const TackyIRVar*>(node)->value);
+}
+
 std::unique_ptr<AsmIRNode> buildAsmIRAst(const TackyIRNode* node, AsmIRInstructions* instructions) {
     if (!node) return nullptr;
 
@@ -41,23 +137,21 @@ std::unique_ptr<AsmIRNode> buildAsmIRAst(const TackyIRNode* node, AsmIRInstructi
 
         case TackyIRNodeType::FUNCTION: {
             const auto* functionNode = static_cast<const TackyIRFunction*>(node);
+            const auto& body = functionNode->instructions->instructions;
             auto asmFunctionInstructions = std::make_unique<AsmIRInstructions>();
 
-            for (const auto& instructionNode : functionNode->instructions->instructions) {
-                buildAsmIRAst(instructionNode.get(), asmFunctionInstructions.get());
-            }
+            // selection appends straight into one flat list, sized for the common expansion
+            asmFunctionInstructions->instructions.reserve(body.size() * asmInstructionsPerTacky);
+            selectInstructions(body, asmFunctionInstructions.get());
 
-            auto flattened = passUnnest(std::move(asmFunctionInstructions));
-            return std::make_unique<AsmIRFunction>(functionNode->name, std::move(flattened));
+            return std::make_unique<AsmIRFunction>(functionNode->name, std::move(asmFunctionInstructions));
         }
 
         case TackyIRNodeType::RETURN: {
             const auto* returnNode = static_cast<const TackyIRReturn*>(node);
-            auto expr = buildAsmIRAst(returnNode->expr.get(), nullptr);
-            auto dst = std::make_unique<AsmIRReg>("AX");
 
             if (instructions) {
-                instructions->instructions.push_back(std::make_unique<AsmIRMov>(std::move(expr), std::move(dst)));
+                instructions->instructions.push_back(std::make_unique<AsmIRMov>(buildAsmIROperand(returnNode->expr.get()), asmReg(AsmIRRegister::AX)));
                 instructions->instructions.push_back(std::make_unique<AsmIRRet>());
             }
 
@@ -66,27 +160,13 @@ std::unique_ptr<AsmIRNode> buildAsmIRAst(const TackyIRNode* node, AsmIRInstructi
 
         case TackyIRNodeType::UNARY: {
             const auto* unaryNode = static_cast<const TackyIRUnary*>(node);
-            auto unaryOperator = buildAsmIRAst(unaryNode->op.get(), nullptr);
-            auto src = buildAsmIRAst(unaryNode->src.get(), nullptr);
-            auto dst_1 = buildAsmIRAst(unaryNode->dst.get(), nullptr);
-            auto dst_2 = buildAsmIRAst(unaryNode->dst.get(), nullptr);
 
+            // Negate and Complement are covered by the tree selector in isel.cpp
             if (unaryNode->op->type == TackyIRNodeType::NOT && instructions) {
-                instructions->instructions.push_back(std::make_unique<AsmIRCmp>(
-                    std::make_unique<AsmIRImm>("0"),
-                    std::move(src)
-                ));
-                instructions->instructions.push_back(std::make_unique<AsmIRMov>(
-                    std::make_unique<AsmIRImm>("0"),
-                    std::move(dst_1)
-                ));
-                instructions->instructions.push_back(std::make_unique<AsmIRSetCC>(
-                    "E",
-                    std::move(dst_2)
-                ));
-            } else if (instructions) {
-                instructions->instructions.push_back(std::make_unique<AsmIRMov>(std::move(src), std::move(dst_1)));
-                instructions->instructions.push_back(std::make_unique<AsmIRUnary>(std::move(unaryOperator), std::move(dst_2)));
+                selectZeroCheck(unaryNode->src.get(), instructions);
+                selectSetCC(AsmIRCondCode::E, unaryNode->dst.get(), instructions);
+            } else {
+                std::cout << "Error: TackyIR -> AsmIR" << std::endl;
             }
 
             return nullptr;
@@ -94,97 +174,34 @@ std::unique_ptr<AsmIRNode> buildAsmIRAst(const TackyIRNode* node, AsmIRInstructi
         case TackyIRNodeType::BINARY: {
             const auto* binaryNode = static_cast<const TackyIRBinary*>(node);
 
-
-            if (binaryNode->op->type == TackyIRNodeType::DIVIDE) {
-                /*
-                    Mov(src1, Reg(AX))
-                    Cdq
-                    Idiv(src2)
-                    Mov(Reg(AX), dst)
-                */
-                auto src1 = buildAsmIRAst(binaryNode->src1.get(), nullptr);
-                auto src2 = buildAsmIRAst(binaryNode->src2.get(), nullptr);
-                auto dst = buildAsmIRAst(binaryNode->dst.get(), nullptr);
-
-                if (instructions) {
-                    instructions->instructions.push_back(std::make_unique<AsmIRMov>(std::move(src1), std::make_unique<AsmIRReg>("AX")));
-                    instructions->instructions.push_back(std::make_unique<AsmIRCdq>());
-                    instructions->instructions.push_back(std::make_unique<AsmIRIdiv>(std::move(src2)));
-                    instructions->instructions.push_back(std::make_unique<AsmIRMov>(std::make_unique<AsmIRReg>("AX"), std::move(dst)));
-                }
-            } else if (binaryNode->op->type == TackyIRNodeType::REMAINDER) {
+            // constant divisors get shift and multiply-high sequences
+            int32_t constant;
+            if ((binaryNode->op->type == TackyIRNodeType::DIVIDE || binaryNode->op->type == TackyIRNodeType::REMAINDER) &&
+                parseTackyConstant(binaryNode->src2.get(), constant) &&
+                lowerDivideByConstant(binaryNode->src1.get(), constant, binaryNode->op->type == TackyIRNodeType::REMAINDER,
+                                      binaryNode->dst.get(), instructions)) {
+                return nullptr;
+            }
+            if (binaryNode->op->type == TackyIRNodeType::DIVIDE || binaryNode->op->type == TackyIRNodeType::REMAINDER) {
                 /*
                     Mov(src1, Reg(AX))
                     Cdq
                     Idiv(src2)
-                    Mov(Reg(DX), dst)
+                    Mov(Reg(AX), dst)       -- Reg(DX) for the remainder
                 */
-                auto src1 = buildAsmIRAst(binaryNode->src1.get(), nullptr);
-                auto src2 = buildAsmIRAst(binaryNode->src2.get(), nullptr);
-                auto dst = buildAsmIRAst(binaryNode->dst.get(), nullptr);
-
+                AsmIRRegister result = binaryNode->op->type == TackyIRNodeType::DIVIDE ? AsmIRRegister::AX : AsmIRRegister::DX;
                 if (instructions) {
-                    instructions->instructions.push_back(std::make_unique<AsmIRMov>(std::move(src1), std::make_unique<AsmIRReg>("AX")));
+                    instructions->instructions.push_back(std::make_unique<AsmIRMov>(buildAsmIROperand(binaryNode->src1.get()), asmReg(AsmIRRegister::AX)));
                     instructions->instructions.push_back(std::make_unique<AsmIRCdq>());
-                    instructions->instructions.push_back(std::make_unique<AsmIRIdiv>(std::move(src2)));
-                    instructions->instructions.push_back(std::make_unique<AsmIRMov>(std::make_unique<AsmIRReg>("DX"), std::move(dst)));
-                }
-            } else if (binaryNode->op->type == TackyIRNodeType::EQUAL ||
-                        binaryNode->op->type == TackyIRNodeType::NOT_EQUAL ||
-                        binaryNode->op->type == TackyIRNodeType::LESS_THAN ||
-                        binaryNode->op->type == TackyIRNodeType::GREATER_THAN ||
-                        binaryNode->op->type == TackyIRNodeType::LESS_OR_EQUAL ||
-                        binaryNode->op->type == TackyIRNodeType::GREATER_OR_EQUAL) {
-
-                std::string cond_code = "";
-
-                if (binaryNode->op->type == TackyIRNodeType::EQUAL) {
-                    cond_code = "E";
-                } else if (binaryNode->op->type == TackyIRNodeType::NOT_EQUAL) {
-                    cond_code = "NE";
-                } else if (binaryNode->op->type == TackyIRNodeType::LESS_THAN) {
-                    cond_code = "L";
-                } else if (binaryNode->op->type == TackyIRNodeType::GREATER_THAN) {
-                    cond_code = "G";
-                } else if (binaryNode->op->type == TackyIRNodeType::LESS_OR_EQUAL) {
-                    cond_code = "LE";
-                } else if (binaryNode->op->type == TackyIRNodeType::GREATER_OR_EQUAL) {
-                    cond_code = "GE";
+                    instructions->instructions.push_back(std::make_unique<AsmIRIdiv>(buildAsmIROperand(binaryNode->src2.get())));
+                    instructions->instructions.push_back(std::make_unique<AsmIRMov>(asmReg(result), buildAsmIROperand(binaryNode->dst.get())));
                 }
-
-                auto src1 = buildAsmIRAst(binaryNode->src1.get(), nullptr);
-                auto src2 = buildAsmIRAst(binaryNode->src2.get(), nullptr);
-                auto dst_1 = buildAsmIRAst(binaryNode->dst.get(), nullptr);
-                auto dst_2 = buildAsmIRAst(binaryNode->dst.get(), nullptr);
-
-                instructions->instructions.push_back(std::make_unique<AsmIRCmp>(
-                    std::move(src2),
-                    std::move(src1)
-                ));
-                instructions->instructions.push_back(std::make_unique<AsmIRMov>(
-                    std::make_unique<AsmIRImm>("0"),
-                    std::move(dst_1)
-                ));
-                instructions->instructions.push_back(std::make_unique<AsmIRSetCC>(
-                    cond_code,
-                    std::move(dst_2)
-                ));
+            } else if (isTackyComparison(binaryNode->op->type)) {
+                selectSetCC(selectComparison(binaryNode, instructions), binaryNode->dst.get(), instructions);
                 return nullptr;
             } else {
-                /*
-                    Mov(src1, dst)
-                    Binary(binary_operator, src2, dst)
-                */
-                auto binaryOperator = buildAsmIRAst(binaryNode->op.get(), nullptr);
-                auto src1 = buildAsmIRAst(binaryNode->src1.get(), nullptr);
-                auto src2 = buildAsmIRAst(binaryNode->src2.get(), nullptr);
-                auto dst_1 = buildAsmIRAst(binaryNode->dst.get(), nullptr);
-                auto dst_2 = buildAsmIRAst(binaryNode->dst.get(), nullptr);
-
-                if (instructions) {
-                    instructions->instructions.push_back(std::make_unique<AsmIRMov>(std::move(src1), std::move(dst_1)));
-                    instructions->instructions.push_back(std::make_unique<AsmIRBinary>(std::move(binaryOperator), std::move(src2), std::move(dst_2)));
-                }
+                // arithmetic is covered by the tree selector in isel.cpp
+                std::cout << "Error: TackyIR -> AsmIR" << std::endl;
             }
 
             return nullptr;
@@ -196,37 +213,21 @@ std::unique_ptr<AsmIRNode> buildAsmIRAst(const TackyIRNode* node, AsmIRInstructi
         }
         case TackyIRNodeType::JUMP_IF_ZERO: {
             const auto* jumpNode = static_cast<const TackyIRJumpIfZero*>(node);
-            auto condition = buildAsmIRAst(jumpNode->condition.get(), nullptr);
-            instructions->instructions.push_back(std::make_unique<AsmIRCmp>(
-                std::make_unique<AsmIRImm>("0"),
-                std::move(condition)
-            ));
-            instructions->instructions.push_back(std::make_unique<AsmIRJmpCC>(
-                "E",
-                jumpNode->target
-            ));
+            selectZeroCheck(jumpNode->condition.get(), instructions);
+            instructions->instructions.push_back(std::make_unique<AsmIRJmpCC>(AsmIRCondCode::E, jumpNode->target));
             return nullptr;
         }
         case TackyIRNodeType::JUMP_IF_NOT_ZERO: {
             const auto* jumpNode = static_cast<const TackyIRJumpIfNotZero*>(node);
-            auto condition = buildAsmIRAst(jumpNode->condition.get(), nullptr);
-            instructions->instructions.push_back(std::make_unique<AsmIRCmp>(
-                std::make_unique<AsmIRImm>("0"),
-                std::move(condition)
-            ));
-            instructions->instructions.push_back(std::make_unique<AsmIRJmpCC>(
-                "NE",
-                jumpNode->target
-            ));
+            selectZeroCheck(jumpNode->condition.get(), instructions);
+            instructions->instructions.push_back(std::make_unique<AsmIRJmpCC>(AsmIRCondCode::NE, jumpNode->target));
             return nullptr;
         }
         case TackyIRNodeType::COPY: {
             const auto* copyNode = static_cast<const TackyIRCopy*>(node);
-            auto src = buildAsmIRAst(copyNode->src.get(), nullptr);
-            auto dst = buildAsmIRAst(copyNode->dst.get(), nullptr);
             instructions->instructions.push_back(std::make_unique<AsmIRMov>(
-                std::move(src),
-                std::move(dst)
+                buildAsmIROperand(copyNode->src.get()),
+                buildAsmIROperand(copyNode->dst.get())
             ));
             return nullptr;
         }
@@ -235,19 +236,6 @@ std::unique_ptr<AsmIRNode> buildAsmIRAst(const TackyIRNode* node, AsmIRInstructi
             instructions->instructions.push_back(std::make_unique<AsmIRLabel>(labelNode->identifier));
             return nullptr;
         }
-        case TackyIRNodeType::NEGATE: return std::make_unique<AsmIRNeg>();
-        case TackyIRNodeType::COMPLEMENT: return std::make_unique<AsmIRNot>();
-        case TackyIRNodeType::ADD: return std::make_unique<AsmIRAdd>();
-        case TackyIRNodeType::SUBTRACT: return std::make_unique<AsmIRSubtract>();
-        case TackyIRNodeType::MULTIPLY: return std::make_unique<AsmIRMultiply>();
-        case TackyIRNodeType::CONSTANT: {
-            const auto* constantNode = static_cast<const TackyIRConstant*>(node);
-            return std::make_unique<AsmIRImm>(constantNode->value);
-        }
-        case TackyIRNodeType::VAR: {
-            const auto* varNode = static_cast<const TackyIRVar*>(node);
-            return std::make_unique<AsmIRPseudo>(varNode->value);
-        }
 
         default:
             std::cout << "Error: TackyIR -> AsmIR" << std::endl;
@@ -255,354 +243,237 @@ std::unique_ptr<AsmIRNode> buildAsmIRAst(const TackyIRNode* node, AsmIRInstructi
     }
 }
 
-void passReplacePseudos(AsmIRNode* node, std::unordered_map<std::string, int>& pseudoToOffset, int& nextOffset) {
-    if (!node) return;
+// --- Legalization ---
+// Appends instr to out, or the sequence that replaces it when its operands are a
+// combination x86 can't encode. R10 and R11 are the scratch registers.
+static void legalizeInstruction(std::unique_ptr<AsmIRNode> node, std::vector<std::unique_ptr<AsmIRNode>>& out) {
+    const AsmIROperand r10 = asmReg(AsmIRRegister::R10);
+    const AsmIROperand r11 = asmReg(AsmIRRegister::R11);
 
     switch (node->type) {
-        case AsmIRNodeType::PROGRAM: {
-            auto* programNode = static_cast<AsmIRProgram*>(node);
-            passReplacePseudos(programNode->function.get(), pseudoToOffset, nextOffset);
-            break;
-        }
-
-        case AsmIRNodeType::FUNCTION: {
-            auto* fn = static_cast<AsmIRFunction*>(node);
-            if (fn->instructions) {
-                for (auto& instr : fn->instructions->instructions) {
-                    passReplacePseudos(instr.get(), pseudoToOffset, nextOffset);
-                }
-            }
-            break;
-        }
-
         case AsmIRNodeType::MOV: {
-            auto* move = static_cast<AsmIRMov*>(node);
-
-            // source
-            if (move->src->type == AsmIRNodeType::PSEUDO) {
-                auto* pseudo = static_cast<AsmIRPseudo*>(move->src.get());
-                auto& id = pseudo->identifier;
-                if (!pseudoToOffset.count(id)) {
-                    pseudoToOffset[id] = nextOffset;
-                    nextOffset -= 4;
-                }
-                move->src = std::make_unique<AsmIRStack>(pseudoToOffset[id]);
-            }
-
-            // destination
-            if (move->dst->type == AsmIRNodeType::PSEUDO) {
-                auto* pseudo = static_cast<AsmIRPseudo*>(move->dst.get());
-                auto& id = pseudo->identifier;
-                if (!pseudoToOffset.count(id)) {
-                    pseudoToOffset[id] = nextOffset;
-                    nextOffset -= 4;
-                }
-                move->dst = std::make_unique<AsmIRStack>(pseudoToOffset[id]);
-            }
-            break;
-        }
+            auto* move = static_cast<AsmIRMov*>(node.get());
 
-        case AsmIRNodeType::UNARY: {
-            auto* unary = static_cast<AsmIRUnary*>(node);
-            if (unary->operand->type == AsmIRNodeType::PSEUDO) {
-                auto* pseudo = static_cast<AsmIRPseudo*>(unary->operand.get());
-                auto& id = pseudo->identifier;
-                if (!pseudoToOffset.count(id)) {
-                    pseudoToOffset[id] = nextOffset;
-                    nextOffset -= 4;
-                }
-                unary->operand = std::make_unique<AsmIRStack>(pseudoToOffset[id]);
+            if (move->src.type == AsmIRNodeType::STACK && move->dst.type == AsmIRNodeType::STACK) {
+                out.push_back(std::make_unique<AsmIRMov>(move->src, r10));
+                out.push_back(std::make_unique<AsmIRMov>(r10, move->dst));
+                return;
             }
             break;
         }
 
-        case AsmIRNodeType::BINARY: {
-            auto* binary = static_cast<AsmIRBinary*>(node);
-            if (binary->operand1->type == AsmIRNodeType::PSEUDO) {
-                auto* pseudo = static_cast<AsmIRPseudo*>(binary->operand1.get());
-                auto& id = pseudo->identifier;
-                if (!pseudoToOffset.count(id)) {
-                    pseudoToOffset[id] = nextOffset;
-                    nextOffset -= 4;
-                }
-                binary->operand1 = std::make_unique<AsmIRStack>(pseudoToOffset[id]);
-            }
-
-            if (binary->operand2->type == AsmIRNodeType::PSEUDO) {
-                auto* pseudo = static_cast<AsmIRPseudo*>(binary->operand2.get());
-                auto& id = pseudo->identifier;
-                if (!pseudoToOffset.count(id)) {
-                    pseudoToOffset[id] = nextOffset;
-                    nextOffset -= 4;
-                }
-                binary->operand2 = std::make_unique<AsmIRStack>(pseudoToOffset[id]);
-            }
-            break;
-        }
+        case AsmIRNodeType::CMP: {
+            auto* cmp = static_cast<AsmIRCmp*>(node.get());
 
-        case AsmIRNodeType::IDIV: {
-            auto* idiv = static_cast<AsmIRIdiv*>(node);
-            if (idiv->operand->type == AsmIRNodeType::PSEUDO) {
-                auto* pseudo = static_cast<AsmIRPseudo*>(idiv->operand.get());
-                auto& id = pseudo->identifier;
-                if (!pseudoToOffset.count(id)) {
-                    pseudoToOffset[id] = nextOffset;
-                    nextOffset -= 4;
-                }
-                idiv->operand = std::make_unique<AsmIRStack>(pseudoToOffset[id]);
+            if (cmp->operand1.type == AsmIRNodeType::STACK && cmp->operand2.type == AsmIRNodeType::STACK) {
+                out.push_back(std::make_unique<AsmIRMov>(cmp->operand1, r10));
+                out.push_back(std::make_unique<AsmIRCmp>(r10, cmp->operand2));
+                return;
             }
-            break;
-        }
-        
-        case AsmIRNodeType::SET_CC: {
-            auto* setCC = static_cast<AsmIRSetCC*>(node);
-            if (setCC->operand->type == AsmIRNodeType::PSEUDO) {
-                auto* pseudo = static_cast<AsmIRPseudo*>(setCC->operand.get());
-                auto& id = pseudo->identifier;
-                if (!pseudoToOffset.count(id)) {
-                    pseudoToOffset[id] = nextOffset;
-                    nextOffset -= 4;
-                }
-                setCC->operand = std::make_unique<AsmIRStack>(pseudoToOffset[id]);
+            if (cmp->operand2.type == AsmIRNodeType::IMMEDIATE) {
+                out.push_back(std::make_unique<AsmIRMov>(cmp->operand2, r11));
+                out.push_back(std::make_unique<AsmIRCmp>(cmp->operand1, r11));
+                return;
             }
             break;
         }
 
-        case AsmIRNodeType::CMP: {
-            auto* cmp = static_cast<AsmIRCmp*>(node);
-            if (cmp->operand1->type == AsmIRNodeType::PSEUDO) {
-                auto* pseudo = static_cast<AsmIRPseudo*>(cmp->operand1.get());
-                auto& id = pseudo->identifier;
-                if (!pseudoToOffset.count(id)) {
-                    pseudoToOffset[id] = nextOffset;
-                    nextOffset -= 4;
-                }
-                cmp->operand1 = std::make_unique<AsmIRStack>(pseudoToOffset[id]);
+        case AsmIRNodeType::TEST: {
+            // testl can't take two memory operands; compare the slot against zero instead
+            auto* test = static_cast<AsmIRTest*>(node.get());
+            if (test->operand1.type == AsmIRNodeType::STACK && test->operand2.type == AsmIRNodeType::STACK) {
+                out.push_back(std::make_unique<AsmIRCmp>(asmImm(0), test->operand2));
+                return;
             }
-            if (cmp->operand2->type == AsmIRNodeType::PSEUDO) {
-                auto* pseudo = static_cast<AsmIRPseudo*>(cmp->operand2.get());
-                auto& id = pseudo->identifier;
-                if (!pseudoToOffset.count(id)) {
-                    pseudoToOffset[id] = nextOffset;
-                    nextOffset -= 4;
-                }
-                cmp->operand2 = std::make_unique<AsmIRStack>(pseudoToOffset[id]);
-            }
-            break;
-        }
-
-
-        default:
             break;
-    }
-}
-
-std::unique_ptr<AsmIRNode> passFixes(std::unique_ptr<AsmIRNode> node, AsmIRInstructions* instructions, int& nextOffset) {
-    if (!node) return nullptr;
-
-    switch (node->type) {
-        case AsmIRNodeType::PROGRAM: {
-            auto* programNode = static_cast<AsmIRProgram*>(node.get());
-            auto newFn = passFixes(std::move(programNode->function), nullptr, nextOffset);
-            programNode->function = std::unique_ptr<AsmIRFunction>(
-                static_cast<AsmIRFunction*>(newFn.release())
-            );
-            return node;
         }
 
-        case AsmIRNodeType::FUNCTION: {
-            auto* fn = static_cast<AsmIRFunction*>(node.get());
-            auto asmFunctionInstructions = std::make_unique<AsmIRInstructions>();
-
-            if (fn->instructions) {
-                auto &oldVec = fn->instructions->instructions;
-                std::vector<std::unique_ptr<AsmIRNode>> newVec;
-                newVec.reserve(oldVec.size());
-
-                asmFunctionInstructions->instructions.push_back(
-                    std::make_unique<AsmIRAllocateStack>(-(nextOffset + 4))
-                );
-
-                for (auto &oldInstr : oldVec) {
-                    std::unique_ptr<AsmIRNode> taken = std::move(oldInstr);
-                    passFixes(std::move(taken), asmFunctionInstructions.get(), nextOffset);
-                }
-
-                fn->instructions = std::move(asmFunctionInstructions);
-                for (auto &n : newVec)
-                    fn->instructions->instructions.push_back(std::move(n));
-            }
-
-            return node;
-        }
-
-        case AsmIRNodeType::MOV: {
-            auto* move = static_cast<AsmIRMov*>(node.get());
+        case AsmIRNodeType::MOVZX: {
+            auto* movzx = static_cast<AsmIRMovZeroExtend*>(node.get());
+            if (movzx->dst.type != AsmIRNodeType::STACK) break;
 
-            if (move->src->type == AsmIRNodeType::STACK &&
-                move->dst->type == AsmIRNodeType::STACK) {
-                auto src = std::move(move->src);
-                auto dst = std::move(move->dst);
-                instructions->instructions.push_back(std::make_unique<AsmIRMov>(std::move(src), std::make_unique<AsmIRReg>("R10")));
-                instructions->instructions.push_back(std::make_unique<AsmIRMov>(std::make_unique<AsmIRReg>("R10"), std::move(dst)));
-                return nullptr;
-            } else {
-                if (instructions) {
-                    instructions->instructions.push_back(std::move(node));
-                    return nullptr;
-                } else {
-                    return node;
-                }
-            }
-        }
-
-        case AsmIRNodeType::CMP: {
-            auto* cmp = static_cast<AsmIRCmp*>(node.get());
-
-            if (cmp->operand1->type == AsmIRNodeType::STACK &&
-                cmp->operand2->type == AsmIRNodeType::STACK) {
-                auto operand1 = std::move(cmp->operand1);
-                auto operand2 = std::move(cmp->operand2);
-                instructions->instructions.push_back(std::make_unique<AsmIRMov>(std::move(operand1), std::make_unique<AsmIRReg>("R10")));
-                instructions->instructions.push_back(std::make_unique<AsmIRCmp>(std::make_unique<AsmIRReg>("R10"), std::move(operand2)));
-            } else if (cmp->operand2->type == AsmIRNodeType::IMMEDIATE) {
-                auto operand1 = std::move(cmp->operand1);
-                auto operand2 = std::move(cmp->operand2);
-                instructions->instructions.push_back(std::make_unique<AsmIRMov>(std::move(operand2), std::make_unique<AsmIRReg>("R11")));
-                instructions->instructions.push_back(std::make_unique<AsmIRCmp>(std::move(operand1), std::make_unique<AsmIRReg>("R11")));
-            } else if (instructions) {
-                instructions->instructions.push_back(std::move(node));
-                return nullptr;
-            }
-
-            return node;
-        }
-
-        case AsmIRNodeType::UNARY: {
-            if (instructions) {
-                instructions->instructions.push_back(std::move(node));
-                return nullptr;
+            bool extendsSetCC = movzx->src == movzx->dst && !out.empty() && out.back()->type == AsmIRNodeType::SET_CC &&
+                static_cast<AsmIRSetCC*>(out.back().get())->operand == movzx->dst;
+            if (extendsSetCC) {
+                /*
+                    Mov(Imm(0), dst)
+                    SetCC(cond_code, dst)
+                */
+                out.insert(out.end() - 1, std::make_unique<AsmIRMov>(asmImm(0), movzx->dst));
+                return;
             }
-            return node;
+            AsmIROperand dst = movzx->dst;
+            movzx->dst = r11;
+            out.push_back(std::move(node));
+            out.push_back(std::make_unique<AsmIRMov>(r11, dst));
+            return;
         }
 
         case AsmIRNodeType::BINARY: {
             auto* binary = static_cast<AsmIRBinary*>(node.get());
-            if (instructions &&
-                (binary->binary_operator->type == AsmIRNodeType::ADD || binary->binary_operator->type == AsmIRNodeType::SUBTRACT) &&
-                (binary->operand1->type == AsmIRNodeType::STACK && binary->operand2->type == AsmIRNodeType::STACK)) {
-
-                auto binary_operator = std::move(binary->binary_operator);
-                auto operand1 = std::move(binary->operand1);
-                auto operand2 = std::move(binary->operand2);
-                instructions->instructions.push_back(std::make_unique<AsmIRMov>(std::move(operand1), std::make_unique<AsmIRReg>("R10")));
-                instructions->instructions.push_back(std::make_unique<AsmIRBinary>(std::move(binary_operator), std::make_unique<AsmIRReg>("R10"), std::move(operand2)));
-
-            } else if (instructions &&
-                binary->binary_operator->type == AsmIRNodeType::MULTIPLY &&
-                binary->operand2->type == AsmIRNodeType::STACK) {
-
-                auto binary_operator = std::move(binary->binary_operator);
-                auto operand1 = std::move(binary->operand1);
-
-                auto* casted_operand2 = dynamic_cast<AsmIRStack*>(binary->operand2.get());
-                auto operand2_2 = std::make_unique<AsmIRStack>(casted_operand2->stack_size);
-                auto operand2 = std::move(binary->operand2);
-
-                instructions->instructions.push_back(std::make_unique<AsmIRMov>(std::move(operand2), std::make_unique<AsmIRReg>("R11")));
-                instructions->instructions.push_back(std::make_unique<AsmIRBinary>(std::move(binary_operator), std::move(operand1), std::make_unique<AsmIRReg>("R11")));
-                instructions->instructions.push_back(std::make_unique<AsmIRMov>(std::make_unique<AsmIRReg>("R11"), std::move(operand2_2)));
-            } else if (instructions) {
-                instructions->instructions.push_back(std::move(node));
-                return nullptr;
+            AsmIRNodeType op = binary->binary_operator;
+            if ((op == AsmIRNodeType::ADD || op == AsmIRNodeType::SUBTRACT || op == AsmIRNodeType::AND || op == AsmIRNodeType::OR) &&
+                binary->operand1.type == AsmIRNodeType::STACK && binary->operand2.type == AsmIRNodeType::STACK) {
+                out.push_back(std::make_unique<AsmIRMov>(binary->operand1, r10));
+                out.push_back(std::make_unique<AsmIRBinary>(op, r10, binary->operand2));
+                return;
             }
-            return nullptr;
-        }
-
-        case AsmIRNodeType::CDQ: {
-            if (instructions) {
-                instructions->instructions.push_back(std::move(node));
-                return nullptr;
+            if (op == AsmIRNodeType::MULTIPLY && binary->operand2.type == AsmIRNodeType::STACK) {
+                out.push_back(std::make_unique<AsmIRMov>(binary->operand2, r11));
+                out.push_back(std::make_unique<AsmIRBinary>(op, binary->operand1, r11));
+                out.push_back(std::make_unique<AsmIRMov>(r11, binary->operand2));
+                return;
             }
-            return node;
+            break;
         }
 
-        case AsmIRNodeType::SET_CC: {
-            if (instructions) {
-                instructions->instructions.push_back(std::move(node));
-                return nullptr;
+        case AsmIRNodeType::IDIV: {
+            auto* idiv = static_cast<AsmIRIdiv*>(node.get());
+            if (idiv->operand.type == AsmIRNodeType::IMMEDIATE) {
+                out.push_back(std::make_unique<AsmIRMov>(idiv->operand, r10));
+                out.push_back(std::make_unique<AsmIRIdiv>(r10));
+                return;
             }
-            return node;
+            break;
         }
 
-        case AsmIRNodeType::JMP: {
-            if (instructions) {
-                instructions->instructions.push_back(std::move(node));
-                return nullptr;
+        case AsmIRNodeType::IMUL_WIDE: {
+            auto* imul = static_cast<AsmIRImulWide*>(node.get());
+            if (imul->operand.type == AsmIRNodeType::IMMEDIATE) {
+                out.push_back(std::make_unique<AsmIRMov>(imul->operand, r10));
+                out.push_back(std::make_unique<AsmIRImulWide>(r10));
+                return;
             }
-            return node;
+            break;
         }
 
-        case AsmIRNodeType::JMP_CC: {
-            if (instructions) {
-                instructions->instructions.push_back(std::move(node));
-                return nullptr;
+        case AsmIRNodeType::LEA: {
+            /*
+                Mov(base, Reg(R10))
+                Mov(index, Reg(R11))
+                Lea(Reg(R10), Reg(R11), scale, displacement, Reg(R11))
+                Mov(Reg(R11), dst)
+            */
+            auto* lea = static_cast<AsmIRLea*>(node.get());
+            bool sharedSlot = lea->base.type == AsmIRNodeType::STACK && lea->base == lea->index;
+            if (lea->base.type == AsmIRNodeType::STACK) {
+                out.push_back(std::make_unique<AsmIRMov>(lea->base, r10));
+                lea->base = r10;
             }
-            return node;
-        }
-
-        case AsmIRNodeType::LABEL: {
-            if (instructions) {
-                instructions->instructions.push_back(std::move(node));
-                return nullptr;
+            if (sharedSlot) {
+                lea->index = r10;
+            } else if (lea->index.type == AsmIRNodeType::STACK) {
+                out.push_back(std::make_unique<AsmIRMov>(lea->index, r11));
+                lea->index = r11;
             }
-            return node;
-        }
-        
-        case AsmIRNodeType::IDIV: {
-            auto* idiv = static_cast<AsmIRIdiv*>(node.get());
-            if (idiv->operand->type == AsmIRNodeType::IMMEDIATE) {
-                auto operand = std::move(idiv->operand);
-                instructions->instructions.push_back(std::make_unique<AsmIRMov>(std::move(operand), std::make_unique<AsmIRReg>("R10")));
-                instructions->instructions.push_back(std::make_unique<AsmIRIdiv>(std::make_unique<AsmIRReg>("R10")));
-                return nullptr;
-            } else {
-                if (instructions) {
-                    instructions->instructions.push_back(std::move(node));
-                    return nullptr;
-                }
-
-                return node;
+            if (lea->dst.type == AsmIRNodeType::STACK) {
+                AsmIROperand dst = lea->dst;
+                lea->dst = r11;
+                out.push_back(std::move(node));
+                out.push_back(std::make_unique<AsmIRMov>(r11, dst));
+                return;
             }
+            break;
         }
 
-        case AsmIRNodeType::RETURN: {
-            if (instructions) {
-                instructions->instructions.push_back(std::move(node));
-                return nullptr;
-            }
-            return node;
-        }
+        case AsmIRNodeType::UNARY:
+        case AsmIRNodeType::CDQ:
+        case AsmIRNodeType::SET_CC:
+        case AsmIRNodeType::JMP:
+        case AsmIRNodeType::JMP_CC:
+        case AsmIRNodeType::LABEL:
+        case AsmIRNodeType::RETURN:
+            break;
 
         default:
             std::cout << "Error: AsmIRNode not handled through pass." << std::endl;
-            return node;
+            break;
     }
+    out.push_back(std::move(node));
 }
 
+/*
+    Replaces the pseudos left after register allocation with their stack slots and
+    legalizes each instruction as it goes, moving the function body into a buffer
+    sized for the usual expansion once rather than rebuilding it per rewrite.
+*/
+void passLegalize(AsmIRNode* node, const std::unordered_map<int64_t, int>& pseudoToOffset, int nextOffset) {
+    if (!node || node->type != AsmIRNodeType::PROGRAM) return;
+    auto* fn = static_cast<AsmIRProgram*>(node)->function.get();
+    if (!fn || !fn->instructions) return;
+    auto& instrs = fn->instructions->instructions;
+
+    std::vector<std::unique_ptr<AsmIRNode>> out;
+    out.reserve(instrs.size() * 3 / 2 + 1);
+
+    // Functions are leaves, so slots within the 128-byte red zone below %rsp need no
+    // allocation. Larger frames subtract enough to leave %rsp 16-byte aligned, given the
+    // return address already on the stack. Slot coloring has already handed out every
+    // offset, so the frame size is known before the walk.
+    int slotBytes = -(nextOffset + 4);
+    if (slotBytes > 128) out.push_back(std::make_unique<AsmIRAllocateStack>((slotBytes + 8 + 15) / 16 * 16 - 8));
+
+    for (auto& instr : instrs) {
+        // every operand slot is either read or written, so liveness's view of the
+        // instruction reaches all of them
+        auto slots = asmUses(instr.get());
+        for (auto* def : asmDefinitions(instr.get())) slots.push_back(def);
+        for (auto* operand : slots) {
+            if (operand->type == AsmIRNodeType::PSEUDO) *operand = asmStack(pseudoToOffset.at(operand->value));
+        }
+        legalizeInstruction(std::move(instr), out);
+    }
+    instrs = std::move(out);
+}
 
 // --- Generate Asm IR ---
 std::unique_ptr<AsmIRNode> generateCode(const TackyIRNode* node) {
     auto asm_ir = buildAsmIRAst(node, nullptr);
-    std::unordered_map<std::string, int> pseudoToOffset;
-    int nextOffset = -4;
-
-    passReplacePseudos(asm_ir.get(), pseudoToOffset, nextOffset);
-    asm_ir = passFixes(std::move(asm_ir), nullptr, nextOffset);
+    runAsmPasses(asm_ir.get());
     return std::move(asm_ir);
 }
 
 // --- Pretty IR Printer ---
+static const char* const registerNames[] = {"AX", "CX", "DX", "SI", "DI", "R8", "R9", "R10", "R11"};
+static const char* const condCodeNames[] = {"E", "NE", "L", "LE", "G", "GE"};
+
+static void printOperand(const AsmIROperand& operand) {
+    switch (operand.type) {
+        case AsmIRNodeType::IMMEDIATE:
+            std::cout << "Imm(" << operand.value << ")";
+            break;
+        case AsmIRNodeType::PSEUDO:
+            std::cout << "Pseudo(" << asmPseudoName(operand.value) << ")";
+            break;
+        case AsmIRNodeType::REGISTER:
+            std::cout << "Register(" << registerNames[static_cast<int>(operand.reg)] << ")";
+            break;
+        case AsmIRNodeType::STACK:
+            std::cout << "Stack(" << operand.value << ")";
+            break;
+        default:
+            std::cout << "None";
+            break;
+    }
+}
+
+static void printOperator(AsmIRNodeType op) {
+    switch (op) {
+        case AsmIRNodeType::NOT: std::cout << "Not()"; break;
+        case AsmIRNodeType::NEG: std::cout << "Neg()"; break;
+        case AsmIRNodeType::ADD: std::cout << "Add()"; break;
+        case AsmIRNodeType::SUBTRACT: std::cout << "Subtract()"; break;
+        case AsmIRNodeType::MULTIPLY: std::cout << "Multiply()"; break;
+        case AsmIRNodeType::SAR: std::cout << "Sar()"; break;
+        case AsmIRNodeType::SHL: std::cout << "Shl()"; break;
+        case AsmIRNodeType::SHR: std::cout << "Shr()"; break;
+        case AsmIRNodeType::AND: std::cout << "And()"; break;
+        case AsmIRNodeType::OR: std::cout << "Or()"; break;
+        case AsmIRNodeType::XOR: std::cout << "Xor()"; break;
+        default: std::cout << "UnknownOperator()"; break;
+    }
+}
+
 void printIR(const AsmIRNode* node, int space = 0) {
     if (!node) return;
 
@@ -629,27 +500,12 @@ void printIR(const AsmIRNode* node, int space = 0) {
         case AsmIRNodeType::MOV: {
             const auto* moveNode = static_cast<const AsmIRMov*>(node);
             std::cout << indent << "Mov(";
-            printIR(moveNode->src.get(), 0);
+            printOperand(moveNode->src);
             std::cout << ", ";
-            printIR(moveNode->dst.get(), 0);
+            printOperand(moveNode->dst);
             std::cout << ")\n";
             break;
         }
-        case AsmIRNodeType::IMMEDIATE: {
-            const auto* immNode = static_cast<const AsmIRImm*>(node);
-            std::cout << "Imm(" << immNode->value << ")";
-            break;
-        }
-        case AsmIRNodeType::PSEUDO: {
-            const auto* pseudoNode = static_cast<const AsmIRPseudo*>(node);
-            std::cout << "Pseudo(" << pseudoNode->identifier << ")";
-            break;
-        }
-        case AsmIRNodeType::REGISTER: {
-            const auto* regNode = static_cast<const AsmIRReg*>(node);
-            std::cout << "Register(" << regNode->value << ")";
-            break;
-        }
         case AsmIRNodeType::RETURN: {
             std::cout << indent << "Return()" << std::endl;
             break;
@@ -657,27 +513,45 @@ void printIR(const AsmIRNode* node, int space = 0) {
         case AsmIRNodeType::UNARY: {
             const auto* unaryNode = static_cast<const AsmIRUnary*>(node);
             std::cout << indent << "Unary(";
-            printIR(unaryNode->unary_operator.get(), 0);
+            printOperator(unaryNode->unary_operator);
             std::cout << ", ";
-            printIR(unaryNode->operand.get(), 0);
+            printOperand(unaryNode->operand);
             std::cout << ")\n";
             break;
         }
         case AsmIRNodeType::BINARY: {
             const auto* binaryNode = static_cast<const AsmIRBinary*>(node);
             std::cout << indent << "Binary(";
-            printIR(binaryNode->binary_operator.get(), 0);
+            printOperator(binaryNode->binary_operator);
             std::cout << ", ";
-            printIR(binaryNode->operand1.get(), 0);
+            printOperand(binaryNode->operand1);
             std::cout << ", ";
-            printIR(binaryNode->operand2.get(), 0);
+            printOperand(binaryNode->operand2);
             std::cout << ")" << std::endl;
             break;
         }
         case AsmIRNodeType::IDIV: {
             const auto* idivNode = static_cast<const AsmIRIdiv*>(node);
             std::cout << indent << "Idiv(";
-            printIR(idivNode->operand.get(), 0);
+            printOperand(idivNode->operand);
+            std::cout << ")" << std::endl;
+            break;
+        }
+        case AsmIRNodeType::IMUL_WIDE: {
+            const auto* imulNode = static_cast<const AsmIRImulWide*>(node);
+            std::cout << indent << "ImulWide(";
+            printOperand(imulNode->operand);
+            std::cout << ")" << std::endl;
+            break;
+        }
+        case AsmIRNodeType::LEA: {
+            const auto* leaNode = static_cast<const AsmIRLea*>(node);
+            std::cout << indent << "Lea(";
+            printOperand(leaNode->base);
+            std::cout << ", ";
+            printOperand(leaNode->index);
+            std::cout << ", " << leaNode->scale << ", " << leaNode->displacement << ", ";
+            printOperand(leaNode->dst);
             std::cout << ")" << std::endl;
             break;
         }
@@ -688,22 +562,45 @@ void printIR(const AsmIRNode* node, int space = 0) {
         case AsmIRNodeType::CMP: {
             const auto* cmpNode = static_cast<const AsmIRCmp*>(node);
             std::cout << indent << "Cmp(";
-            printIR(cmpNode->operand1.get(), 0);
+            printOperand(cmpNode->operand1);
+            std::cout << ", ";
+            printOperand(cmpNode->operand2);
+            std::cout << ")" << std::endl;
+            break;
+        }
+        case AsmIRNodeType::TEST: {
+            const auto* testNode = static_cast<const AsmIRTest*>(node);
+            std::cout << indent << "Test(";
+            printOperand(testNode->operand1);
             std::cout << ", ";
-            printIR(cmpNode->operand2.get(), 0);
+            printOperand(testNode->operand2);
+            std::cout << ")" << std::endl;
+            break;
+        }
+        case AsmIRNodeType::MOVZX: {
+            const auto* movzxNode = static_cast<const AsmIRMovZeroExtend*>(node);
+            std::cout << indent << "MovZeroExtend(";
+            printOperand(movzxNode->src);
+            std::cout << ", ";
+            printOperand(movzxNode->dst);
             std::cout << ")" << std::endl;
             break;
         }
         case AsmIRNodeType::SET_CC: {
             const auto* setCCNode = static_cast<const AsmIRSetCC*>(node);
-            std::cout << indent << "SetCC(" << setCCNode->cond_code << ", ";
-            printIR(setCCNode->operand.get(), 0);
+            std::cout << indent << "SetCC(" << condCodeNames[static_cast<int>(setCCNode->cond_code)] << ", ";
+            printOperand(setCCNode->operand);
             std::cout << ")" << std::endl;
             break;
         }
         case AsmIRNodeType::JMP_CC: {
             const auto* jmpCCNode = static_cast<const AsmIRJmpCC*>(node);
-            std::cout << indent << "JmpCC(" << jmpCCNode->cond_code << ", " << jmpCCNode->identifier << ")" << std::endl;
+            std::cout << indent << "JmpCC(" << condCodeNames[static_cast<int>(jmpCCNode->cond_code)] << ", " << jmpCCNode->identifier << ")" << std::endl;
+            break;
+        }
+        case AsmIRNodeType::JMP: {
+            const auto* jmpNode = static_cast<const AsmIRJmp*>(node);
+            std::cout << indent << "Jmp(" << jmpNode->identifier << ")" << std::endl;
             break;
         }
         case AsmIRNodeType::LABEL: {
@@ -711,36 +608,16 @@ void printIR(const AsmIRNode* node, int space = 0) {
             std::cout << indent << "Label(" << labelNode->identifier << ")" << std::endl;
             break;
         }
+        case AsmIRNodeType::COUNT_EDGE: {
+            const auto* countNode = static_cast<const AsmIRCountEdge*>(node);
+            std::cout << indent << "CountEdge(" << countNode->counter << ")" << std::endl;
+            break;
+        }
         case AsmIRNodeType::ALLOCATE_STACK: {
             const auto* allocateStackNode = static_cast<const AsmIRAllocateStack*>(node);
             std::cout << indent << "AllocateStack(" << std::to_string(allocateStackNode->stack_size) << ")" << std::endl;
             break;
         }
-        case AsmIRNodeType::STACK: {
-            const auto* stackNode = static_cast<const AsmIRStack*>(node);
-            std::cout << "Stack(" << std::to_string(stackNode->stack_size) << ")";
-            break;
-        }
-        case AsmIRNodeType::NOT: {
-            std::cout << "Not()";
-            break;
-        }
-        case AsmIRNodeType::NEG: {
-            std::cout << "Neg()";
-            break;
-        }
-        case AsmIRNodeType::ADD: {
-            std::cout << "Add()";
-            break;
-        }
-        case AsmIRNodeType::SUBTRACT: {
-            std::cout << "Subtract()";
-            break;
-        }
-        case AsmIRNodeType::MULTIPLY: {
-            std::cout << "Multiply()";
-            break;
-        }
         default:
             std::cout << indent << "UnknownNode(type=" << static_cast<int>(node->type) << std::endl;
             break;
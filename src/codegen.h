@@ -5,6 +5,16 @@
 #include <unordered_map>
 
 std::unique_ptr<AsmIRNode> generateCode(const TackyIRNode* node);
+// Lowers one TACKY node; instructions are appended to `instructions`
+std::unique_ptr<AsmIRNode> buildAsmIRAst(const TackyIRNode* node, AsmIRInstructions* instructions);
+// A TACKY constant or variable as an AsmIR immediate or pseudo
+AsmIROperand buildAsmIROperand(const TackyIRNode* node);
+// Lowers a comparison or logical not and the conditional jump on its result as one cmp + jcc;
+// returns false without emitting anything when condition is neither
+bool selectCompareAndBranch(const TackyIRNode* condition, const TackyIRNode* jump, AsmIRInstructions* instructions);
+// Puts the pseudos left after register allocation in their stack slots and fixes up
+// operand combinations x86 can't encode
+void passLegalize(AsmIRNode* node, const std::unordered_map<int64_t, int>& pseudoToOffset, int nextOffset);
 void printIR(const AsmIRNode* node, int space);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,673 @@
+#include "egraph.h"
+#include "generate_tacky.h"
+#include "tacky_eval.h"
+#include "target.h"
+#include <algorithm>
+#include <climits>
+#include <unordered_map>
+
+/*
+    Every value computed in a block is an e-class, a set of e-nodes known to be equal. The
+    rules below only ever add e-nodes and merge classes, so unlike a peephole pass nothing
+    a rule does can hide a rewrite another rule would have found: they run round after
+    round until nothing new appears (saturation) or the graph outgrows egraphNodeBudget.
+    The extracted program then takes the cheapest e-node of each class it needs.
+
+    + - * and the unary operators wrap like the x86 instructions, so the algebra is the
+    ring of integers mod 2^32 and all the usual identities hold. Rules never create a
+    division, so no trap is introduced that the block didn't already have.
+*/
+const size_t egraphNodeBudget = 2000;
+const int egraphRounds = 8;
+
+// --- E-Graph ---
+struct ENode {
+    TackyIRNodeType op; // CONSTANT, VAR (a value from outside the graph) or an operator
+    int32_t value = 0;
+    std::string name;
+    std::vector<int> kids;
+};
+
+struct EGraph {
+    std::vector<int> parent;               // union-find over class ids
+    std::vector<std::vector<ENode>> nodes; // e-nodes of each class, only kept on the root
+    std::vector<bool> boolean;             // the class is always 0 or 1, as of the last rebuild
+    std::unordered_map<std::string, int> memo;
+    size_t nodeCount = 0;
+
+    int find(int id) {
+        while (parent[id] != id) id = parent[id] = parent[parent[id]];
+        return id;
+    }
+
+    std::string key(const ENode& node) {
+        std::string k = std::to_string(static_cast<int>(node.op));
+        if (node.op == TackyIRNodeType::CONSTANT) k += "|" + std::to_string(node.value);
+        if (node.op == TackyIRNodeType::VAR) k += "|" + node.name;
+        for (int kid : node.kids) k += "|" + std::to_string(find(kid));
+        return k;
+    }
+
+    int add(ENode node) {
+        for (int& kid : node.kids) kid = find(kid);
+        std::string k = key(node);
+        auto it = memo.find(k);
+        if (it != memo.end()) return find(it->second);
+        int id = static_cast<int>(parent.size());
+        parent.push_back(id);
+        nodes.push_back({std::move(node)});
+        boolean.push_back(false);
+        memo[k] = id;
+        nodeCount++;
+        return id;
+    }
+
+    bool merge(int a, int b) {
+        a = find(a);
+        b = find(b);
+        if (a == b) return false;
+        if (nodes[a].size() < nodes[b].size()) std::swap(a, b);
+        parent[b] = a;
+        for (auto& node : nodes[b]) nodes[a].push_back(std::move(node));
+        nodes[b].clear();
+        return true;
+    }
+
+    // Merging two classes can make e-nodes above them identical (congruence), which
+    // merges their classes in turn
+    void rebuild() {
+        bool changed = true;
+        while (changed) {
+            memo.clear();
+            nodeCount = 0;
+            std::vector<std::pair<int, int>> congruent;
+            for (int c = 0; c < static_cast<int>(parent.size()); ++c) {
+                if (find(c) != c) continue;
+                std::vector<ENode> unique;
+                for (auto& node : nodes[c]) {
+                    for (int& kid : node.kids) kid = find(kid);
+                    std::string k = key(node);
+                    auto it = memo.find(k);
+                    if (it == memo.end()) {
+                        memo[k] = c;
+                        unique.push_back(std::move(node));
+                    } else if (find(it->second) != c) {
+                        congruent.push_back({it->second, c});
+                    }
+                }
+                nodes[c] = std::move(unique);
+                nodeCount += nodes[c].size();
+            }
+            changed = false;
+            for (auto [a, b] : congruent) changed = merge(a, b) || changed;
+        }
+        computeBoolean();
+    }
+
+    bool constantOf(int c, int32_t& value) {
+        for (const auto& node : nodes[find(c)]) {
+            if (node.op != TackyIRNodeType::CONSTANT) continue;
+            value = node.value;
+            return true;
+        }
+        return false;
+    }
+
+    bool isBoolean(int c) { return boolean[find(c)]; }
+
+    void computeBoolean() {
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (int c = 0; c < static_cast<int>(parent.size()); ++c) {
+                if (find(c) != c || boolean[c]) continue;
+                for (const auto& node : nodes[c]) {
+                    bool result = false;
+                    switch (node.op) {
+                        case TackyIRNodeType::CONSTANT: result = node.value == 0 || node.value == 1; break;
+                        case TackyIRNodeType::NOT: result = true; break;
+                        case TackyIRNodeType::BITWISE_AND: result = isBoolean(node.kids[0]) || isBoolean(node.kids[1]); break;
+                        case TackyIRNodeType::BITWISE_OR: result = isBoolean(node.kids[0]) && isBoolean(node.kids[1]); break;
+                        default: result = isTackyComparison(node.op); break;
+                    }
+                    if (result) {
+                        boolean[c] = true;
+                        changed = true;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+};
+
+// --- Rewrite Rules ---
+static TackyIRNodeType invertedComparison(TackyIRNodeType op) {
+    switch (op) {
+        case TackyIRNodeType::EQUAL: return TackyIRNodeType::NOT_EQUAL;
+        case TackyIRNodeType::NOT_EQUAL: return TackyIRNodeType::EQUAL;
+        case TackyIRNodeType::LESS_THAN: return TackyIRNodeType::GREATER_OR_EQUAL;
+        case TackyIRNodeType::LESS_OR_EQUAL: return TackyIRNodeType::GREATER_THAN;
+        case TackyIRNodeType::GREATER_THAN: return TackyIRNodeType::LESS_OR_EQUAL;
+        default: return TackyIRNodeType::LESS_THAN;
+    }
+}
+
+// a op b == b swapped(op) a
+static TackyIRNodeType swappedComparison(TackyIRNodeType op) {
+    switch (op) {
+        case TackyIRNodeType::LESS_THAN: return TackyIRNodeType::GREATER_THAN;
+        case TackyIRNodeType::LESS_OR_EQUAL: return TackyIRNodeType::GREATER_OR_EQUAL;
+        case TackyIRNodeType::GREATER_THAN: return TackyIRNodeType::LESS_THAN;
+        case TackyIRNodeType::GREATER_OR_EQUAL: return TackyIRNodeType::LESS_OR_EQUAL;
+        default: return op;
+    }
+}
+
+struct Rewriter {
+    EGraph& g;
+
+    int constant(int32_t value) { return g.add({TackyIRNodeType::CONSTANT, value, "", {}}); }
+    int unary(TackyIRNodeType op, int a) { return g.add({op, 0, "", {a}}); }
+    int binary(TackyIRNodeType op, int a, int b) { return g.add({op, 0, "", {a, b}}); }
+    bool isConstant(int c, int32_t& value) { return g.constantOf(c, value); }
+    bool is(int c, int32_t value) {
+        int32_t actual;
+        return g.constantOf(c, actual) && actual == value;
+    }
+    bool same(int a, int b) { return g.find(a) == g.find(b); }
+    // checked inside the rules that pair up e-nodes, which can square a class in one go
+    bool full() { return g.nodeCount >= egraphNodeBudget; }
+    // copies, since adding e-nodes may reallocate the class
+    std::vector<ENode> nodesOf(int c, TackyIRNodeType op) {
+        std::vector<ENode> matching;
+        for (const auto& node : g.nodes[g.find(c)]) {
+            if (node.op == op) matching.push_back(node);
+        }
+        return matching;
+    }
+    std::vector<ENode> comparisonsOf(int c) {
+        std::vector<ENode> matching;
+        for (const auto& node : g.nodes[g.find(c)]) {
+            if (isTackyComparison(node.op)) matching.push_back(node);
+        }
+        return matching;
+    }
+    static uint32_t wrap(int32_t value) { return static_cast<uint32_t>(value); }
+    static int32_t wrapped(uint32_t value) { return static_cast<int32_t>(value); }
+
+    void fold(int c, const ENode& node) {
+        std::vector<int32_t> values;
+        for (int kid : node.kids) {
+            int32_t value;
+            if (!isConstant(kid, value)) return;
+            values.push_back(value);
+        }
+        int32_t result;
+        bool ok = values.size() == 1 ? evalTackyUnary(node.op, values[0], result)
+                                     : evalTackyBinary(node.op, values[0], values[1], result);
+        if (ok) g.merge(c, constant(result));
+    }
+
+    void associate(int c, TackyIRNodeType op, int a, int b) {
+        if (isTackyCommutative(op)) g.merge(c, binary(op, b, a));
+        for (const auto& inner : nodesOf(a, op)) {
+            if (full()) return;
+            g.merge(c, binary(op, inner.kids[0], binary(op, inner.kids[1], b)));
+        }
+    }
+
+    void rewriteAdd(int c, int a, int b) {
+        associate(c, TackyIRNodeType::ADD, a, b);
+        if (is(a, 0)) g.merge(c, b);
+        if (same(a, b)) g.merge(c, binary(TackyIRNodeType::MULTIPLY, a, constant(2)));
+        for (const auto& negated : nodesOf(b, TackyIRNodeType::NEGATE)) g.merge(c, binary(TackyIRNodeType::SUBTRACT, a, negated.kids[0]));
+        // a*x + a*y = a*(x + y), and a*k + a = a*(k + 1)
+        for (const auto& left : nodesOf(a, TackyIRNodeType::MULTIPLY)) {
+            for (const auto& right : nodesOf(b, TackyIRNodeType::MULTIPLY)) {
+                if (full()) return;
+                if (same(left.kids[0], right.kids[0]))
+                    g.merge(c, binary(TackyIRNodeType::MULTIPLY, left.kids[0], binary(TackyIRNodeType::ADD, left.kids[1], right.kids[1])));
+            }
+            int32_t k;
+            if (same(left.kids[0], b) && isConstant(left.kids[1], k))
+                g.merge(c, binary(TackyIRNodeType::MULTIPLY, b, constant(wrapped(wrap(k) + 1))));
+        }
+    }
+
+    void rewriteSubtract(int c, int a, int b) {
+        g.merge(c, binary(TackyIRNodeType::ADD, a, unary(TackyIRNodeType::NEGATE, b)));
+        if (same(a, b)) g.merge(c, constant(0));
+        int32_t k;
+        if (isConstant(b, k)) g.merge(c, binary(TackyIRNodeType::ADD, a, constant(wrapped(0u - wrap(k)))));
+        if (is(a, 0)) g.merge(c, unary(TackyIRNodeType::NEGATE, b));
+    }
+
+    void rewriteMultiply(int c, int a, int b) {
+        associate(c, TackyIRNodeType::MULTIPLY, a, b);
+        int32_t k;
+        if (!isConstant(b, k)) return;
+        if (k == 0) g.merge(c, constant(0));
+        if (k == 1) g.merge(c, a);
+        if (k == -1) g.merge(c, unary(TackyIRNodeType::NEGATE, a));
+        for (const auto& negated : nodesOf(a, TackyIRNodeType::NEGATE))
+            g.merge(c, binary(TackyIRNodeType::MULTIPLY, negated.kids[0], constant(wrapped(0u - wrap(k)))));
+        // (x + j) * k = x*k + j*k
+        for (const auto& sum : nodesOf(a, TackyIRNodeType::ADD)) {
+            int32_t j;
+            if (isConstant(sum.kids[1], j))
+                g.merge(c, binary(TackyIRNodeType::ADD, binary(TackyIRNodeType::MULTIPLY, sum.kids[0], b), constant(wrapped(wrap(j) * wrap(k)))));
+        }
+    }
+
+    void rewriteNegate(int c, int a) {
+        for (const auto& negated : nodesOf(a, TackyIRNodeType::NEGATE)) g.merge(c, negated.kids[0]);
+        for (const auto& difference : nodesOf(a, TackyIRNodeType::SUBTRACT))
+            g.merge(c, binary(TackyIRNodeType::SUBTRACT, difference.kids[1], difference.kids[0]));
+        for (const auto& product : nodesOf(a, TackyIRNodeType::MULTIPLY)) {
+            int32_t k;
+            if (isConstant(product.kids[1], k)) g.merge(c, binary(TackyIRNodeType::MULTIPLY, product.kids[0], constant(wrapped(0u - wrap(k)))));
+        }
+        // -x = ~x + 1
+        g.merge(c, binary(TackyIRNodeType::ADD, unary(TackyIRNodeType::COMPLEMENT, a), constant(1)));
+    }
+
+    void rewriteComplement(int c, int a) {
+        for (const auto& complemented : nodesOf(a, TackyIRNodeType::COMPLEMENT)) g.merge(c, complemented.kids[0]);
+        // ~x = -x - 1, so ~(-y) = y - 1
+        for (const auto& negated : nodesOf(a, TackyIRNodeType::NEGATE)) g.merge(c, binary(TackyIRNodeType::ADD, negated.kids[0], constant(-1)));
+        g.merge(c, binary(TackyIRNodeType::ADD, unary(TackyIRNodeType::NEGATE, a), constant(-1)));
+    }
+
+    void rewriteNot(int c, int a) {
+        g.merge(c, binary(TackyIRNodeType::EQUAL, a, constant(0)));
+        for (const auto& inner : nodesOf(a, TackyIRNodeType::NOT)) {
+            if (g.isBoolean(inner.kids[0])) g.merge(c, inner.kids[0]);
+            else g.merge(c, binary(TackyIRNodeType::NOT_EQUAL, inner.kids[0], constant(0)));
+        }
+        for (const auto& comparison : comparisonsOf(a))
+            g.merge(c, binary(invertedComparison(comparison.op), comparison.kids[0], comparison.kids[1]));
+        // !(x | y) = !x & !y
+        for (const auto& either : nodesOf(a, TackyIRNodeType::BITWISE_OR))
+            g.merge(c, binary(TackyIRNodeType::BITWISE_AND, unary(TackyIRNodeType::NOT, either.kids[0]), unary(TackyIRNodeType::NOT, either.kids[1])));
+    }
+
+    void rewriteEquality(int c, TackyIRNodeType op, int a, int b) {
+        bool equal = op == TackyIRNodeType::EQUAL;
+        g.merge(c, binary(op, b, a));
+        if (same(a, b)) g.merge(c, constant(equal ? 1 : 0));
+
+        int32_t k;
+        if (isConstant(b, k)) {
+            if (k == 0 && equal) g.merge(c, unary(TackyIRNodeType::NOT, a));
+            if (g.isBoolean(a) && ((k == 0 && !equal) || (k == 1 && equal))) g.merge(c, a);
+            if (g.isBoolean(a) && k == 1 && !equal) g.merge(c, unary(TackyIRNodeType::NOT, a));
+            // adding a constant, negating and complementing are bijections
+            for (const auto& sum : nodesOf(a, TackyIRNodeType::ADD)) {
+                int32_t j;
+                if (isConstant(sum.kids[1], j)) g.merge(c, binary(op, sum.kids[0], constant(wrapped(wrap(k) - wrap(j)))));
+            }
+            for (const auto& negated : nodesOf(a, TackyIRNodeType::NEGATE)) g.merge(c, binary(op, negated.kids[0], constant(wrapped(0u - wrap(k)))));
+            for (const auto& complemented : nodesOf(a, TackyIRNodeType::COMPLEMENT)) g.merge(c, binary(op, complemented.kids[0], constant(~k)));
+            // x - y == 0 exactly when x == y
+            if (k == 0) {
+                for (const auto& difference : nodesOf(a, TackyIRNodeType::SUBTRACT)) g.merge(c, binary(op, difference.kids[0], difference.kids[1]));
+            }
+        }
+        for (const auto& left : nodesOf(a, TackyIRNodeType::NEGATE)) {
+            for (const auto& right : nodesOf(b, TackyIRNodeType::NEGATE)) {
+                if (full()) return;
+                g.merge(c, binary(op, left.kids[0], right.kids[0]));
+            }
+        }
+    }
+
+    void rewriteOrdering(int c, TackyIRNodeType op, int a, int b) {
+        g.merge(c, binary(swappedComparison(op), b, a));
+        bool strict = op == TackyIRNodeType::LESS_THAN || op == TackyIRNodeType::GREATER_THAN;
+        if (same(a, b)) g.merge(c, constant(strict ? 0 : 1));
+
+        // ~ reverses the order: ~x < ~y exactly when x > y
+        for (const auto& left : nodesOf(a, TackyIRNodeType::COMPLEMENT)) {
+            for (const auto& right : nodesOf(b, TackyIRNodeType::COMPLEMENT)) {
+                if (full()) return;
+                g.merge(c, binary(swappedComparison(op), left.kids[0], right.kids[0]));
+            }
+        }
+
+        int32_t k;
+        if (!isConstant(b, k)) return;
+        if (op == TackyIRNodeType::LESS_THAN && k == INT32_MIN) g.merge(c, constant(0));
+        if (op == TackyIRNodeType::GREATER_OR_EQUAL && k == INT32_MIN) g.merge(c, constant(1));
+        if (op == TackyIRNodeType::GREATER_THAN && k == INT32_MAX) g.merge(c, constant(0));
+        if (op == TackyIRNodeType::LESS_OR_EQUAL && k == INT32_MAX) g.merge(c, constant(1));
+        // x < k is x <= k - 1 and x > k is x >= k + 1, away from the ends of the range
+        if (op == TackyIRNodeType::LESS_THAN && k != INT32_MIN) g.merge(c, binary(TackyIRNodeType::LESS_OR_EQUAL, a, constant(k - 1)));
+        if (op == TackyIRNodeType::LESS_OR_EQUAL && k != INT32_MAX) g.merge(c, binary(TackyIRNodeType::LESS_THAN, a, constant(k + 1)));
+        if (op == TackyIRNodeType::GREATER_THAN && k != INT32_MAX) g.merge(c, binary(TackyIRNodeType::GREATER_OR_EQUAL, a, constant(k + 1)));
+        if (op == TackyIRNodeType::GREATER_OR_EQUAL && k != INT32_MIN) g.merge(c, binary(TackyIRNodeType::GREATER_THAN, a, constant(k - 1)));
+    }
+
+    void rewriteBitwise(int c, TackyIRNodeType op, int a, int b) {
+        bool isAnd = op == TackyIRNodeType::BITWISE_AND;
+        TackyIRNodeType other = isAnd ? TackyIRNodeType::BITWISE_OR : TackyIRNodeType::BITWISE_AND;
+        associate(c, op, a, b);
+        if (same(a, b)) g.merge(c, a);
+        if (is(b, 0)) g.merge(c, isAnd ? b : a);
+        if (is(b, -1)) g.merge(c, isAnd ? a : b);
+        if (isAnd && is(b, 1) && g.isBoolean(a)) g.merge(c, a);
+        // absorption: x & (x | y) = x and x | (x & y) = x
+        for (const auto& inner : nodesOf(a, other)) {
+            if (same(inner.kids[0], b) || same(inner.kids[1], b)) g.merge(c, b);
+        }
+        // !x & !y = !(x | y) always; !x | !y = !(x & y) when both are 0 or 1
+        for (const auto& left : nodesOf(a, TackyIRNodeType::NOT)) {
+            for (const auto& right : nodesOf(b, TackyIRNodeType::NOT)) {
+                if (full()) return;
+                if (isAnd || (g.isBoolean(left.kids[0]) && g.isBoolean(right.kids[0])))
+                    g.merge(c, unary(TackyIRNodeType::NOT, binary(other, left.kids[0], right.kids[0])));
+            }
+        }
+    }
+
+    void rewriteDivision(int c, TackyIRNodeType op, int a, int b) {
+        int32_t k;
+        if (!isConstant(b, k) || (k != 1 && k != -1)) return;
+        if (op == TackyIRNodeType::REMAINDER) g.merge(c, constant(0));
+        else g.merge(c, k == 1 ? a : unary(TackyIRNodeType::NEGATE, a));
+    }
+
+    void rewriteShift(int c, int a, int b) {
+        int32_t k;
+        if ((isConstant(b, k) && (k & 31) == 0) || is(a, 0) || is(a, -1)) g.merge(c, a);
+    }
+
+    void rewrite(int c, const ENode& node) {
+        if (!node.kids.empty()) fold(c, node);
+        if (node.kids.size() == 1) {
+            int a = node.kids[0];
+            switch (node.op) {
+                case TackyIRNodeType::NEGATE: rewriteNegate(c, a); break;
+                case TackyIRNodeType::COMPLEMENT: rewriteComplement(c, a); break;
+                case TackyIRNodeType::NOT: rewriteNot(c, a); break;
+                default: break;
+            }
+            return;
+        }
+        if (node.kids.size() != 2) return;
+        int a = node.kids[0], b = node.kids[1];
+        switch (node.op) {
+            case TackyIRNodeType::ADD: rewriteAdd(c, a, b); break;
+            case TackyIRNodeType::SUBTRACT: rewriteSubtract(c, a, b); break;
+            case TackyIRNodeType::MULTIPLY: rewriteMultiply(c, a, b); break;
+            case TackyIRNodeType::DIVIDE:
+            case TackyIRNodeType::REMAINDER:
+                rewriteDivision(c, node.op, a, b);
+                break;
+            case TackyIRNodeType::EQUAL:
+            case TackyIRNodeType::NOT_EQUAL:
+                rewriteEquality(c, node.op, a, b);
+                break;
+            case TackyIRNodeType::LESS_THAN:
+            case TackyIRNodeType::LESS_OR_EQUAL:
+            case TackyIRNodeType::GREATER_THAN:
+            case TackyIRNodeType::GREATER_OR_EQUAL:
+                rewriteOrdering(c, node.op, a, b);
+                break;
+            case TackyIRNodeType::BITWISE_AND:
+            case TackyIRNodeType::BITWISE_OR:
+                rewriteBitwise(c, node.op, a, b);
+                break;
+            case TackyIRNodeType::SHIFT_RIGHT: rewriteShift(c, a, b); break;
+            default: break;
+        }
+    }
+};
+
+static void saturate(EGraph& g) {
+    Rewriter rewriter{g};
+    for (int round = 0; round < egraphRounds && g.nodeCount < egraphNodeBudget; ++round) {
+        std::vector<std::pair<int, ENode>> matches;
+        for (int c = 0; c < static_cast<int>(g.parent.size()); ++c) {
+            if (g.find(c) != c) continue;
+            for (const auto& node : g.nodes[c]) matches.push_back({c, node});
+        }
+        size_t before = g.nodeCount;
+        size_t classesBefore = g.parent.size();
+        for (const auto& [c, node] : matches) {
+            if (g.nodeCount >= egraphNodeBudget) break;
+            rewriter.rewrite(g.find(c), node);
+        }
+        g.rebuild();
+        // saturated: no rule added an e-node or merged two classes
+        size_t roots = 0;
+        for (int c = 0; c < static_cast<int>(g.parent.size()); ++c) roots += g.find(c) == c;
+        if (g.nodeCount == before && g.parent.size() == classesBefore && roots == classesBefore) break;
+    }
+}
+
+// --- Costs ---
+// Latency of the code instruction selection is expected to produce for an e-node
+static int nodeCost(EGraph& g, const ENode& node) {
+    auto latency = [](InstrClass instrClass) { return targetLatency(instrClass); };
+    int32_t k;
+    switch (node.op) {
+        case TackyIRNodeType::CONSTANT:
+        case TackyIRNodeType::VAR:
+            return 0;
+        case TackyIRNodeType::SHIFT_RIGHT:
+            return latency(InstrClass::SHIFT);
+        case TackyIRNodeType::NOT:
+            return latency(InstrClass::COMPARE) + latency(InstrClass::SET_CC) + latency(InstrClass::MOVE);
+        case TackyIRNodeType::MULTIPLY: {
+            if (!g.constantOf(node.kids[1], k) && !g.constantOf(node.kids[0], k)) return latency(InstrClass::MULTIPLY);
+            uint32_t magnitude = k < 0 ? 0u - static_cast<uint32_t>(k) : static_cast<uint32_t>(k);
+            int sign = k < 0 ? latency(InstrClass::ALU) : 0;
+            if (magnitude != 0 && (magnitude & (magnitude - 1)) == 0) return latency(InstrClass::SHIFT) + sign;
+            for (uint32_t f : {3u, 5u, 9u}) {
+                uint32_t rest = magnitude / f;
+                if (magnitude % f == 0 && (rest & (rest - 1)) == 0)
+                    return std::min(latency(InstrClass::MULTIPLY), latency(InstrClass::LEA_SCALED) + (rest > 1 ? latency(InstrClass::SHIFT) : 0) + sign);
+            }
+            return latency(InstrClass::MULTIPLY);
+        }
+        case TackyIRNodeType::DIVIDE:
+        case TackyIRNodeType::REMAINDER: {
+            int remainder = node.op == TackyIRNodeType::REMAINDER ? latency(InstrClass::MULTIPLY) + latency(InstrClass::ALU) : 0;
+            if (!g.constantOf(node.kids[1], k)) return latency(InstrClass::ALU) + latency(InstrClass::DIVIDE);
+            uint32_t magnitude = k < 0 ? 0u - static_cast<uint32_t>(k) : static_cast<uint32_t>(k);
+            if (magnitude != 0 && (magnitude & (magnitude - 1)) == 0) return 3 * latency(InstrClass::SHIFT) + latency(InstrClass::ALU) + remainder;
+            return latency(InstrClass::MULTIPLY_WIDE) + 2 * latency(InstrClass::SHIFT) + 2 * latency(InstrClass::ALU) + remainder;
+        }
+        default:
+            if (isTackyComparison(node.op))
+                return latency(InstrClass::COMPARE) + latency(InstrClass::SET_CC) + latency(InstrClass::MOVE);
+            return latency(InstrClass::ALU);
+    }
+}
+
+// --- Extraction ---
+constexpr int UNEXTRACTED = INT_MAX / 4;
+
+// Cheapest e-node of every class, counting each subtree as if nothing were shared and
+// capping the total, since a deep DAG counted as a tree overflows quickly. Every operator
+// costs at least a cycle, so a class never picks an e-node that leads back to it.
+static std::vector<int> cheapestNodes(EGraph& g, std::vector<int>& cost) {
+    cost.assign(g.parent.size(), UNEXTRACTED);
+    std::vector<int> best(g.parent.size(), -1);
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int c = 0; c < static_cast<int>(g.parent.size()); ++c) {
+            if (g.find(c) != c) continue;
+            for (size_t i = 0; i < g.nodes[c].size(); ++i) {
+                const ENode& node = g.nodes[c][i];
+                int total = nodeCost(g, node);
+                bool ready = true;
+                for (int kid : node.kids) {
+                    ready = ready && cost[g.find(kid)] < UNEXTRACTED;
+                    total = std::min(total + cost[g.find(kid)], UNEXTRACTED - 1);
+                }
+                if (!ready || total >= cost[c]) continue;
+                cost[c] = total;
+                best[c] = static_cast<int>(i);
+                changed = true;
+            }
+        }
+    }
+    return best;
+}
+
+static std::unique_ptr<TackyIRNode> operatorNode(TackyIRNodeType op) {
+    switch (op) {
+        case TackyIRNodeType::COMPLEMENT: return std::make_unique<TackyIRComplement>();
+        case TackyIRNodeType::NEGATE: return std::make_unique<TackyIRNegate>();
+        case TackyIRNodeType::NOT: return std::make_unique<TackyIRNot>();
+        case TackyIRNodeType::ADD: return std::make_unique<TackyIRAdd>();
+        case TackyIRNodeType::SUBTRACT: return std::make_unique<TackyIRSubtract>();
+        case TackyIRNodeType::MULTIPLY: return std::make_unique<TackyIRMultiply>();
+        case TackyIRNodeType::DIVIDE: return std::make_unique<TackyIRDivide>();
+        case TackyIRNodeType::REMAINDER: return std::make_unique<TackyIRRemainder>();
+        case TackyIRNodeType::EQUAL: return std::make_unique<TackyIREqual>();
+        case TackyIRNodeType::NOT_EQUAL: return std::make_unique<TackyIRNotEqual>();
+        case TackyIRNodeType::LESS_THAN: return std::make_unique<TackyIRLessThan>();
+        case TackyIRNodeType::LESS_OR_EQUAL: return std::make_unique<TackyIRLessOrEqual>();
+        case TackyIRNodeType::GREATER_THAN: return std::make_unique<TackyIRGreaterThan>();
+        case TackyIRNodeType::GREATER_OR_EQUAL: return std::make_unique<TackyIRGreaterOrEqual>();
+        case TackyIRNodeType::SHIFT_RIGHT: return std::make_unique<TackyIRShiftRight>();
+        case TackyIRNodeType::BITWISE_AND: return std::make_unique<TackyIRBitwiseAnd>();
+        default: return std::make_unique<TackyIRBitwiseOr>();
+    }
+}
+
+struct Extractor {
+    EGraph& g;
+    std::vector<int> best;
+    std::vector<int> cost;
+    std::unordered_map<int, std::string> materialized; // class -> name already holding it
+    std::vector<std::unique_ptr<TackyIRNode>> out;
+    int emittedCost = 0;
+
+    explicit Extractor(EGraph& g) : g(g) { best = cheapestNodes(g, cost); }
+
+    // Emits whatever class c still needs and returns the operand holding it. The top
+    // instruction writes dst when one is given.
+    std::unique_ptr<TackyIRNode> extract(int c, const std::string& dst = "") {
+        c = g.find(c);
+        auto it = materialized.find(c);
+        if (it != materialized.end()) return std::make_unique<TackyIRVar>(it->second);
+        int32_t value;
+        if (g.constantOf(c, value)) return std::make_unique<TackyIRConstant>(tackyConstantString(value));
+
+        const ENode node = g.nodes[c][static_cast<size_t>(best[c])];
+        if (node.op == TackyIRNodeType::VAR) return std::make_unique<TackyIRVar>(node.name);
+
+        std::vector<std::unique_ptr<TackyIRNode>> kids;
+        for (int kid : node.kids) kids.push_back(extract(kid));
+        std::string name = dst.empty() ? makeTemporary() : dst;
+        if (kids.size() == 1) {
+            out.push_back(std::make_unique<TackyIRUnary>(operatorNode(node.op), std::move(kids[0]), std::make_unique<TackyIRVar>(name)));
+        } else {
+            out.push_back(std::make_unique<TackyIRBinary>(operatorNode(node.op), std::move(kids[0]), std::move(kids[1]), std::make_unique<TackyIRVar>(name)));
+        }
+        emittedCost += nodeCost(g, node);
+        materialized[c] = name;
+        return std::make_unique<TackyIRVar>(name);
+    }
+
+    void define(int c, const std::string& name) {
+        auto operand = extract(c, name);
+        const std::string* result = tackyVarName(operand.get());
+        if (!result || *result != name) out.push_back(std::make_unique<TackyIRCopy>(std::move(operand), std::make_unique<TackyIRVar>(name)));
+    }
+};
+
+// --- Pass ---
+static bool inGraph(const TackyIRNode* instr) {
+    return instr->type == TackyIRNodeType::UNARY || instr->type == TackyIRNodeType::BINARY || instr->type == TackyIRNodeType::COPY;
+}
+
+static void saturateBlock(TackyBasicBlock& block, const std::unordered_map<std::string, int>& useCount) {
+    auto& instrs = block.instructions;
+    EGraph g;
+    std::unordered_map<std::string, int> classOf;
+    std::unordered_map<std::string, int> usesInGraph;
+    std::vector<std::string> defined;
+    int originalCost = 0;
+
+    auto operandClass = [&](const TackyIRNode* operand) {
+        int32_t value;
+        if (parseTackyConstant(operand, value)) return g.add({TackyIRNodeType::CONSTANT, value, "", {}});
+        const std::string& name = *tackyVarName(operand);
+        usesInGraph[name]++;
+        auto it = classOf.find(name);
+        if (it != classOf.end()) return it->second;
+        return g.add({TackyIRNodeType::VAR, 0, name, {}});
+    };
+
+    for (const auto& instr : instrs) {
+        if (!inGraph(instr.get())) continue;
+        int c;
+        std::string dst;
+        if (instr->type == TackyIRNodeType::COPY) {
+            const auto* copy = static_cast<const TackyIRCopy*>(instr.get());
+            c = operandClass(copy->src.get());
+            dst = *tackyVarName(copy->dst.get());
+        } else if (instr->type == TackyIRNodeType::UNARY) {
+            const auto* unary = static_cast<const TackyIRUnary*>(instr.get());
+            ENode node{unary->op->type, 0, "", {operandClass(unary->src.get())}};
+            originalCost += nodeCost(g, node);
+            c = g.add(node);
+            dst = *tackyVarName(unary->dst.get());
+        } else {
+            const auto* binary = static_cast<const TackyIRBinary*>(instr.get());
+            int lhs = operandClass(binary->src1.get());
+            ENode node{binary->op->type, 0, "", {lhs, operandClass(binary->src2.get())}};
+            originalCost += nodeCost(g, node);
+            c = g.add(node);
+            dst = *tackyVarName(binary->dst.get());
+        }
+        classOf[dst] = c;
+        defined.push_back(dst);
+    }
+    if (defined.empty()) return;
+
+    g.rebuild();
+    saturate(g);
+
+    // values read by the jumps and returns here or by other blocks
+    auto needed = [&](const std::string& name) {
+        auto total = useCount.find(name);
+        return total != useCount.end() && total->second > usesInGraph[name];
+    };
+
+    Extractor extractor(g);
+    for (const auto& name : defined) {
+        if (needed(name)) extractor.define(classOf[name], name);
+    }
+    if (extractor.emittedCost >= originalCost) return;
+
+    std::vector<std::unique_ptr<TackyIRNode>> rewritten;
+    for (auto& instr : instrs) {
+        if (instr->type == TackyIRNodeType::PHI) rewritten.push_back(std::move(instr));
+    }
+    for (auto& instr : extractor.out) rewritten.push_back(std::move(instr));
+    for (auto& instr : instrs) {
+        if (instr && !inGraph(instr.get())) rewritten.push_back(std::move(instr));
+    }
+    instrs = std::move(rewritten);
+}
+
+void passEqualitySaturation(TackyCFG& cfg) {
+    std::unordered_map<std::string, int> useCount;
+    for (auto& block : cfg.blocks) {
+        for (auto& instr : block.instructions) {
+            for (auto* use : tackyUses(instr.get())) {
+                const std::string* name = tackyVarName(use->get());
+                if (name) useCount[*name]++;
+            }
+        }
+    }
+
+    for (auto& block : cfg.blocks) saturateBlock(block, useCount);
+}
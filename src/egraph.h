@@ -0,0 +1,12 @@
+#ifndef EGRAPH_H
+#define EGRAPH_H
+
+#include "tacky_cfg.h"
+
+// Equality saturation over the Unary/Binary/Copy instructions of each block: rewrite rules
+// grow an e-graph of equivalent expressions under a node budget, and the cheapest program
+// under the -mtune costs is extracted. A block is only replaced when that program is
+// cheaper than what it had. The CFG must be in SSA form.
+void passEqualitySaturation(TackyCFG& cfg);
+
+#endif
@@ -1,13 +1,131 @@
 #include "emitter.h"
 #include "asm_ir.h"
+#include "profile.h"
 #include <iostream>
 #include <fstream>
 
-void emit(const AsmIRNode* node, std::ofstream& outf, int registerBytes) {
+// Stack slots are offsets from the caller's %rsp and are addressed off %rsp; there is no
+// %rbp frame. frameSize is what the prologue subtracted, 0 when the slots fit in the red zone.
+int frameSize = 0;
+
+// 8-, 4- and 1-byte names, indexed by AsmIRRegister
+static const char* const registerNames[][3] = {
+    {"%rax", "%eax", "%al"},
+    {"%rcx", "%ecx", "%cl"},
+    {"%rdx", "%edx", "%dl"},
+    {"%rsi", "%esi", "%sil"},
+    {"%rdi", "%edi", "%dil"},
+    {"%r8", "%r8d", "%r8b"},
+    {"%r9", "%r9d", "%r9b"},
+    {"%r10", "%r10d", "%r10b"},
+    {"%r11", "%r11d", "%r11b"},
+};
+
+static const char* conditionSuffix(AsmIRCondCode cond_code) {
+    switch (cond_code) {
+        case AsmIRCondCode::E: return "e";
+        case AsmIRCondCode::NE: return "ne";
+        case AsmIRCondCode::L: return "l";
+        case AsmIRCondCode::LE: return "le";
+        case AsmIRCondCode::G: return "g";
+        case AsmIRCondCode::GE: return "ge";
+    }
+    std::cout << "Invalid condition code" << std::endl;
+    return "";
+}
+
+static const char* operatorMnemonic(AsmIRNodeType op) {
+    switch (op) {
+        case AsmIRNodeType::NEG: return "negl";
+        case AsmIRNodeType::NOT: return "notl";
+        case AsmIRNodeType::ADD: return "addl";
+        case AsmIRNodeType::SUBTRACT: return "subl";
+        case AsmIRNodeType::MULTIPLY: return "imull";
+        case AsmIRNodeType::SAR: return "sarl";
+        case AsmIRNodeType::SHL: return "shll";
+        case AsmIRNodeType::SHR: return "shrl";
+        case AsmIRNodeType::AND: return "andl";
+        case AsmIRNodeType::OR: return "orl";
+        case AsmIRNodeType::XOR: return "xorl";
+        default:
+            std::cout << "Invalid operator." << std::endl;
+            return "";
+    }
+}
+
+void emitOperand(const AsmIROperand& operand, std::ofstream& outf, int registerBytes) {
+    switch (operand.type) {
+        case AsmIRNodeType::REGISTER: {
+            int width = registerBytes == 8 ? 0 : registerBytes == 4 ? 1 : 2;
+            outf << registerNames[static_cast<int>(operand.reg)][width];
+            break;
+        }
+        case AsmIRNodeType::STACK:
+            outf << operand.value + frameSize << "(%rsp)";
+            break;
+        case AsmIRNodeType::IMMEDIATE:
+            outf << "$" << operand.value;
+            break;
+        default:
+            std::cout << "Invalid operand." << std::endl;
+    }
+}
+
+// --- Profile Runtime ---
+// Counters live in .bss, two per site. __antcc_profile_write runs from .fini_array after
+// main returns and prints one line per site with fprintf.
+static std::string escapeString(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+static void emitProfileRuntime(std::ofstream& outf) {
+    size_t sites = profileSites.size();
+    outf << "\t.bss\n\t.align 8\n";
+    outf << "__antcc_profile_counters:\n\t.zero " << 16 * sites << "\n";
+
+    outf << "\t.section .rodata\n";
+    outf << ".Lprofile_path:\n\t.string \"" << escapeString(profilePath) << "\"\n";
+    outf << ".Lprofile_mode:\n\t.string \"w\"\n";
+    outf << ".Lprofile_format:\n\t.string \"%s %lu %lu\\n\"\n";
+    for (size_t k = 0; k < sites; ++k)
+        outf << ".Lprofile_site" << k << ":\n\t.string \"" << escapeString(profileSites[k]) << "\"\n";
+    outf << "\t.section .data.rel.ro,\"aw\"\n\t.align 8\n.Lprofile_sites:\n";
+    for (size_t k = 0; k < sites; ++k) outf << "\t.quad .Lprofile_site" << k << "\n";
+
+    // %rbx is the site index and %r12 the FILE*, both callee-saved; the extra 8 bytes keep
+    // %rsp 16-byte aligned at the calls
+    outf << "\t.text\n";
+    outf << "__antcc_profile_write:\n";
+    outf << "\tpushq %rbx\n\tpushq %r12\n\tsubq $8, %rsp\n";
+    outf << "\tleaq .Lprofile_path(%rip), %rdi\n\tleaq .Lprofile_mode(%rip), %rsi\n";
+    outf << "\tcall fopen@PLT\n\ttestq %rax, %rax\n\tje .Lprofile_done\n";
+    outf << "\tmovq %rax, %r12\n\txorl %ebx, %ebx\n";
+    outf << ".Lprofile_loop:\n";
+    outf << "\tcmpq $" << sites << ", %rbx\n\tjae .Lprofile_close\n";
+    outf << "\tmovq %r12, %rdi\n\tleaq .Lprofile_format(%rip), %rsi\n";
+    outf << "\tleaq .Lprofile_sites(%rip), %rax\n\tmovq (%rax,%rbx,8), %rdx\n";
+    outf << "\tmovq %rbx, %rax\n\tshlq $4, %rax\n\tleaq __antcc_profile_counters(%rip), %r8\n";
+    outf << "\tmovq (%r8,%rax), %rcx\n\tmovq 8(%r8,%rax), %r8\n";
+    outf << "\txorl %eax, %eax\n\tcall fprintf@PLT\n";
+    outf << "\tincq %rbx\n\tjmp .Lprofile_loop\n";
+    outf << ".Lprofile_close:\n\tmovq %r12, %rdi\n\tcall fclose@PLT\n";
+    outf << ".Lprofile_done:\n\taddq $8, %rsp\n\tpopq %r12\n\tpopq %rbx\n\tret\n";
+
+    outf << "\t.section .fini_array,\"aw\"\n\t.align 8\n\t.quad __antcc_profile_write\n";
+}
+
+void emit(const AsmIRNode* node, std::ofstream& outf) {
     switch (node->type) {
         case AsmIRNodeType::PROGRAM: {
             const auto* programNode = static_cast<const AsmIRProgram*>(node);
-            emit(programNode->function.get(), outf, 4);
+            emit(programNode->function.get(), outf);
+            // with no conditional jumps there is nothing to count, so no counters and no profile
+            if (profileMode == ProfileMode::GENERATE && !profileSites.empty()) emitProfileRuntime(outf);
             outf << ".section .note.GNU-stack,\"\",@progbits";
             break;
         }
@@ -15,10 +133,12 @@ void emit(const AsmIRNode* node, std::ofstream& outf, int registerBytes) {
             const auto* functionNode = static_cast<const AsmIRFunction*>(node);
             outf << "\t.global " << functionNode->name << "\n";
             outf << functionNode->name << ":\n";
-            outf << "\tpushq %rbp\n";
-            outf << "\tmovq %rsp, %rbp\n";
+            frameSize = 0;
             for (const auto& instr : functionNode->instructions->instructions) {
-                emit(instr.get(), outf, 4);
+                if (instr->type == AsmIRNodeType::ALLOCATE_STACK) frameSize = static_cast<const AsmIRAllocateStack*>(instr.get())->stack_size;
+            }
+            for (const auto& instr : functionNode->instructions->instructions) {
+                emit(instr.get(), outf);
             }
 
             break;
@@ -26,29 +146,25 @@ void emit(const AsmIRNode* node, std::ofstream& outf, int registerBytes) {
         case AsmIRNodeType::MOV: {
             const auto* moveNode = static_cast<const AsmIRMov*>(node);
             outf << "\tmovl ";
-            emit(moveNode->src.get(), outf, 4);
+            emitOperand(moveNode->src, outf, 4);
             outf << ", ";
-            emit(moveNode->dst.get(), outf, 4);
+            emitOperand(moveNode->dst, outf, 4);
             outf << "\n";
             break;
         }
         case AsmIRNodeType::UNARY: {
             const auto* unaryNode = static_cast<const AsmIRUnary*>(node);
-            outf << "\t";
-            emit(unaryNode->unary_operator.get(), outf, 4);
-            outf << " ";
-            emit(unaryNode->operand.get(), outf, 4);
+            outf << "\t" << operatorMnemonic(unaryNode->unary_operator) << " ";
+            emitOperand(unaryNode->operand, outf, 4);
             outf << "\n";
             break;
         }
         case AsmIRNodeType::BINARY: {
             const auto* binaryNode = static_cast<const AsmIRBinary*>(node);
-            outf << "\t";
-            emit(binaryNode->binary_operator.get(), outf, 4);
-            outf << " ";
-            emit(binaryNode->operand1.get(), outf, 4);
+            outf << "\t" << operatorMnemonic(binaryNode->binary_operator) << " ";
+            emitOperand(binaryNode->operand1, outf, 4);
             outf << ", ";
-            emit(binaryNode->operand2.get(), outf, 4);
+            emitOperand(binaryNode->operand2, outf, 4);
             outf << "\n";
             break;
         }
@@ -56,53 +172,50 @@ void emit(const AsmIRNode* node, std::ofstream& outf, int registerBytes) {
             const auto* cmpNode = static_cast<const AsmIRCmp*>(node);
             outf << "\t";
             outf << "cmpl ";
-            emit(cmpNode->operand1.get(), outf, 4);
+            emitOperand(cmpNode->operand1, outf, 4);
+            outf << ", ";
+            emitOperand(cmpNode->operand2, outf, 4);
+            outf << "\n";
+            break;
+        }
+        case AsmIRNodeType::TEST: {
+            const auto* testNode = static_cast<const AsmIRTest*>(node);
+            outf << "\t";
+            outf << "testl ";
+            emitOperand(testNode->operand1, outf, 4);
             outf << ", ";
-            emit(cmpNode->operand2.get(), outf, 4);
+            emitOperand(testNode->operand2, outf, 4);
+            outf << "\n";
+            break;
+        }
+        case AsmIRNodeType::MOVZX: {
+            const auto* movzxNode = static_cast<const AsmIRMovZeroExtend*>(node);
+            outf << "\tmovzbl ";
+            emitOperand(movzxNode->src, outf, 1);
+            outf << ", ";
+            emitOperand(movzxNode->dst, outf, 4);
             outf << "\n";
             break;
         }
         case AsmIRNodeType::JMP: {
             const auto* jmpNode = static_cast<const AsmIRJmp*>(node);
             outf << "\t";
-            outf << "jmp .L" << jmpNode->identifier; 
+            outf << "jmp .L" << jmpNode->identifier;
             outf << "\n";
             break;
         }
         case AsmIRNodeType::JMP_CC: {
             const auto* jmpNode = static_cast<const AsmIRJmpCC*>(node);
-            std::string cond_code = "";
-            if (jmpNode->cond_code == "NE") {
-                cond_code = "ne";
-            } else if (jmpNode->cond_code == "E") {
-                cond_code = "e";
-            }
             outf << "\t";
-            outf << "j" << cond_code << " .L" << jmpNode->identifier ;
+            outf << "j" << conditionSuffix(jmpNode->cond_code) << " .L" << jmpNode->identifier;
             outf << "\n";
             break;
         }
         case AsmIRNodeType::SET_CC: {
             const auto* setCCNode = static_cast<const AsmIRSetCC*>(node);
-            std::string cond_code = "";
-            if (setCCNode->cond_code == "E") {
-                cond_code = "e";
-            } else if (setCCNode->cond_code == "NE") {
-                cond_code = "ne";
-            } else if (setCCNode->cond_code == "L") {
-                cond_code = "l";
-            } else if (setCCNode->cond_code == "LE") {
-                cond_code = "le";
-            } else if (setCCNode->cond_code == "G") {
-                cond_code = "g";
-            } else if (setCCNode->cond_code == "GE") {
-                cond_code = "ge";
-            } else {
-                std::cout << "Invalid condition code" << std::endl;
-            }
             outf << "\t";
-            outf << "set" << cond_code << " ";
-            emit(setCCNode->operand.get(), outf, 1);
+            outf << "set" << conditionSuffix(setCCNode->cond_code) << " ";
+            emitOperand(setCCNode->operand, outf, 1);
             outf << "\n";
             break;
         }
@@ -117,80 +230,58 @@ void emit(const AsmIRNode* node, std::ofstream& outf, int registerBytes) {
             const auto* idiv = static_cast<const AsmIRIdiv*>(node);
             outf << "\t";
             outf << "idivl ";
-            emit(idiv->operand.get(), outf, 4);
+            emitOperand(idiv->operand, outf, 4);
             outf << "\n";
 
             break;
         }
-        case AsmIRNodeType::CDQ: {
-            const auto* cdq = static_cast<const AsmIRCdq*>(node);
-            outf << "\t";
-            outf << "cdq";
+        case AsmIRNodeType::IMUL_WIDE: {
+            const auto* imul = static_cast<const AsmIRImulWide*>(node);
+            outf << "\timull ";
+            emitOperand(imul->operand, outf, 4);
             outf << "\n";
             break;
         }
-        case AsmIRNodeType::ALLOCATE_STACK: {
-            // subq $<int>, %rsp
-            const auto* allocateStackNode = static_cast<const AsmIRAllocateStack*>(node);
-            outf << "\tsubq $" << std::to_string(allocateStackNode->stack_size) << ", %rsp\n";
-            break;
-        }
-        case AsmIRNodeType::REGISTER: {
-            const auto* regNode = static_cast<const AsmIRReg*>(node);
-            if (regNode->value == "AX" && registerBytes == 4) {
-                outf << "%eax";
-            } else if (regNode->value == "AX" && registerBytes == 1) {
-                outf << "%al";
-            } else if (regNode->value == "DX" && registerBytes == 4) { 
-                outf << "%edx";
-            } else if (regNode->value == "DX" && registerBytes == 1) { 
-                outf << "%dl";
-            } else if (regNode->value == "R10" && registerBytes == 4) {
-                outf << "%r10d";
-            } else if (regNode->value == "R10" && registerBytes == 1) {
-                outf << "%r10b";
-            } else if (regNode->value == "R11" && registerBytes == 4) {
-                outf << "%r11d";
-            } else if (regNode->value == "R11" && registerBytes == 1) {
-                outf << "%r11b";
-            } else {
-                outf << "%";
+        case AsmIRNodeType::LEA: {
+            // addresses are formed from the 64-bit registers; leal keeps the low 32 bits
+            const auto* lea = static_cast<const AsmIRLea*>(node);
+            outf << "\tleal ";
+            if (lea->displacement != 0) outf << lea->displacement;
+            outf << "(";
+            if (lea->base) emitOperand(lea->base, outf, 8);
+            if (lea->index) {
+                outf << ", ";
+                emitOperand(lea->index, outf, 8);
+                outf << ", " << lea->scale;
             }
+            outf << "), ";
+            emitOperand(lea->dst, outf, 4);
+            outf << "\n";
             break;
         }
-        case AsmIRNodeType::STACK: {
-            const auto* stackNode = static_cast<const AsmIRStack*>(node);
-            outf << std::to_string(stackNode->stack_size) << "(%rbp)";
-            break;
-        }
-        case AsmIRNodeType::IMMEDIATE: {
-            const auto* immNode = static_cast<const AsmIRImm*>(node);
-            outf << "$" << immNode->value;
-            break;
-        }
-        case AsmIRNodeType::NEG: {
-            outf << "negl";
-            break;
-        }
-        case AsmIRNodeType::NOT: {
-            outf << "notl";
-            break;
-        }
-        case AsmIRNodeType::ADD: {
-            outf << "addl";
+        case AsmIRNodeType::CDQ: {
+            outf << "\t";
+            outf << "cdq";
+            outf << "\n";
             break;
         }
-        case AsmIRNodeType::SUBTRACT: {
-            outf << "subl";
+        case AsmIRNodeType::COUNT_EDGE: {
+            // incq would clobber the flags a later jump may still read
+            const auto* countNode = static_cast<const AsmIRCountEdge*>(node);
+            std::string counter = "__antcc_profile_counters+" + std::to_string(8 * countNode->counter) + "(%rip)";
+            outf << "\tmovq " << counter << ", %r11\n";
+            outf << "\tleaq 1(%r11), %r11\n";
+            outf << "\tmovq %r11, " << counter << "\n";
             break;
         }
-        case AsmIRNodeType::MULTIPLY: {
-            outf << "imull";
+        case AsmIRNodeType::ALLOCATE_STACK: {
+            // subq $<int>, %rsp
+            const auto* allocateStackNode = static_cast<const AsmIRAllocateStack*>(node);
+            outf << "\tsubq $" << std::to_string(allocateStackNode->stack_size) << ", %rsp\n";
             break;
         }
         case AsmIRNodeType::RETURN: {
-            outf << "\tmovq %rbp, %rsp\n";
-            outf << "\tpopq %rbp\n";
+            if (frameSize > 0) outf << "\taddq $" << std::to_string(frameSize) << ", %rsp\n";
             outf << "\tret\n";
             break;
         }
@@ -205,6 +296,5 @@ void emitCode(const AsmIRNode* node, std::string filename) {
         std::cerr << "Uh oh, output.s could not be opened for writing!\n";
         return;
     }
-    // registerBytes default to 4, exceptions in setcc
-    emit(node, outf, 4);
-}
\ No newline at end of file
+    emit(node, outf);
+}
@@ -1,25 +1,209 @@
 #include "tacky_ir.h"
 #include "ast.h"
+#include "profile.h"
 #include <iostream>
+#include <algorithm>
+#include <unordered_map>
 
 int temporaryAddress = 0;
-int falseAndLabelCount = 0;
-int trueOrLabelCount = 0;
-int endLabelCount = 0;
 
 std::string makeTemporary() {
     return "tmp" + std::to_string(temporaryAddress++) + ".o";
 }
 
-std::string makeFalseAndLabel() {
-    return "and_false" + std::to_string(falseAndLabelCount++);
+// && and || labels are named after the operator's site number rather than a running count,
+// so they stay put when another site switches between branchy and branchless lowering
+std::string makeFalseAndLabel(int site) {
+    return "and_false" + std::to_string(site);
 }
 
-std::string makeTrueOrLabel() {
-    return "or_true" + std::to_string(trueOrLabelCount++);
+std::string makeTrueOrLabel(int site) {
+    return "or_true" + std::to_string(site);
 }
-std::string makeEndLabel() {
-    return "end" + std::to_string(endLabelCount++);
+std::string makeEndLabel(int site) {
+    return "end" + std::to_string(site);
+}
+
+// --- Temporary Recycling ---
+// A temporary is dead once the instruction consuming it has been emitted, so it can hold the next result.
+std::vector<std::string> freeTemporaries;
+
+std::string acquireTemporary() {
+    if (freeTemporaries.empty()) return makeTemporary();
+    std::string name = freeTemporaries.back();
+    freeTemporaries.pop_back();
+    return name;
+}
+
+void releaseTemporary(const TackyIRNode* operand) {
+    if (!operand || operand->type != TackyIRNodeType::VAR) return;
+    const std::string& name = static_cast<const TackyIRVar*>(operand)->value;
+    // user variables can't contain '.', so only temporaries end in ".o"
+    if (name.size() > 2 && name.compare(name.size() - 2, 2, ".o") == 0)
+        freeTemporaries.push_back(name);
+}
+
+// --- Branchless Logical Operators ---
+// && and || only need jumps to skip the right operand. When evaluating it can't fault or
+// assign, each side is reduced to 0/1 and combined with a bitwise and/or instead, which
+// trades a data-dependent branch for a few ALU ops. Past branchlessBudget instructions the
+// wasted work outweighs an occasional misprediction.
+const int branchlessBudget = 4;
+
+bool isLogical(const Node* node) {
+    if (node->type != NodeType::BINARY_OP) return false;
+    NodeType op = static_cast<const BinaryNode*>(node)->binaryOperator->type;
+    return op == NodeType::AND || op == NodeType::OR;
+}
+
+// Each && and || in source order, numbered before anything is lowered
+std::unordered_map<const Node*, int> logicalSites;
+
+void numberLogicalSites(const Node* node) {
+    if (!node) return;
+    switch (node->type) {
+        case NodeType::RETURN:
+            numberLogicalSites(static_cast<const ReturnNode*>(node)->expr.get());
+            break;
+        case NodeType::DECLARATION:
+            numberLogicalSites(static_cast<const DeclarationNode*>(node)->expression.get());
+            break;
+        case NodeType::ASSIGNMENT:
+            numberLogicalSites(static_cast<const AssignmentNode*>(node)->expression2.get());
+            break;
+        case NodeType::UNARY_OP:
+            numberLogicalSites(static_cast<const UnOpNode*>(node)->expr.get());
+            break;
+        case NodeType::BINARY_OP: {
+            const auto* binaryNode = static_cast<const BinaryNode*>(node);
+            if (isLogical(node)) logicalSites.emplace(node, static_cast<int>(logicalSites.size()));
+            numberLogicalSites(binaryNode->expression1.get());
+            numberLogicalSites(binaryNode->expression2.get());
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+// Already 0 or 1, so no != 0 is needed before combining
+bool isBooleanValued(const Node* node) {
+    if (node->type == NodeType::UNARY_OP) return static_cast<const UnOpNode*>(node)->op->type == NodeType::NOT;
+    if (node->type != NodeType::BINARY_OP) return false;
+    switch (static_cast<const BinaryNode*>(node)->binaryOperator->type) {
+        case NodeType::AND: case NodeType::OR:
+        case NodeType::EQUAL: case NodeType::NOT_EQUAL:
+        case NodeType::LESS_THAN: case NodeType::LESS_OR_EQUAL:
+        case NodeType::GREATER_THAN: case NodeType::GREATER_OR_EQUAL:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool lowersBranchless(const BinaryNode* node);
+
+// Instructions needed to evaluate node unconditionally, or -1 when it assigns or may trap
+int speculationCost(const Node* node) {
+    switch (node->type) {
+        case NodeType::CONSTANT:
+        case NodeType::VAR:
+            return 0;
+        case NodeType::UNARY_OP: {
+            int operand = speculationCost(static_cast<const UnOpNode*>(node)->expr.get());
+            return operand < 0 ? -1 : operand + 1;
+        }
+        case NodeType::BINARY_OP: {
+            const auto* binaryNode = static_cast<const BinaryNode*>(node);
+            NodeType op = binaryNode->binaryOperator->type;
+            // division by zero and INT_MIN / -1 trap
+            if (op == NodeType::DIVIDE || op == NodeType::REMAINDER) return -1;
+            if (isLogical(node) && !lowersBranchless(binaryNode)) return -1;
+            int left = speculationCost(binaryNode->expression1.get());
+            int right = speculationCost(binaryNode->expression2.get());
+            if (left < 0 || right < 0) return -1;
+            int combine = 1;
+            if (isLogical(node)) {
+                combine += !isBooleanValued(binaryNode->expression1.get()) + !isBooleanValued(binaryNode->expression2.get());
+            }
+            return left + right + combine;
+        }
+        default:
+            return -1;
+    }
+}
+
+// Past this share of skips (or runs) the branch predicts well and costs next to nothing
+const double predictableRatio = 0.9;
+
+/*
+    The right operand is what the branches would skip; the left one is evaluated either way.
+    A -fprofile-generate build keeps every branch so each site gets counted. With a profile,
+    the left operand's jump says how often the right side is skipped: almost always means
+    the branch is predictable and saves the work, and anywhere in the middle it mispredicts
+    often enough to pay for twice the usual budget.
+*/
+bool lowersBranchless(const BinaryNode* node) {
+    int right = speculationCost(node->expression2.get());
+    if (right < 0 || profileMode == ProfileMode::GENERATE) return false;
+    int cost = right + !isBooleanValued(node->expression2.get());
+
+    auto site = logicalSites.find(node);
+    if (profileMode == ProfileMode::USE && site != logicalSites.end()) {
+        bool isAnd = node->binaryOperator->type == NodeType::AND;
+        std::string skipLabel = isAnd ? makeFalseAndLabel(site->second) : makeTrueOrLabel(site->second);
+        const BranchCounts* counts = profileCounts(branchSiteKey(skipLabel, 0));
+        if (counts && counts->taken + counts->notTaken > 0) {
+            double skipped = static_cast<double>(counts->taken) / static_cast<double>(counts->taken + counts->notTaken);
+            if (skipped >= predictableRatio) return false;
+            if (skipped > 1 - predictableRatio) return cost <= 2 * branchlessBudget;
+        }
+    }
+    return cost <= branchlessBudget;
+}
+
+// --- Sethi-Ullman Numbering ---
+// Number of temporaries live at once while evaluating an expression. Constants and
+// variables are used in place, so they need none.
+std::unordered_map<const Node*, int> registerNeeds;
+
+int registerNeed(const Node* node) {
+    if (!node) return 0;
+    auto it = registerNeeds.find(node);
+    if (it != registerNeeds.end()) return it->second;
+
+    int need = 0;
+    switch (node->type) {
+        case NodeType::UNARY_OP:
+            need = std::max(1, registerNeed(static_cast<const UnOpNode*>(node)->expr.get()));
+            break;
+        case NodeType::ASSIGNMENT:
+            need = registerNeed(static_cast<const AssignmentNode*>(node)->expression2.get());
+            break;
+        case NodeType::BINARY_OP: {
+            const auto* binaryNode = static_cast<const BinaryNode*>(node);
+            int left = registerNeed(binaryNode->expression1.get());
+            int right = registerNeed(binaryNode->expression2.get());
+            NodeType op = binaryNode->binaryOperator->type;
+            if ((op == NodeType::AND || op == NodeType::OR) && !lowersBranchless(binaryNode)) {
+                // each operand is consumed by its jump before the next one starts
+                need = std::max({left, right, 1});
+            } else if (op == NodeType::AND || op == NodeType::OR) {
+                // the left side's 0/1 is held while the right side is evaluated
+                need = std::max({left, right + 1, 1});
+            } else {
+                // the heavier side goes first and its result is held while the other is evaluated
+                int heavy = std::max(left, right);
+                int light = std::min(left, right);
+                need = std::max({heavy, light + 1, 1});
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    registerNeeds[node] = need;
+    return need;
 }
 
 std::unique_ptr<TackyIRNode> generateTacky(const Node* node, TackyIRInstructions* instructions) {
@@ -37,12 +221,18 @@ std::unique_ptr<TackyIRNode> generateTacky(const Node* node, TackyIRInstructions
         case NodeType::FUNCTION: {
             const auto* functionNode = static_cast<const FunctionNode*>(node);
             auto inst = std::make_unique<TackyIRInstructions>();
+            freeTemporaries.clear();
+            for (const auto& blockItem: functionNode->block->instructions) numberLogicalSites(blockItem.get());
             //skip for parser
             //auto ret = generateTacky(functionNode->statement.get(), inst.get());
             //inst->instructions.push_back(std::move(ret));
             for (const auto& blockItem: functionNode->block->instructions) {
                 auto item = generateTacky(blockItem.get(), inst.get());
+                // an expression statement's value is discarded
+                releaseTemporary(item.get());
             }
+            // falling off the end of main returns 0
+            inst->instructions.push_back(std::make_unique<TackyIRReturn>(std::make_unique<TackyIRConstant>("0")));
 
             return std::make_unique<TackyIRFunction>(
                 functionNode->name,
@@ -53,7 +243,37 @@ std::unique_ptr<TackyIRNode> generateTacky(const Node* node, TackyIRInstructions
         case NodeType::RETURN: {
             const auto* returnNode = static_cast<const ReturnNode*>(node);
             auto ret = generateTacky(returnNode->expr.get(), instructions);
-            return std::make_unique<TackyIRReturn>(std::move(ret));
+            releaseTemporary(ret.get());
+            instructions->instructions.push_back(std::make_unique<TackyIRReturn>(std::move(ret)));
+            return nullptr;
+        }
+
+        case NodeType::DECLARATION: {
+            const auto* declarationNode = static_cast<const DeclarationNode*>(node);
+            if (declarationNode->expression) {
+                auto init = generateTacky(declarationNode->expression.get(), instructions);
+                releaseTemporary(init.get());
+                instructions->instructions.push_back(std::make_unique<TackyIRCopy>(std::move(init), std::make_unique<TackyIRVar>(declarationNode->identifier)));
+            }
+            return nullptr;
+        }
+
+        case NodeType::ASSIGNMENT: {
+            const auto* assignmentNode = static_cast<const AssignmentNode*>(node);
+            if (assignmentNode->expression1->type != NodeType::VAR) {
+                std::cout << "Invalid lvalue" << std::endl;
+                return nullptr;
+            }
+            const auto* varNode = static_cast<const VarNode*>(assignmentNode->expression1.get());
+            auto rhs = generateTacky(assignmentNode->expression2.get(), instructions);
+            releaseTemporary(rhs.get());
+            instructions->instructions.push_back(std::make_unique<TackyIRCopy>(std::move(rhs), std::make_unique<TackyIRVar>(varNode->identifier)));
+            return std::make_unique<TackyIRVar>(varNode->identifier);
+        }
+
+        case NodeType::VAR: {
+            const auto* varNode = static_cast<const VarNode*>(node);
+            return std::make_unique<TackyIRVar>(varNode->identifier);
         }
 
         case NodeType::UNARY_OP: {
@@ -61,7 +281,8 @@ std::unique_ptr<TackyIRNode> generateTacky(const Node* node, TackyIRInstructions
 
             auto src = generateTacky(unaryNode->expr.get(), instructions);
 
-            std::string tempName = makeTemporary();
+            releaseTemporary(src.get());
+            std::string tempName = acquireTemporary();
             auto dst = std::make_unique<TackyIRVar>(tempName);
 
             auto tackyOp = generateTacky(unaryNode->op.get(), nullptr);
@@ -81,17 +302,51 @@ std::unique_ptr<TackyIRNode> generateTacky(const Node* node, TackyIRInstructions
             const auto* binaryNode = static_cast<const BinaryNode*>(node);
             auto tackyOp = generateTacky(binaryNode->binaryOperator.get(), nullptr);
 
-            if (binaryNode->binaryOperator->type == NodeType::AND) {
-                std::string falseLabel = makeFalseAndLabel();
-                std::string endLabel = makeEndLabel();
-                std::string result = makeTemporary();
+            if (isLogical(binaryNode) && lowersBranchless(binaryNode)) {
+                /*
+                    Binary(NotEqual, v1, 0, b1)     -- skipped when the operand is already 0/1
+                    Binary(NotEqual, v2, 0, b2)
+                    Binary(BitwiseAnd | BitwiseOr, b1, b2, result)
+                */
+                auto evaluate = [&](const Node* operand) {
+                    auto value = generateTacky(operand, instructions);
+                    if (isBooleanValued(operand)) return value;
+                    releaseTemporary(value.get());
+                    std::string normalized = acquireTemporary();
+                    instructions->instructions.push_back(std::make_unique<TackyIRBinary>(
+                        std::make_unique<TackyIRNotEqual>(), std::move(value), std::make_unique<TackyIRConstant>("0"),
+                        std::make_unique<TackyIRVar>(normalized)));
+                    return std::unique_ptr<TackyIRNode>(std::make_unique<TackyIRVar>(normalized));
+                };
+
+                // the left operand is sequenced first and may assign what the right one reads
+                auto v1 = evaluate(binaryNode->expression1.get());
+                auto v2 = evaluate(binaryNode->expression2.get());
+
+                releaseTemporary(v1.get());
+                std::string result = acquireTemporary();
+                releaseTemporary(v2.get());
+                std::unique_ptr<TackyIRNode> combine;
+                if (binaryNode->binaryOperator->type == NodeType::AND) combine = std::make_unique<TackyIRBitwiseAnd>();
+                else combine = std::make_unique<TackyIRBitwiseOr>();
+                instructions->instructions.push_back(std::make_unique<TackyIRBinary>(
+                    std::move(combine), std::move(v1), std::move(v2), std::make_unique<TackyIRVar>(result)));
+                return std::make_unique<TackyIRVar>(result);
+            } else if (binaryNode->binaryOperator->type == NodeType::AND) {
+                int site = logicalSites.at(binaryNode);
+                std::string falseLabel = makeFalseAndLabel(site);
+                std::string endLabel = makeEndLabel(site);
 
                 auto v1 = generateTacky(binaryNode->expression1.get(), instructions);
+                releaseTemporary(v1.get());
                 instructions->instructions.push_back(std::make_unique<TackyIRJumpIfZero>(std::move(v1), falseLabel));
 
                 auto v2 = generateTacky(binaryNode->expression2.get(), instructions);
+                releaseTemporary(v2.get());
                 instructions->instructions.push_back(std::make_unique<TackyIRJumpIfZero>(std::move(v2), falseLabel));
 
+                std::string result = acquireTemporary();
+
                 instructions->instructions.push_back(std::make_unique<TackyIRCopy>(std::make_unique<TackyIRConstant>("1"), std::make_unique<TackyIRVar>(result)));
 
                 instructions->instructions.push_back(std::make_unique<TackyIRJump>(endLabel));
@@ -101,16 +356,20 @@ std::unique_ptr<TackyIRNode> generateTacky(const Node* node, TackyIRInstructions
 
                 return std::make_unique<TackyIRVar>(result);
             } else if (binaryNode->binaryOperator->type == NodeType::OR) {
-                std::string trueLabel = makeTrueOrLabel();
-                std::string endLabel = makeEndLabel();
-                std::string result = makeTemporary();
+                int site = logicalSites.at(binaryNode);
+                std::string trueLabel = makeTrueOrLabel(site);
+                std::string endLabel = makeEndLabel(site);
 
                 auto v1 = generateTacky(binaryNode->expression1.get(), instructions);
+                releaseTemporary(v1.get());
                 instructions->instructions.push_back(std::make_unique<TackyIRJumpIfNotZero>(std::move(v1), trueLabel));
 
                 auto v2 = generateTacky(binaryNode->expression2.get(), instructions);
+                releaseTemporary(v2.get());
                 instructions->instructions.push_back(std::make_unique<TackyIRJumpIfNotZero>(std::move(v2), trueLabel));
 
+                std::string result = acquireTemporary();
+
                 instructions->instructions.push_back(std::make_unique<TackyIRCopy>(std::make_unique<TackyIRConstant>("0"), std::make_unique<TackyIRVar>(result)));
 
                 instructions->instructions.push_back(std::make_unique<TackyIRJump>(endLabel));
@@ -120,9 +379,20 @@ std::unique_ptr<TackyIRNode> generateTacky(const Node* node, TackyIRInstructions
 
                 return std::make_unique<TackyIRVar>(result);
             } else {
-                auto v1 = generateTacky(binaryNode->expression1.get(), instructions);
-                auto v2 = generateTacky(binaryNode->expression2.get(), instructions);
-                std::string tempName = makeTemporary();
+                // C leaves operand order unspecified, so start with the side that needs more temporaries
+                std::unique_ptr<TackyIRNode> v1, v2;
+                if (registerNeed(binaryNode->expression2.get()) > registerNeed(binaryNode->expression1.get())) {
+                    v2 = generateTacky(binaryNode->expression2.get(), instructions);
+                    v1 = generateTacky(binaryNode->expression1.get(), instructions);
+                } else {
+                    v1 = generateTacky(binaryNode->expression1.get(), instructions);
+                    v2 = generateTacky(binaryNode->expression2.get(), instructions);
+                }
+
+                // dst may reuse src1's temporary but never src2's
+                releaseTemporary(v1.get());
+                std::string tempName = acquireTemporary();
+                releaseTemporary(v2.get());
                 auto dst = std::make_unique<TackyIRVar>(tempName);
 
                 instructions->instructions.push_back(
@@ -318,6 +588,18 @@ void printTacky(const TackyIRNode* node, int count) {
             std::cout << "GreaterOrEqual";
             break;
         }
+        case TackyIRNodeType::SHIFT_RIGHT: {
+            std::cout << "ShiftRight";
+            break;
+        }
+        case TackyIRNodeType::BITWISE_AND: {
+            std::cout << "BitwiseAnd";
+            break;
+        }
+        case TackyIRNodeType::BITWISE_OR: {
+            std::cout << "BitwiseOr";
+            break;
+        }
         case TackyIRNodeType::RETURN: {
             const TackyIRReturn* returnNode = static_cast<const TackyIRReturn*>(node);
             printSpace(count);
@@ -369,6 +651,18 @@ void printTacky(const TackyIRNode* node, int count) {
             std::cout << "Label(" << labelNode->identifier << ")" << std::endl;
             break;
         }
+        case TackyIRNodeType::PHI: {
+            const TackyIRPhi* phiNode = static_cast<const TackyIRPhi*>(node);
+            printSpace(count);
+            std::cout << "Phi(";
+            printTacky(phiNode->dst.get(), 0);
+            for (const auto& arg : phiNode->args) {
+                std::cout << ", " << arg.first << ": ";
+                printTacky(arg.second.get(), 0);
+            }
+            std::cout << ")" << std::endl;
+            break;
+        }
 
         default:
             printSpace(count);
@@ -6,5 +6,6 @@
 
 std::unique_ptr<TackyIRNode> generateTacky(const Node* node, TackyIRInstructions* instructions);
 void printTacky(const TackyIRNode* node, int count);
+std::string makeTemporary();
 
 #endif
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include "gvn.h"
+#include "tacky_eval.h"
+#include <iostream>
+#include <algorithm>
+
+static std::string operandKey(const TackyIRNode* operand) {
+    if (const std::string* name = tackyVarName(operand)) return "v:" + *name;
+    return "c:" + static_cast<const TackyIRConstant*>(operand)->value;
+}
+
+void passGVN(TackyCFG& cfg) {
+    const auto& children = cachedDominatorTree(cfg);
+
+    // SSA name -> operand it is equal to (a Var defined earlier, or a Constant)
+    std::unordered_map<std::string, std::unique_ptr<TackyIRNode>> replacement;
+    std::unordered_map<std::string, std::string> available;
+    std::vector<std::vector<std::string>> scopeKeys(cfg.blocks.size());
+
+    auto resolve = [&](std::unique_ptr<TackyIRNode>& operand) {
+        const std::string* name = tackyVarName(operand.get());
+        while (name) {
+            auto it = replacement.find(*name);
+            if (it == replacement.end()) break;
+            operand = cloneTackyOperand(it->second.get());
+            name = tackyVarName(operand.get());
+        }
+    };
+
+    std::vector<std::pair<int, bool>> work = {{0, false}};
+    while (!work.empty()) {
+        auto [b, done] = work.back();
+        work.pop_back();
+
+        if (done) {
+            for (const auto& key : scopeKeys[b]) available.erase(key);
+            continue;
+        }
+
+        auto& instrs = cfg.blocks[b].instructions;
+        std::vector<std::unique_ptr<TackyIRNode>> kept;
+        for (auto& instr : instrs) {
+            for (auto* use : tackyUses(instr.get())) resolve(*use);
+
+            auto* dst = tackyDestination(instr.get());
+            std::string key;
+
+            switch (instr->type) {
+                case TackyIRNodeType::COPY: {
+                    auto* copy = static_cast<TackyIRCopy*>(instr.get());
+                    replacement[*tackyVarName(copy->dst.get())] = std::move(copy->src);
+                    continue;
+                }
+                case TackyIRNodeType::PHI: {
+                    auto* phi = static_cast<TackyIRPhi*>(instr.get());
+                    bool same = !phi->args.empty();
+                    for (auto& arg : phi->args)
+                        same = same && operandKey(arg.second.get()) == operandKey(phi->args[0].second.get());
+                    if (same && operandKey(phi->args[0].second.get()) != operandKey(phi->dst.get())) {
+                        replacement[*tackyVarName(phi->dst.get())] = std::move(phi->args[0].second);
+                        continue;
+                    }
+                    key = "phi" + std::to_string(b);
+                    for (auto& arg : phi->args)
+                        key += "|" + std::to_string(arg.first) + "=" + operandKey(arg.second.get());
+                    break;
+                }
+                case TackyIRNodeType::UNARY: {
+                    auto* unary = static_cast<TackyIRUnary*>(instr.get());
+                    key = std::to_string(static_cast<int>(unary->op->type)) + "|" + operandKey(unary->src.get());
+                    break;
+                }
+                case TackyIRNodeType::BINARY: {
+                    auto* binary = static_cast<TackyIRBinary*>(instr.get());
+                    std::string lhs = operandKey(binary->src1.get());
+                    std::string rhs = operandKey(binary->src2.get());
+                    if (isTackyCommutative(binary->op->type) && rhs < lhs) std::swap(lhs, rhs);
+                    key = std::to_string(static_cast<int>(binary->op->type)) + "|" + lhs + "|" + rhs;
+                    break;
+                }
+                default:
+                    break;
+            }
+
+            if (!key.empty()) {
+                auto it = available.find(key);
+                if (it != available.end()) {
+                    replacement[*tackyVarName(dst->get())] = std::make_unique<TackyIRVar>(it->second);
+                    continue;
+                }
+                available[key] = *tackyVarName(dst->get());
+                scopeKeys[b].push_back(key);
+            }
+            kept.push_back(std::move(instr));
+        }
+        instrs = std::move(kept);
+
+        work.push_back({b, true});
+        for (int child : children[b])
+            work.push_back({child, false});
+    }
+
+    // phi arguments can be visited before the block defining them was numbered
+    for (auto& block : cfg.blocks) {
+        for (auto& instr : block.instructions) {
+            for (auto* use : tackyUses(instr.get())) resolve(*use);
+        }
+    }
+}
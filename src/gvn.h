@@ -0,0 +1,9 @@
+#ifndef GVN_H
+#define GVN_H
+
+#include "tacky_cfg.h"
+
+// Dominator-based global value numbering with copy propagation. The CFG must be in SSA form.
+void passGVN(TackyCFG& cfg);
+
+#endif
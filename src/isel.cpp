@@ -0,0 +1,681 @@
+#include "isel.h"
+#include "codegen.h"
+#include "generate_tacky.h"
+#include "strength_reduction.h"
+#include "tacky_eval.h"
+#include "target.h"
+#include <array>
+#include <climits>
+#include <iostream>
+#include <unordered_map>
+
+/*
+    A rule reads  nonterminal <- Op(kid nonterminals)  or, for a chain rule,
+    nonterminal <- nonterminal. Costs count emitted instructions; the two-address forms
+    include the mov into the destination even though coalescing often removes it, and an
+    imull also pays its latency on the -mtune target (see ruleCost).
+    Labeling computes the cheapest rule for every (node, nonterminal) pair bottom-up and
+    reduction replays the chosen rules top-down, so the tiling is optimal for the table.
+*/
+
+// --- Rule Table ---
+enum class Op : uint8_t { CONST, VAR, ADD, SUB, MUL, NEG, NOT, SAR, AND, OR, CHAIN, COUNT };
+enum class Nonterminal : uint8_t { REG, IMM, SCALE, LEA_FACTOR, INDEX, ADDR, COUNT };
+enum class Predicate : uint8_t { NONE, SCALE, LEA_FACTOR };
+enum class Action : uint8_t {
+    CONSTANT, VARIABLE, LOAD_IMMEDIATE,
+    INDEX_REG, INDEX_SCALED, INDEX_SCALED_SWAPPED,
+    ADDR_BASE_INDEX, ADDR_INDEX_BASE, ADDR_REG_DISP, ADDR_DISP_REG, ADDR_ADDR_DISP, ADDR_DISP_ADDR,
+    ADDR_REG_MINUS_DISP, ADDR_ADDR_MINUS_DISP, ADDR_SCALED, ADDR_SCALED_SWAPPED, ADDR_LEA_FACTOR, ADDR_LEA_FACTOR_SWAPPED,
+    LEA,
+    SUBTRACT, SUBTRACT_FROM_IMMEDIATE, MULTIPLY, MULTIPLY_IMMEDIATE, MULTIPLY_IMMEDIATE_SWAPPED,
+    NEGATE, COMPLEMENT, SHIFT_RIGHT, AND, AND_IMMEDIATE, AND_IMMEDIATE_SWAPPED,
+    OR, OR_IMMEDIATE, OR_IMMEDIATE_SWAPPED
+};
+
+using NT = Nonterminal;
+constexpr NT NO_KID = NT::COUNT;
+
+struct Rule {
+    Nonterminal lhs;
+    Op op;
+    std::array<Nonterminal, 2> kids; // a chain rule's source nonterminal is kids[0]
+    Predicate predicate;
+    int cost;
+    Action action;
+};
+
+constexpr Rule rules[] = {
+    // leaves; a constant only becomes SCALE or LEA_FACTOR when its value fits
+    {NT::IMM,        Op::CONST, {NO_KID, NO_KID},  Predicate::NONE,       0, Action::CONSTANT},
+    {NT::SCALE,      Op::CONST, {NO_KID, NO_KID},  Predicate::SCALE,      0, Action::CONSTANT},
+    {NT::LEA_FACTOR, Op::CONST, {NO_KID, NO_KID},  Predicate::LEA_FACTOR, 0, Action::CONSTANT},
+    {NT::REG,        Op::VAR,   {NO_KID, NO_KID},  Predicate::NONE,       0, Action::VARIABLE},
+    {NT::REG,        Op::CHAIN, {NT::IMM, NO_KID}, Predicate::NONE,       1, Action::LOAD_IMMEDIATE},
+
+    // scaled indices and addresses are free until a leal materializes them
+    {NT::INDEX, Op::CHAIN, {NT::REG, NO_KID},     Predicate::NONE, 0, Action::INDEX_REG},
+    {NT::INDEX, Op::MUL,   {NT::REG, NT::SCALE},  Predicate::NONE, 0, Action::INDEX_SCALED},
+    {NT::INDEX, Op::MUL,   {NT::SCALE, NT::REG},  Predicate::NONE, 0, Action::INDEX_SCALED_SWAPPED},
+    {NT::ADDR,  Op::ADD,   {NT::REG, NT::INDEX},  Predicate::NONE, 0, Action::ADDR_BASE_INDEX},
+    {NT::ADDR,  Op::ADD,   {NT::INDEX, NT::REG},  Predicate::NONE, 0, Action::ADDR_INDEX_BASE},
+    {NT::ADDR,  Op::ADD,   {NT::REG, NT::IMM},    Predicate::NONE, 0, Action::ADDR_REG_DISP},
+    {NT::ADDR,  Op::ADD,   {NT::IMM, NT::REG},    Predicate::NONE, 0, Action::ADDR_DISP_REG},
+    {NT::ADDR,  Op::ADD,   {NT::ADDR, NT::IMM},   Predicate::NONE, 0, Action::ADDR_ADDR_DISP},
+    {NT::ADDR,  Op::ADD,   {NT::IMM, NT::ADDR},   Predicate::NONE, 0, Action::ADDR_DISP_ADDR},
+    {NT::ADDR,  Op::SUB,   {NT::REG, NT::IMM},    Predicate::NONE, 0, Action::ADDR_REG_MINUS_DISP},
+    {NT::ADDR,  Op::SUB,   {NT::ADDR, NT::IMM},   Predicate::NONE, 0, Action::ADDR_ADDR_MINUS_DISP},
+    {NT::ADDR,  Op::MUL,   {NT::REG, NT::SCALE},  Predicate::NONE, 0, Action::ADDR_SCALED},
+    {NT::ADDR,  Op::MUL,   {NT::SCALE, NT::REG},  Predicate::NONE, 0, Action::ADDR_SCALED_SWAPPED},
+    {NT::ADDR,  Op::MUL,   {NT::REG, NT::LEA_FACTOR}, Predicate::NONE, 0, Action::ADDR_LEA_FACTOR},
+    {NT::ADDR,  Op::MUL,   {NT::LEA_FACTOR, NT::REG}, Predicate::NONE, 0, Action::ADDR_LEA_FACTOR_SWAPPED},
+    {NT::REG,   Op::CHAIN, {NT::ADDR, NO_KID},    Predicate::NONE, 1, Action::LEA},
+
+    // two-address ALU ops
+    {NT::REG, Op::SUB, {NT::REG, NT::REG}, Predicate::NONE, 2, Action::SUBTRACT},
+    {NT::REG, Op::SUB, {NT::IMM, NT::REG}, Predicate::NONE, 2, Action::SUBTRACT_FROM_IMMEDIATE},
+    {NT::REG, Op::MUL, {NT::REG, NT::REG}, Predicate::NONE, 1, Action::MULTIPLY},
+    {NT::REG, Op::MUL, {NT::REG, NT::IMM}, Predicate::NONE, 1, Action::MULTIPLY_IMMEDIATE},
+    {NT::REG, Op::MUL, {NT::IMM, NT::REG}, Predicate::NONE, 1, Action::MULTIPLY_IMMEDIATE_SWAPPED},
+    {NT::REG, Op::NEG, {NT::REG, NO_KID},  Predicate::NONE, 2, Action::NEGATE},
+    {NT::REG, Op::NOT, {NT::REG, NO_KID},  Predicate::NONE, 2, Action::COMPLEMENT},
+    {NT::REG, Op::SAR, {NT::REG, NT::IMM}, Predicate::NONE, 2, Action::SHIFT_RIGHT},
+    {NT::REG, Op::AND, {NT::REG, NT::REG}, Predicate::NONE, 2, Action::AND},
+    {NT::REG, Op::AND, {NT::REG, NT::IMM}, Predicate::NONE, 2, Action::AND_IMMEDIATE},
+    {NT::REG, Op::AND, {NT::IMM, NT::REG}, Predicate::NONE, 2, Action::AND_IMMEDIATE_SWAPPED},
+    {NT::REG, Op::OR,  {NT::REG, NT::REG}, Predicate::NONE, 2, Action::OR},
+    {NT::REG, Op::OR,  {NT::REG, NT::IMM}, Predicate::NONE, 2, Action::OR_IMMEDIATE},
+    {NT::REG, Op::OR,  {NT::IMM, NT::REG}, Predicate::NONE, 2, Action::OR_IMMEDIATE_SWAPPED},
+};
+
+constexpr size_t ruleCount = sizeof(rules) / sizeof(rules[0]);
+constexpr size_t opCount = static_cast<size_t>(Op::COUNT);
+constexpr size_t nonterminalCount = static_cast<size_t>(NT::COUNT);
+
+constexpr int arity(Op op) {
+    switch (op) {
+        case Op::CONST:
+        case Op::VAR: return 0;
+        case Op::NEG:
+        case Op::NOT:
+        case Op::CHAIN: return 1;
+        default: return 2;
+    }
+}
+
+// Rules grouped by operator, built by the compiler so matching is a table lookup
+struct RuleIndex {
+    std::array<std::array<uint8_t, ruleCount>, opCount> byOp{};
+    std::array<uint8_t, opCount> count{};
+};
+
+constexpr RuleIndex buildRuleIndex() {
+    RuleIndex index{};
+    for (size_t r = 0; r < ruleCount; ++r) {
+        size_t op = static_cast<size_t>(rules[r].op);
+        index.byOp[op][index.count[op]++] = static_cast<uint8_t>(r);
+    }
+    return index;
+}
+
+constexpr bool rulesWellFormed() {
+    for (size_t r = 0; r < ruleCount; ++r) {
+        const Rule& rule = rules[r];
+        for (int k = 0; k < 2; ++k) {
+            bool hasKid = rule.kids[k] != NO_KID;
+            if (hasKid != (k < arity(rule.op))) return false;
+        }
+        if (rule.op == Op::CHAIN && rule.kids[0] == rule.lhs) return false;
+        if (rule.predicate != Predicate::NONE && rule.op != Op::CONST) return false;
+    }
+    return true;
+}
+
+constexpr RuleIndex ruleIndex = buildRuleIndex();
+static_assert(ruleCount < 256, "rule numbers are stored in a byte");
+static_assert(rulesWellFormed(), "kid count must match the operator's arity");
+
+// --- Expression Trees ---
+constexpr int UNCOVERED = INT_MAX / 4;
+
+struct TreeNode {
+    Op op;
+    int32_t value = 0;           // CONST
+    std::string name;            // VAR, or the TACKY destination of an interior node
+    std::array<TreeNode*, 2> kids{};
+    std::array<int, nonterminalCount> cost{};
+    std::array<int, nonterminalCount> rule{};
+};
+
+struct Selection {
+    std::string reg;             // REG, and the register scaled by an INDEX
+    int32_t value = 0;           // IMM, SCALE, LEA_FACTOR
+    std::string base, index;     // ADDR; either may be empty
+    int scale = 1;
+    int32_t displacement = 0;
+};
+
+static bool predicateHolds(Predicate predicate, const TreeNode* node) {
+    switch (predicate) {
+        case Predicate::SCALE: return node->value == 1 || node->value == 2 || node->value == 4 || node->value == 8;
+        case Predicate::LEA_FACTOR: return node->value == 3 || node->value == 5 || node->value == 9;
+        default: return true;
+    }
+}
+
+static void record(TreeNode* node, NT lhs, int cost, size_t r) {
+    size_t nt = static_cast<size_t>(lhs);
+    if (cost < node->cost[nt]) {
+        node->cost[nt] = cost;
+        node->rule[nt] = static_cast<int>(r);
+    }
+}
+
+// The table's multiply rules only count the mov; the imull itself costs its latency
+static int ruleCost(const Rule& rule) {
+    switch (rule.action) {
+        case Action::MULTIPLY:
+        case Action::MULTIPLY_IMMEDIATE:
+        case Action::MULTIPLY_IMMEDIATE_SWAPPED:
+            return rule.cost + targetLatency(InstrClass::MULTIPLY);
+        default:
+            return rule.cost;
+    }
+}
+
+static void label(TreeNode* node) {
+    for (int k = 0; k < arity(node->op); ++k) label(node->kids[k]);
+    node->cost.fill(UNCOVERED);
+    node->rule.fill(-1);
+
+    size_t op = static_cast<size_t>(node->op);
+    for (size_t k = 0; k < ruleIndex.count[op]; ++k) {
+        size_t r = ruleIndex.byOp[op][k];
+        const Rule& rule = rules[r];
+        if (!predicateHolds(rule.predicate, node)) continue;
+        int cost = ruleCost(rule);
+        for (int kid = 0; kid < arity(rule.op); ++kid) cost += node->kids[kid]->cost[static_cast<size_t>(rule.kids[kid])];
+        if (cost < UNCOVERED) record(node, rule.lhs, cost, r);
+    }
+
+    // chain rules until nothing improves
+    const size_t chain = static_cast<size_t>(Op::CHAIN);
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t k = 0; k < ruleIndex.count[chain]; ++k) {
+            size_t r = ruleIndex.byOp[chain][k];
+            const Rule& rule = rules[r];
+            int from = node->cost[static_cast<size_t>(rule.kids[0])];
+            if (from >= UNCOVERED || from + rule.cost >= node->cost[static_cast<size_t>(rule.lhs)]) continue;
+            record(node, rule.lhs, from + rule.cost, r);
+            changed = true;
+        }
+    }
+}
+
+// --- Reduction ---
+static AsmIROperand pseudo(const std::string& name) {
+    return asmPseudo(name);
+}
+
+static AsmIROperand imm(int32_t value) {
+    return asmImm(value);
+}
+
+static int32_t wrappingAdd(int32_t a, int32_t b) {
+    return static_cast<int32_t>(static_cast<uint32_t>(a) + static_cast<uint32_t>(b));
+}
+
+static int32_t wrappingSubtract(int32_t a, int32_t b) {
+    return static_cast<int32_t>(static_cast<uint32_t>(a) - static_cast<uint32_t>(b));
+}
+
+struct Reducer {
+    AsmIRInstructions* instructions;
+
+    void push(std::unique_ptr<AsmIRNode> instr) {
+        instructions->instructions.push_back(std::move(instr));
+    }
+
+    void copy(const std::string& src, const std::string& dst) {
+        if (src != dst) push(std::make_unique<AsmIRMov>(pseudo(src), pseudo(dst)));
+    }
+
+    // Where a node's register result goes: its own TACKY destination, or a fresh
+    // temporary for a constant that has to be loaded
+    std::string target(const TreeNode* node) {
+        return node->op == Op::CONST ? makeTemporary() : node->name;
+    }
+
+    /*
+        Mov(lhs, dst)
+        Binary(op, rhs, dst)
+    */
+    void twoAddress(AsmIRNodeType op, bool commutative, const std::string& lhs, const std::string& rhs, const std::string& dst) {
+        if (rhs == dst && lhs != dst) {
+            if (commutative) {
+                push(std::make_unique<AsmIRBinary>(op, pseudo(lhs), pseudo(dst)));
+            } else {
+                // lhs - dst = -dst + lhs
+                push(std::make_unique<AsmIRUnary>(AsmIRNodeType::NEG, pseudo(dst)));
+                push(std::make_unique<AsmIRBinary>(AsmIRNodeType::ADD, pseudo(lhs), pseudo(dst)));
+            }
+            return;
+        }
+        copy(lhs, dst);
+        push(std::make_unique<AsmIRBinary>(op, pseudo(rhs), pseudo(dst)));
+    }
+
+    void immediateOperand(AsmIRNodeType op, const std::string& lhs, int32_t rhs, const std::string& dst) {
+        copy(lhs, dst);
+        push(std::make_unique<AsmIRBinary>(op, imm(rhs), pseudo(dst)));
+    }
+
+    void multiplyImmediate(const std::string& factor, int32_t multiplier, const std::string& dst) {
+        if (!lowerMultiplyByConstant(factor, multiplier, dst, instructions))
+            immediateOperand(AsmIRNodeType::MULTIPLY, factor, multiplier, dst);
+    }
+
+    void lea(const Selection& address, const std::string& dst) {
+        std::string base = address.base, index = address.index;
+        int scale = address.scale;
+        if (base.empty() && scale == 1) std::swap(base, index);
+        if (index.empty() && address.displacement == 0) {
+            copy(base, dst);
+            return;
+        }
+        push(std::make_unique<AsmIRLea>(base.empty() ? AsmIROperand{} : pseudo(base), index.empty() ? AsmIROperand{} : pseudo(index),
+                                        scale, address.displacement, pseudo(dst)));
+    }
+
+    Selection reduce(TreeNode* node, NT nonterminal) {
+        const Rule& rule = rules[node->rule[static_cast<size_t>(nonterminal)]];
+        std::array<Selection, 2> kids;
+        if (rule.op == Op::CHAIN) {
+            kids[0] = reduce(node, rule.kids[0]);
+        } else {
+            for (int k = 0; k < arity(rule.op); ++k) kids[k] = reduce(node->kids[k], rule.kids[k]);
+        }
+
+        Selection result;
+        switch (rule.action) {
+            case Action::CONSTANT:
+                result.value = node->value;
+                break;
+            case Action::VARIABLE:
+                result.reg = node->name;
+                break;
+            case Action::LOAD_IMMEDIATE:
+                result.reg = target(node);
+                push(std::make_unique<AsmIRMov>(imm(kids[0].value), pseudo(result.reg)));
+                break;
+
+            case Action::INDEX_REG:
+                result.index = kids[0].reg;
+                break;
+            case Action::INDEX_SCALED:
+                result.index = kids[0].reg;
+                result.scale = kids[1].value;
+                break;
+            case Action::INDEX_SCALED_SWAPPED:
+                result.index = kids[1].reg;
+                result.scale = kids[0].value;
+                break;
+            case Action::ADDR_BASE_INDEX:
+                result = kids[1];
+                result.base = kids[0].reg;
+                break;
+            case Action::ADDR_INDEX_BASE:
+                result = kids[0];
+                result.base = kids[1].reg;
+                break;
+            case Action::ADDR_REG_DISP:
+                result.base = kids[0].reg;
+                result.displacement = kids[1].value;
+                break;
+            case Action::ADDR_DISP_REG:
+                result.base = kids[1].reg;
+                result.displacement = kids[0].value;
+                break;
+            case Action::ADDR_ADDR_DISP:
+                result = kids[0];
+                result.displacement = wrappingAdd(result.displacement, kids[1].value);
+                break;
+            case Action::ADDR_DISP_ADDR:
+                result = kids[1];
+                result.displacement = wrappingAdd(result.displacement, kids[0].value);
+                break;
+            case Action::ADDR_REG_MINUS_DISP:
+                result.base = kids[0].reg;
+                result.displacement = wrappingSubtract(0, kids[1].value);
+                break;
+            case Action::ADDR_ADDR_MINUS_DISP:
+                result = kids[0];
+                result.displacement = wrappingSubtract(result.displacement, kids[1].value);
+                break;
+            case Action::ADDR_SCALED:
+                result.index = kids[0].reg;
+                result.scale = kids[1].value;
+                break;
+            case Action::ADDR_SCALED_SWAPPED:
+                result.index = kids[1].reg;
+                result.scale = kids[0].value;
+                break;
+            case Action::ADDR_LEA_FACTOR:
+                result.base = result.index = kids[0].reg;
+                result.scale = kids[1].value - 1;
+                break;
+            case Action::ADDR_LEA_FACTOR_SWAPPED:
+                result.base = result.index = kids[1].reg;
+                result.scale = kids[0].value - 1;
+                break;
+            case Action::LEA:
+                result.reg = target(node);
+                lea(kids[0], result.reg);
+                break;
+
+            case Action::SUBTRACT:
+                result.reg = target(node);
+                twoAddress(AsmIRNodeType::SUBTRACT, false, kids[0].reg, kids[1].reg, result.reg);
+                break;
+            case Action::SUBTRACT_FROM_IMMEDIATE:
+                result.reg = target(node);
+                if (kids[1].reg == result.reg) {
+                    push(std::make_unique<AsmIRUnary>(AsmIRNodeType::NEG, pseudo(result.reg)));
+                    push(std::make_unique<AsmIRBinary>(AsmIRNodeType::ADD, imm(kids[0].value), pseudo(result.reg)));
+                } else {
+                    push(std::make_unique<AsmIRMov>(imm(kids[0].value), pseudo(result.reg)));
+                    push(std::make_unique<AsmIRBinary>(AsmIRNodeType::SUBTRACT, pseudo(kids[1].reg), pseudo(result.reg)));
+                }
+                break;
+            case Action::MULTIPLY:
+                result.reg = target(node);
+                twoAddress(AsmIRNodeType::MULTIPLY, true, kids[0].reg, kids[1].reg, result.reg);
+                break;
+            case Action::MULTIPLY_IMMEDIATE:
+                result.reg = target(node);
+                multiplyImmediate(kids[0].reg, kids[1].value, result.reg);
+                break;
+            case Action::MULTIPLY_IMMEDIATE_SWAPPED:
+                result.reg = target(node);
+                multiplyImmediate(kids[1].reg, kids[0].value, result.reg);
+                break;
+            case Action::NEGATE:
+            case Action::COMPLEMENT:
+                result.reg = target(node);
+                copy(kids[0].reg, result.reg);
+                push(std::make_unique<AsmIRUnary>(
+                    rule.action == Action::NEGATE ? AsmIRNodeType::NEG : AsmIRNodeType::NOT,
+                    pseudo(result.reg)));
+                break;
+            case Action::SHIFT_RIGHT:
+                result.reg = target(node);
+                immediateOperand(AsmIRNodeType::SAR, kids[0].reg, kids[1].value, result.reg);
+                break;
+            case Action::AND:
+                result.reg = target(node);
+                twoAddress(AsmIRNodeType::AND, true, kids[0].reg, kids[1].reg, result.reg);
+                break;
+            case Action::AND_IMMEDIATE:
+                result.reg = target(node);
+                immediateOperand(AsmIRNodeType::AND, kids[0].reg, kids[1].value, result.reg);
+                break;
+            case Action::AND_IMMEDIATE_SWAPPED:
+                result.reg = target(node);
+                immediateOperand(AsmIRNodeType::AND, kids[1].reg, kids[0].value, result.reg);
+                break;
+            case Action::OR:
+                result.reg = target(node);
+                twoAddress(AsmIRNodeType::OR, true, kids[0].reg, kids[1].reg, result.reg);
+                break;
+            case Action::OR_IMMEDIATE:
+                result.reg = target(node);
+                immediateOperand(AsmIRNodeType::OR, kids[0].reg, kids[1].value, result.reg);
+                break;
+            case Action::OR_IMMEDIATE_SWAPPED:
+                result.reg = target(node);
+                immediateOperand(AsmIRNodeType::OR, kids[1].reg, kids[0].value, result.reg);
+                break;
+        }
+        return result;
+    }
+};
+
+// --- Tree Construction ---
+static Op operatorOf(const TackyIRNode* instr) {
+    if (instr->type == TackyIRNodeType::UNARY) {
+        switch (static_cast<const TackyIRUnary*>(instr)->op->type) {
+            case TackyIRNodeType::NEGATE: return Op::NEG;
+            case TackyIRNodeType::COMPLEMENT: return Op::NOT;
+            default: return Op::COUNT;
+        }
+    }
+    if (instr->type == TackyIRNodeType::BINARY) {
+        const auto* binary = static_cast<const TackyIRBinary*>(instr);
+        switch (binary->op->type) {
+            case TackyIRNodeType::ADD: return Op::ADD;
+            case TackyIRNodeType::SUBTRACT: return Op::SUB;
+            case TackyIRNodeType::MULTIPLY: return Op::MUL;
+            case TackyIRNodeType::BITWISE_AND: return Op::AND;
+            case TackyIRNodeType::BITWISE_OR: return Op::OR;
+            // the table only has shifts by an immediate
+            case TackyIRNodeType::SHIFT_RIGHT:
+                return binary->src2->type == TackyIRNodeType::CONSTANT ? Op::SAR : Op::COUNT;
+            default: return Op::COUNT;
+        }
+    }
+    return Op::COUNT;
+}
+
+static std::vector<const TackyIRNode*> operandsOf(const TackyIRNode* instr) {
+    switch (instr->type) {
+        case TackyIRNodeType::RETURN: return {static_cast<const TackyIRReturn*>(instr)->expr.get()};
+        case TackyIRNodeType::UNARY: return {static_cast<const TackyIRUnary*>(instr)->src.get()};
+        case TackyIRNodeType::BINARY: {
+            const auto* binary = static_cast<const TackyIRBinary*>(instr);
+            return {binary->src1.get(), binary->src2.get()};
+        }
+        case TackyIRNodeType::COPY: return {static_cast<const TackyIRCopy*>(instr)->src.get()};
+        case TackyIRNodeType::JUMP_IF_ZERO: return {static_cast<const TackyIRJumpIfZero*>(instr)->condition.get()};
+        case TackyIRNodeType::JUMP_IF_NOT_ZERO: return {static_cast<const TackyIRJumpIfNotZero*>(instr)->condition.get()};
+        default: return {};
+    }
+}
+
+static const std::string* destinationOf(const TackyIRNode* instr) {
+    switch (instr->type) {
+        case TackyIRNodeType::UNARY: return &static_cast<const TackyIRVar*>(static_cast<const TackyIRUnary*>(instr)->dst.get())->value;
+        case TackyIRNodeType::BINARY: return &static_cast<const TackyIRVar*>(static_cast<const TackyIRBinary*>(instr)->dst.get())->value;
+        case TackyIRNodeType::COPY: return &static_cast<const TackyIRVar*>(static_cast<const TackyIRCopy*>(instr)->dst.get())->value;
+        default: return nullptr;
+    }
+}
+
+static bool endsBlock(const TackyIRNode* instr) {
+    return instr->type == TackyIRNodeType::JUMP || instr->type == TackyIRNodeType::JUMP_IF_ZERO ||
+           instr->type == TackyIRNodeType::JUMP_IF_NOT_ZERO || instr->type == TackyIRNodeType::RETURN;
+}
+
+static const std::string* jumpTarget(const TackyIRNode* instr) {
+    switch (instr->type) {
+        case TackyIRNodeType::JUMP_IF_ZERO: return &static_cast<const TackyIRJumpIfZero*>(instr)->target;
+        case TackyIRNodeType::JUMP_IF_NOT_ZERO: return &static_cast<const TackyIRJumpIfNotZero*>(instr)->target;
+        default: return nullptr;
+    }
+}
+
+// A conditional jump right after instr that tests instr's result; with nothing between
+// them the flags from the comparison are still live and the cmp/jcc pair can macro-fuse
+static bool branchesOn(const TackyIRNode* instr, const TackyIRNode* jump) {
+    if (jump->type != TackyIRNodeType::JUMP_IF_ZERO && jump->type != TackyIRNodeType::JUMP_IF_NOT_ZERO) return false;
+    const std::string* dst = destinationOf(instr);
+    const TackyIRNode* condition = operandsOf(jump)[0];
+    return dst && condition->type == TackyIRNodeType::VAR && static_cast<const TackyIRVar*>(condition)->value == *dst;
+}
+
+struct TreeBuilder {
+    const std::vector<std::unique_ptr<TackyIRNode>>& body;
+    std::vector<int> foldInto;                  // instruction whose tree absorbs this one, or -1
+    std::vector<std::array<int, 2>> foldedKids; // per operand, the folded instruction defining it, or -1
+    std::unordered_map<std::string, std::vector<size_t>> defPositions;
+    std::unordered_map<std::string, int> defCount, useCount;
+    std::unordered_map<std::string, size_t> labelPositions;
+    std::vector<std::unique_ptr<TreeNode>> pool;
+
+    explicit TreeBuilder(const std::vector<std::unique_ptr<TackyIRNode>>& body)
+        : body(body), foldInto(body.size(), -1), foldedKids(body.size(), {-1, -1}) {}
+
+    bool redefinedBetween(const std::string& name, size_t after, size_t before) {
+        auto it = defPositions.find(name);
+        if (it == defPositions.end()) return false;
+        for (size_t position : it->second) {
+            if (position > after && position < before) return true;
+        }
+        return false;
+    }
+
+    // Moving instruction i (and what it absorbed) down to j must not change what it reads
+    bool canSinkTo(size_t i, size_t j) {
+        auto operands = operandsOf(body[i].get());
+        for (size_t k = 0; k < operands.size(); ++k) {
+            if (foldedKids[i][k] != -1) {
+                if (!canSinkTo(foldedKids[i][k], j)) return false;
+            } else if (operands[k]->type == TackyIRNodeType::VAR &&
+                       redefinedBetween(static_cast<const TackyIRVar*>(operands[k])->value, i, j)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // The value of name read at j is not read again. The lowering reuses temporaries, so a
+    // redefinition later in the block ends the value; past the block only a name with a
+    // single definition and a single use is known to be dead. A conditional jump at j goes
+    // on in two blocks, and the value has to be dead in the jump target as well.
+    bool deadAfter(const std::string& name, size_t j) {
+        const std::string* dst = destinationOf(body[j].get());
+        if (dst && *dst == name) return true;
+        if (const std::string* target = jumpTarget(body[j].get())) {
+            auto it = labelPositions.find(*target);
+            if (it == labelPositions.end() || !deadInBlock(name, it->second + 1)) return false;
+        }
+        return deadInBlock(name, j + 1);
+    }
+
+    // Scans the rest of the block from k for a read or a redefinition of name
+    bool deadInBlock(const std::string& name, size_t k) {
+        for (; k < body.size(); ++k) {
+            const TackyIRNode* instr = body[k].get();
+            if (instr->type == TackyIRNodeType::LABEL) break;
+            for (const TackyIRNode* operand : operandsOf(instr)) {
+                if (operand->type == TackyIRNodeType::VAR && static_cast<const TackyIRVar*>(operand)->value == name) return false;
+            }
+            const std::string* dst = destinationOf(instr);
+            if (dst && *dst == name) return true;
+            if (endsBlock(instr)) break;
+        }
+        return defCount[name] == 1 && useCount[name] == 1;
+    }
+
+    // An arithmetic result read once, by a later arithmetic instruction of the same block,
+    // and dead afterwards becomes a subtree of its user
+    void decideFolding() {
+        for (size_t j = 0; j < body.size(); ++j) {
+            const TackyIRNode* instr = body[j].get();
+            for (const TackyIRNode* operand : operandsOf(instr)) {
+                if (operand->type == TackyIRNodeType::VAR) useCount[static_cast<const TackyIRVar*>(operand)->value]++;
+            }
+            if (const std::string* dst = destinationOf(instr)) defCount[*dst]++;
+            if (instr->type == TackyIRNodeType::LABEL) labelPositions[static_cast<const TackyIRLabel*>(instr)->identifier] = j;
+        }
+
+        std::unordered_map<std::string, size_t> candidates; // defined earlier in the current block
+        for (size_t j = 0; j < body.size(); ++j) {
+            const TackyIRNode* instr = body[j].get();
+            if (instr->type == TackyIRNodeType::LABEL) candidates.clear();
+
+            auto operands = operandsOf(instr);
+            if (operatorOf(instr) != Op::COUNT) {
+                for (size_t k = 0; k < operands.size(); ++k) {
+                    if (operands[k]->type != TackyIRNodeType::VAR) continue;
+                    const std::string& name = static_cast<const TackyIRVar*>(operands[k])->value;
+                    auto it = candidates.find(name);
+                    if (it == candidates.end()) continue;
+                    bool readTwice = operands.size() == 2 && operands[1 - k]->type == TackyIRNodeType::VAR &&
+                                     static_cast<const TackyIRVar*>(operands[1 - k])->value == name;
+                    if (readTwice || !deadAfter(name, j) || !canSinkTo(it->second, j)) continue;
+                    foldInto[it->second] = static_cast<int>(j);
+                    foldedKids[j][k] = static_cast<int>(it->second);
+                }
+            }
+            // whatever was read here either got folded or stays a register operand
+            for (const TackyIRNode* operand : operands) {
+                if (operand->type == TackyIRNodeType::VAR) candidates.erase(static_cast<const TackyIRVar*>(operand)->value);
+            }
+
+            if (const std::string* dst = destinationOf(instr)) {
+                defPositions[*dst].push_back(j);
+                if (operatorOf(instr) != Op::COUNT) candidates[*dst] = j;
+                else candidates.erase(*dst);
+            }
+            if (endsBlock(instr)) candidates.clear();
+        }
+    }
+
+    TreeNode* leaf(const TackyIRNode* operand) {
+        pool.push_back(std::make_unique<TreeNode>());
+        TreeNode* node = pool.back().get();
+        int32_t value;
+        if (parseTackyConstant(operand, value)) {
+            node->op = Op::CONST;
+            node->value = value;
+        } else {
+            node->op = Op::VAR;
+            node->name = static_cast<const TackyIRVar*>(operand)->value;
+        }
+        return node;
+    }
+
+    // Interior results get fresh pseudos: their TACKY names may be reused by the leaves
+    TreeNode* build(size_t i) {
+        pool.push_back(std::make_unique<TreeNode>());
+        TreeNode* node = pool.back().get();
+        node->op = operatorOf(body[i].get());
+        node->name = foldInto[i] == -1 ? *destinationOf(body[i].get()) : makeTemporary();
+
+        auto operands = operandsOf(body[i].get());
+        for (int k = 0; k < arity(node->op); ++k) {
+            if (foldedKids[i][k] != -1) node->kids[k] = build(foldedKids[i][k]);
+            else node->kids[k] = leaf(operands[k]);
+        }
+        return node;
+    }
+};
+
+void selectInstructions(const std::vector<std::unique_ptr<TackyIRNode>>& body, AsmIRInstructions* instructions) {
+    TreeBuilder trees(body);
+    trees.decideFolding();
+    Reducer reducer{instructions};
+
+    for (size_t i = 0; i < body.size(); ++i) {
+        if (trees.foldInto[i] != -1) continue;
+        if (i + 1 < body.size() && branchesOn(body[i].get(), body[i + 1].get()) && trees.deadAfter(*destinationOf(body[i].get()), i + 1) &&
+            selectCompareAndBranch(body[i].get(), body[i + 1].get(), instructions)) {
+            ++i;
+            continue;
+        }
+        if (operatorOf(body[i].get()) == Op::COUNT) {
+            buildAsmIRAst(body[i].get(), instructions);
+            continue;
+        }
+
+        TreeNode* root = trees.build(i);
+        label(root);
+        if (root->cost[static_cast<size_t>(NT::REG)] >= UNCOVERED) {
+            std::cout << "Error: no instruction selection rule covers " << root->name << std::endl;
+            continue;
+        }
+        reducer.reduce(root, NT::REG);
+    }
+}
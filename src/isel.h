@@ -0,0 +1,13 @@
+#ifndef ISEL_H
+#define ISEL_H
+
+#include "asm_ir.h"
+#include "tacky_ir.h"
+
+// Bottom-up tree-pattern-matching instruction selection for a function body. Arithmetic
+// instructions whose result feeds a single later instruction in the same block are joined
+// into expression trees and covered with the cheapest tiling from the rule table in
+// isel.cpp; everything else goes through the templates in buildAsmIRAst.
+void selectInstructions(const std::vector<std::unique_ptr<TackyIRNode>>& body, AsmIRInstructions* instructions);
+
+#endif
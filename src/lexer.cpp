@@ -126,7 +126,7 @@ std::vector<Token> Lexer::tokenize() {
                         position++;
                         break;
                     } else {
-                        tokens.emplace_back(TokenType::EQUAL, "="); break;
+                        tokens.emplace_back(TokenType::ASSIGN, "="); break;
                     }
                 case '<' :
                     if (position + 1 < input.length() && input[position + 1] == '=') {
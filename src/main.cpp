@@ -2,7 +2,12 @@
 #include "parser.h"
 #include "codegen.h"
 #include "generate_tacky.h"
+#include "optimize.h"
+#include "pass_manager.h"
+#include "peephole.h"
 #include "emitter.h"
+#include "profile.h"
+#include "target.h"
 #include "ast.h"
 #include <iostream>
 #include <string>
@@ -11,6 +16,7 @@
 #include <cstdio>
 #include <memory>
 #include <array>
+#include <filesystem>
 
 std::string readFileToString(const std::string &filename) {
     std::string cmd = "gcc -E -P " + filename; // or "clang -E -P " + filename
@@ -57,36 +63,70 @@ std::string getFileName(const std::string filename) {
     return res;
 }
 
+// -fprofile-generate[=path] and -fprofile-use[=path]; path is empty when it was left out
+bool parseProfileOption(const std::string& arg, const std::string& flag, std::string& path) {
+    if (arg == flag) return true;
+    if (arg.compare(0, flag.size() + 1, flag + "=") != 0) return false;
+    path = arg.substr(flag.size() + 1);
+    return true;
+}
+
 int main(int argc, char *argv[]) {
     std::string option = "";
     std::string sourceCode;
     std::string filename = "";
+    std::string sourceCodeFilepath = "";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--lex" || arg == "--parse" || arg == "--tacky" || arg == "--codegen" || arg == "--emit") {
+            option = arg;
+        } else if (parseProfileOption(arg, "-fprofile-generate", profilePath)) {
+            profileMode = ProfileMode::GENERATE;
+        } else if (parseProfileOption(arg, "-fprofile-use", profilePath)) {
+            profileMode = ProfileMode::USE;
+        } else if (arg.compare(0, 7, "-mtune=") == 0 && selectTuneTarget(arg.substr(7))) {
+            continue;
+        } else if (selectOptLevel(arg)) {
+            continue;
+        } else if (arg.compare(0, 7, "-fpass=") == 0 && addPassOverrides(arg.substr(7))) {
+            continue;
+        } else if (arg.compare(0, 17, "-fcompile-budget=") == 0 && selectCompileBudget(arg.substr(17))) {
+            continue;
+        } else if (arg == "-fpass-stats") {
+            printPassStats = true;
+        } else if (arg == "-fegraph") {
+            addPassOverrides("egraph");
+        } else if (arg == "-fno-superopt-rules") {
+            useSuperoptRules = false;
+        } else if (arg[0] != '-' && sourceCodeFilepath.empty()) {
+            sourceCodeFilepath = arg;
+        } else {
+            std::cout << "Invalid options." << std::endl;
+            return 1;
+        }
+    }
 
     // Case 1: Read from stdin (no filepath argument)
-    if (argc == 1) {
+    if (sourceCodeFilepath.empty()) {
         std::ostringstream ss;
         ss << std::cin.rdbuf();  // read all of stdin into string
         sourceCode = ss.str();
     }
-    // Case 2: Filepath only or with option
-    else if (argc == 2 || argc == 3) {
-        std::string sourceCodeFilepath = argv[1];
-
-        if (argc == 3) {
-            option = argv[2];
-            if (option != "--lex" && option != "--parse" && option != "--tacky" && option != "--codegen" && option != "--emit") {
-                std::cout << "Invalid options." << std::endl;
-                return 1;
-            }
-        }
-
+    // Case 2: Filepath
+    else {
         sourceCode = readFileToString(sourceCodeFilepath);
         filename = getFileName(sourceCodeFilepath);
     }
-    // Too many args
-    else {
-        std::cout << "Too many arguments." << std::endl;
-        return 1;
+
+    if (profileMode != ProfileMode::NONE) {
+        // the instrumented program may run from anywhere, so it gets an absolute path
+        if (profilePath.empty()) profilePath = (filename.empty() ? "a" : filename) + ".profile";
+        profilePath = std::filesystem::absolute(profilePath).string();
+        if (profileMode == ProfileMode::USE && !loadProfile()) {
+            std::cout << "Warning: could not read profile " << profilePath << ", using static heuristics." << std::endl;
+            profileMode = ProfileMode::NONE;
+        }
     }
 
     // --- Compiler pipeline ---
@@ -124,6 +164,7 @@ int main(int argc, char *argv[]) {
     }
 
     auto tacky_ir = generateTacky(ast.get(), nullptr);
+    optimizeTacky(tacky_ir.get());
     if (option == "--tacky") {
         printTacky(tacky_ir.get(), 0);
         return 0;
@@ -131,6 +172,7 @@ int main(int argc, char *argv[]) {
 
     
     auto asm_ir = generateCode(tacky_ir.get());
+    if (printPassStats) printPassStatistics();
     if (option == "--codegen") {
         printIR(asm_ir.get(), 0);
         return 0;
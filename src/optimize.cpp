@@ -0,0 +1,12 @@
+#include "optimize.h"
+#include "pass_manager.h"
+
+// --- TACKY Optimization Pipeline ---
+void optimizeTacky(TackyIRNode* node) {
+    if (!node || node->type != TackyIRNodeType::PROGRAM) return;
+    auto* program = static_cast<TackyIRProgram*>(node);
+    auto* function = static_cast<TackyIRFunction*>(program->function.get());
+    if (!function || !function->instructions) return;
+
+    runTackyPasses(function->instructions.get());
+}
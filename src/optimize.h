@@ -0,0 +1,8 @@
+#ifndef OPTIMIZE_H
+#define OPTIMIZE_H
+
+#include "tacky_ir.h"
+
+void optimizeTacky(TackyIRNode* node);
+
+#endif
@@ -152,14 +152,19 @@ std::unique_ptr<Node> Parser::parseExpression(int minPrec) {
     auto left = parseFactor();
     while ((check(TokenType::ADD) || check(TokenType::NEGATION) || 
             check(TokenType::MULTIPLY) || check(TokenType::DIVIDE) ||
-            check(TokenType::REMAINDER)) || check(TokenType::AND) ||
+            check(TokenType::REMAINDER) || check(TokenType::AND) ||
             check(TokenType::OR) || check(TokenType::EQUAL) ||
             check(TokenType::NOT_EQUAL) || check(TokenType::LESS_THAN) ||
             check(TokenType::LESS_OR_EQUAL) || check(TokenType::GREATER_THAN) ||
-            check(TokenType::GREATER_OR_EQUAL) && getPrecidence(tokens[current].value) >= minPrec) {
-        if (check(TokenType(TokenType::EQUAL))) {
-            valid = valid && match(TokenType(TokenType::EQUAL));
-            auto right = parseExpression(getPrecidence(tokens[current].value));
+            check(TokenType::GREATER_OR_EQUAL) || check(TokenType::ASSIGN)) &&
+            getPrecidence(tokens[current].value) >= minPrec) {
+        if (check(TokenType::ASSIGN)) {
+            // right associative: a = b = c
+            int prec = getPrecidence(tokens[current].value);
+            valid = valid && match(TokenType::ASSIGN);
+            // only a variable can be assigned to
+            valid = valid && left && left->type == NodeType::VAR;
+            auto right = parseExpression(prec);
             left = std::make_unique<AssignmentNode>(std::move(left), std::move(right));
         } else {
             TokenType opType = tokens[current].type;
@@ -214,8 +219,8 @@ std::unique_ptr<Node> Parser::parseDeclaration() {
     }
 
     // Check '='
-    if (check(TokenType::EQUAL)) {
-        valid = valid && match(TokenType::EQUAL);
+    if (check(TokenType::ASSIGN)) {
+        valid = valid && match(TokenType::ASSIGN);
     } else {
         valid = valid && match(TokenType::SEMICOLON);
         return std::make_unique<DeclarationNode>(identifier, nullptr);
@@ -265,6 +270,8 @@ std::unique_ptr<FunctionNode> Parser::parseFunction() {
             return nullptr;
         }
         auto nextBlockItem = parseBlockItem();
+        // once invalid, match() stops consuming tokens
+        if (!valid) return nullptr;
         body->instructions.push_back(std::move(nextBlockItem));
     }
 
@@ -0,0 +1,145 @@
+#include "partial_eval.h"
+#include "tacky_eval.h"
+#include <algorithm>
+#include <map>
+
+// bounds the work done on programs that loop for a long time (or forever)
+static const int evaluationFuel = 1000000;
+
+struct Evaluator {
+    std::map<std::string, int32_t> store;
+
+    bool valueOf(const TackyIRNode* operand, int32_t& value) {
+        if (parseTackyConstant(operand, value)) return true;
+        const std::string* name = tackyVarName(operand);
+        if (!name) return false;
+        auto it = store.find(*name);
+        // reading a variable before it's assigned is indeterminate
+        if (it == store.end()) return false;
+        value = it->second;
+        return true;
+    }
+
+    // Executes a non-terminator; false if the result isn't statically known
+    bool step(const TackyIRNode* instr) {
+        int32_t result;
+        switch (instr->type) {
+            case TackyIRNodeType::COPY: {
+                const auto* copy = static_cast<const TackyIRCopy*>(instr);
+                if (!valueOf(copy->src.get(), result)) return false;
+                store[*tackyVarName(copy->dst.get())] = result;
+                return true;
+            }
+            case TackyIRNodeType::UNARY: {
+                const auto* unary = static_cast<const TackyIRUnary*>(instr);
+                int32_t src;
+                if (!valueOf(unary->src.get(), src) || !evalTackyUnary(unary->op->type, src, result)) return false;
+                store[*tackyVarName(unary->dst.get())] = result;
+                return true;
+            }
+            case TackyIRNodeType::BINARY: {
+                const auto* binary = static_cast<const TackyIRBinary*>(instr);
+                int32_t lhs, rhs;
+                if (!valueOf(binary->src1.get(), lhs) || !valueOf(binary->src2.get(), rhs) ||
+                    !evalTackyBinary(binary->op->type, lhs, rhs, result)) {
+                    return false;
+                }
+                store[*tackyVarName(binary->dst.get())] = result;
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
+};
+
+void passPartialEvaluation(TackyCFG& cfg) {
+    Evaluator evaluator;
+    int block = 0;
+    size_t index = 0;
+    int fuel = evaluationFuel;
+
+    while (fuel-- > 0) {
+        auto& instrs = cfg.blocks[block].instructions;
+        if (index == instrs.size()) {
+            if (cfg.blocks[block].fallthrough == -1) return;
+            block = cfg.blocks[block].fallthrough;
+            index = 0;
+            continue;
+        }
+
+        const TackyIRNode* instr = instrs[index].get();
+        if (instr->type == TackyIRNodeType::RETURN) {
+            int32_t result;
+            if (!evaluator.valueOf(static_cast<const TackyIRReturn*>(instr)->expr.get(), result)) break;
+
+            TackyBasicBlock entry;
+            entry.instructions.push_back(std::make_unique<TackyIRReturn>(
+                std::make_unique<TackyIRConstant>(tackyConstantString(result))));
+            cfg.blocks.clear();
+            cfg.blocks.push_back(std::move(entry));
+            recomputeTackyEdges(cfg);
+            return;
+        }
+
+        if (instr->type == TackyIRNodeType::JUMP) {
+            block = findBlockByLabel(cfg, static_cast<const TackyIRJump*>(instr)->target);
+            index = 0;
+        } else if (instr->type == TackyIRNodeType::JUMP_IF_ZERO || instr->type == TackyIRNodeType::JUMP_IF_NOT_ZERO) {
+            int32_t condition;
+            const TackyIRNode* operand = instr->type == TackyIRNodeType::JUMP_IF_ZERO
+                ? static_cast<const TackyIRJumpIfZero*>(instr)->condition.get()
+                : static_cast<const TackyIRJumpIfNotZero*>(instr)->condition.get();
+            if (!evaluator.valueOf(operand, condition)) break;
+            bool jumps = (instr->type == TackyIRNodeType::JUMP_IF_ZERO) == (condition == 0);
+            // successors[0] is the jump target, the fallthrough comes after it
+            block = jumps ? cfg.blocks[block].successors.front() : cfg.blocks[block].fallthrough;
+            index = 0;
+        } else if (evaluator.step(instr)) {
+            index++;
+        } else {
+            break;
+        }
+        if (block == -1) return;
+    }
+
+    if (block == 0 && index == 0) return;
+
+    // --- Residualize: enter the remaining code with the state computed so far ---
+    // split at the stopping point so other paths into the block still run all of it
+    TackyBasicBlock rest;
+    rest.label = makeBlockLabel();
+    auto& stopped = cfg.blocks[block];
+    std::move(stopped.instructions.begin() + index, stopped.instructions.end(), std::back_inserter(rest.instructions));
+    stopped.instructions.erase(stopped.instructions.begin() + index, stopped.instructions.end());
+    rest.fallthrough = stopped.fallthrough;
+    stopped.fallthrough = static_cast<int>(cfg.blocks.size());
+    std::string restLabel = rest.label;
+    cfg.blocks.push_back(std::move(rest));
+
+    // nothing jumps back to the entry block, so its code is dead once we've started past it
+    auto& entry = cfg.blocks[0];
+    entry.instructions.clear();
+    for (auto& var : evaluator.store) {
+        entry.instructions.push_back(std::make_unique<TackyIRCopy>(
+            std::make_unique<TackyIRConstant>(tackyConstantString(var.second)), std::make_unique<TackyIRVar>(var.first)));
+    }
+    entry.instructions.push_back(std::make_unique<TackyIRJump>(restLabel));
+    entry.fallthrough = -1;
+
+    recomputeTackyEdges(cfg);
+    removeUnreachableBlocks(cfg);
+
+    // unless a loop leads back into it, the remaining code can follow the copies directly
+    int restBlock = findBlockByLabel(cfg, restLabel);
+    if (cfg.blocks[restBlock].predecessors.size() == 1) {
+        auto& merged = cfg.blocks[0];
+        merged.instructions.pop_back();
+        for (auto& instr : cfg.blocks[restBlock].instructions) merged.instructions.push_back(std::move(instr));
+        cfg.blocks[restBlock].instructions.clear();
+        merged.fallthrough = cfg.blocks[restBlock].fallthrough;
+        cfg.blocks[restBlock].fallthrough = -1;
+        recomputeTackyEdges(cfg);
+        removeUnreachableBlocks(cfg);
+    }
+}
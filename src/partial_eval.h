@@ -0,0 +1,12 @@
+#ifndef PARTIAL_EVAL_H
+#define PARTIAL_EVAL_H
+
+#include "tacky_cfg.h"
+
+// Runs the function at compile time until it returns or reaches something that can't be
+// evaluated statically (an uninitialized read or a trapping division). A function that
+// returns collapses to Return(Constant); otherwise the code from the stopping point on is
+// kept, entered with the variables it had computed so far. The CFG must not be in SSA form.
+void passPartialEvaluation(TackyCFG& cfg);
+
+#endif
@@ -0,0 +1,342 @@
+#include "pass_manager.h"
+#include "ssa.h"
+#include "sccp.h"
+#include "gvn.h"
+#include "reassociate.h"
+#include "partial_eval.h"
+#include "value_range.h"
+#include "egraph.h"
+#include "codegen.h"
+#include "regalloc.h"
+#include "stack_forwarding.h"
+#include "peephole.h"
+#include "profile.h"
+#include "block_layout.h"
+#include "scheduler.h"
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+int optLevel = 2;
+double compileBudget = 0;
+bool printPassStats = false;
+
+// lowest -O level for passes that only run through -fpass
+static const int onRequest = 3;
+
+// --- Registered Passes ---
+// Estimated time for n instructions: microsPerInstr * n^growth microseconds. Measured on
+// generated straight-line code with && and || branches; the budget rescales them to the
+// machine it runs on.
+struct PassCost {
+    double microsPerInstr;
+    double growth;
+};
+
+struct TackyPass {
+    const char* name;
+    int level;
+    PassCost cost;
+    bool needsSSA;
+    void (*run)(TackyCFG& cfg);
+};
+
+static const TackyPass tackyPasses[] = {
+    {"partial-eval", 2, {0.05, 1}, false, passPartialEvaluation},
+    {"sccp", 1, {0.04, 1.4}, true, passSCCP},
+    {"value-range", 2, {0.02, 1.4}, true, passValueRange},
+    {"sccp", 2, {0.04, 1.4}, true, passSCCP},
+    {"gvn", 1, {0.07, 1.3}, true, passGVN},
+    // copy propagation above joins per-statement trees, so reassociate afterwards and renumber
+    {"reassociate", 2, {0.05, 1.4}, true, passReassociate},
+    {"egraph", onRequest, {0.7, 1.55}, true, passEqualitySaturation},
+    {"gvn", 2, {0.07, 1.3}, true, passGVN},
+    {"dce", 1, {0.01, 1.5}, true, passDeadCodeElimination},
+};
+
+// Building the CFG and flattening it again, and the way into and out of SSA form
+static const PassCost cfgCost = {0.05, 1};
+static const PassCost ssaCost = {0.2, 1.2};
+static const PassCost outOfSSACost = {0.001, 2.3};
+
+struct AsmPass {
+    const char* name;
+    int level;
+    PassCost cost;
+    bool keepsInstructions; // cached analyses survive the pass
+    void (*run)(AsmIRNode* node, AsmPassState& state);
+};
+
+static const AsmPass asmPasses[] = {
+    {"regalloc", 1, {0.004, 2.1}, false, [](AsmIRNode* node, AsmPassState& state) { passAllocateRegisters(node, state.analyses); }},
+    {"stack-coloring", 2, {0.00002, 2.6}, false, [](AsmIRNode* node, AsmPassState& state) {
+        passColorStackSlots(node, state.analyses, state.pseudoToOffset, state.nextOffset);
+    }},
+    {"stack-slots", 0, {0.12, 1}, true, [](AsmIRNode* node, AsmPassState& state) {
+        passAssignStackSlots(node, state.pseudoToOffset, state.nextOffset);
+    }},
+    {"legalize", 0, {0.2, 1}, false, [](AsmIRNode* node, AsmPassState& state) {
+        passLegalize(node, state.pseudoToOffset, state.nextOffset);
+    }},
+    {"stack-forwarding", 1, {0.03, 1.45}, false, [](AsmIRNode* node, AsmPassState& state) { passForwardStackSlots(node, state.analyses); }},
+    {"peephole", 1, {0.0015, 1.7}, false, [](AsmIRNode* node, AsmPassState&) { passPeephole(node); }},
+    // a no-op unless -fprofile-generate, which has to work at every level
+    {"instrument", 0, {0.01, 1}, false, [](AsmIRNode* node, AsmPassState&) { passInstrumentBranches(node); }},
+    {"layout", 1, {0.0007, 1.6}, false, [](AsmIRNode* node, AsmPassState&) { passLayoutBlocks(node); }},
+    {"schedule", 2, {0.8, 1}, false, [](AsmIRNode* node, AsmPassState&) { passScheduleInstructions(node); }},
+};
+
+// For estimating passes before they run: the fraction of the TACKY function left when it
+// leaves SSA, by -O level, and the AsmIR instructions per TACKY instruction it lowers to
+static const double tackyLeft[] = {1, 0.6, 0.25};
+static const double asmPerTacky = 1.8;
+// Passes above the picked level still run under a budget when they grow no faster than
+// this and fit, so huge functions get the cheap linear passes instead of nothing
+static const double linearGrowth = 1.3;
+
+// --- Pipeline Selection ---
+static std::unordered_map<std::string, bool> overrides;
+
+// The lowest -O level a name is registered at, or -1 when no pass has that name
+static int registeredLevel(const std::string& name) {
+    int level = -1;
+    for (const auto& pass : tackyPasses) {
+        if (name == pass.name && (level == -1 || pass.level < level)) level = pass.level;
+    }
+    for (const auto& pass : asmPasses) {
+        if (name == pass.name && (level == -1 || pass.level < level)) level = pass.level;
+    }
+    return level;
+}
+
+bool selectOptLevel(const std::string& arg) {
+    if (arg != "-O0" && arg != "-O1" && arg != "-O2") return false;
+    optLevel = arg[2] - '0';
+    return true;
+}
+
+bool selectCompileBudget(const std::string& ms) {
+    try {
+        size_t used = 0;
+        double budget = std::stod(ms, &used);
+        if (used != ms.size() || !(budget > 0)) return false;
+        compileBudget = budget;
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+bool addPassOverrides(const std::string& list) {
+    std::istringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        bool enable = item.empty() || item[0] != '-';
+        if (!item.empty() && (item[0] == '+' || item[0] == '-')) item = item.substr(1);
+        int level = registeredLevel(item);
+        if (level == -1 || (level == 0 && !enable)) return false;
+        overrides[item] = enable;
+    }
+    return true;
+}
+
+// Overrides switch every registration of a name; otherwise each one goes by its own level
+static bool runs(const char* name, int level) {
+    auto it = overrides.find(name);
+    if (it != overrides.end()) return it->second;
+    return level <= optLevel;
+}
+
+// --- Statistics and Budget ---
+struct PassStats {
+    std::string name;
+    int runs = 0;
+    size_t instructions = 0;
+    double milliseconds = 0;
+    double estimated = 0; // what the cost model predicted for those runs, unscaled
+};
+
+static std::vector<PassStats> passStats;
+static const auto compileStart = std::chrono::steady_clock::now();
+static int budgetLevel = -1; // the level the budget picked, -1 before one was picked
+static double estimateLeft = 0; // budget left when the level was picked, and its estimate
+static double estimateUsed = 0;
+
+static double elapsedMs() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - compileStart).count();
+}
+
+static double estimateMs(PassCost cost, double instructions) {
+    return cost.microsPerInstr * std::pow(instructions, cost.growth) / 1000;
+}
+
+// How much slower this machine and this code are than the cost models, from every pass
+// that has run so far; 1 until they have taken a millisecond. The models are trusted to
+// be at most twice too pessimistic, since running over the budget is worse than under.
+static double calibration() {
+    double measured = 0, estimated = 0;
+    for (const auto& stats : passStats) {
+        measured += stats.milliseconds;
+        estimated += stats.estimated;
+    }
+    if (measured < 1 || estimated <= 0) return 1;
+    return std::min(16.0, std::max(0.5, measured / estimated));
+}
+
+static PassStats& statsFor(const char* name) {
+    for (auto& stats : passStats) {
+        if (stats.name == name) return stats;
+    }
+    passStats.push_back({name});
+    return passStats.back();
+}
+
+static void timed(const char* name, PassCost cost, size_t instructions, const std::function<void()>& run) {
+    auto start = std::chrono::steady_clock::now();
+    run();
+    PassStats& stats = statsFor(name);
+    stats.runs++;
+    stats.instructions += instructions;
+    stats.milliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    stats.estimated += estimateMs(cost, instructions);
+}
+
+// Under a budget an optional pass only runs while its scaled estimate still fits next to
+// the required passes that are left, which reserve is the estimate of
+static bool fitsBudget(int level, PassCost cost, size_t instructions, double reserve) {
+    if (compileBudget <= 0 || level == 0) return true;
+    return elapsedMs() + (estimateMs(cost, instructions) + reserve) * calibration() <= compileBudget;
+}
+
+static size_t tackySize(const TackyCFG& cfg) {
+    size_t size = 0;
+    for (const auto& block : cfg.blocks) size += block.instructions.size();
+    return size;
+}
+
+static size_t asmSize(AsmIRNode* node) {
+    if (!node || node->type != AsmIRNodeType::PROGRAM) return 0;
+    auto* fn = static_cast<AsmIRProgram*>(node)->function.get();
+    return fn && fn->instructions ? fn->instructions->instructions.size() : 0;
+}
+
+// Estimated time for everything that runs at `level`, for a function of `size` TACKY
+// instructions; only the required AsmIR passes when `level` is 0 and requiredOnly is set
+static double estimateLevel(int level, size_t size, bool requiredOnly = false) {
+    double total = 0;
+    bool ssa = false;
+    if (!requiredOnly) {
+        for (const auto& pass : tackyPasses) {
+            if (!runs(pass.name, pass.level) || pass.level > level) continue;
+            total += estimateMs(pass.cost, size);
+            ssa = ssa || pass.needsSSA;
+        }
+        if (total > 0) total += estimateMs(cfgCost, size);
+        if (ssa) total += estimateMs(ssaCost, size) + estimateMs(outOfSSACost, size * tackyLeft[level]);
+    }
+    size_t asmInstructions = static_cast<size_t>(size * tackyLeft[requiredOnly ? 0 : level] * asmPerTacky);
+    for (const auto& pass : asmPasses) {
+        if (!runs(pass.name, pass.level) || pass.level > (requiredOnly ? 0 : level)) continue;
+        total += estimateMs(pass.cost, asmInstructions);
+    }
+    return total;
+}
+
+// The highest level up to -O whose estimate fits in what is left of the budget
+static void pickBudgetLevel(size_t size) {
+    double left = compileBudget - elapsedMs();
+    budgetLevel = 0;
+    for (int level = optLevel; level > 0; --level) {
+        if (estimateLevel(level, size) * calibration() <= left) {
+            budgetLevel = level;
+            break;
+        }
+    }
+    estimateLeft = left;
+    estimateUsed = estimateLevel(budgetLevel, size);
+}
+
+// Whether a registered pass runs: its name and level, and under a budget the picked level
+static bool scheduled(const char* name, int level, PassCost cost) {
+    if (!runs(name, level)) return false;
+    if (compileBudget <= 0 || budgetLevel == -1 || level <= budgetLevel || overrides.count(name)) return true;
+    return cost.growth <= linearGrowth;
+}
+
+void printPassStatistics() {
+    if (compileBudget > 0 && budgetLevel != -1) {
+        std::cout << "budget " << compileBudget << " ms: picked -O" << budgetLevel << ", estimated "
+                  << std::fixed << std::setprecision(3) << estimateUsed << " ms of " << estimateLeft << " ms left\n";
+    }
+    std::cout << std::left << std::setw(18) << "pass" << std::right << std::setw(6) << "runs" << std::setw(10) << "instrs"
+              << std::setw(12) << "ms" << std::setw(12) << "estimate" << "\n";
+    for (const auto& stats : passStats) {
+        std::cout << std::left << std::setw(18) << stats.name << std::right << std::setw(6) << stats.runs
+                  << std::setw(10) << stats.instructions << std::fixed << std::setprecision(3)
+                  << std::setw(12) << stats.milliseconds << std::setw(12) << stats.estimated << "\n";
+    }
+    std::cout << "total " << std::fixed << std::setprecision(3) << elapsedMs() << " ms since start" << std::endl;
+}
+
+// --- Running Pipelines ---
+void runTackyPasses(TackyIRInstructions* instructions) {
+    size_t size = instructions->instructions.size();
+    if (compileBudget > 0) pickBudgetLevel(size);
+
+    // A pass fits next to the required AsmIR passes, the CFG round trip, and getting into
+    // and out of SSA when it is the first pass that needs it
+    double asmReserve = estimateLevel(0, size, true);
+    bool inSSA = false;
+    auto fits = [&](const TackyPass& pass) {
+        double reserve = asmReserve + estimateMs(cfgCost, size);
+        if (pass.needsSSA && !inSSA) reserve += estimateMs(ssaCost, size);
+        if (pass.needsSSA || inSSA) reserve += estimateMs(outOfSSACost, size);
+        return fitsBudget(pass.level, pass.cost, size, reserve);
+    };
+
+    // the CFG isn't worth building when no pass is going to run on it
+    bool any = false;
+    for (const auto& pass : tackyPasses) {
+        any = any || (scheduled(pass.name, pass.level, pass.cost) && fits(pass));
+    }
+    if (!any) return;
+
+    TackyCFG cfg;
+    timed("cfg", cfgCost, size, [&] { cfg = buildTackyCFG(instructions); });
+    for (const auto& pass : tackyPasses) {
+        if (!scheduled(pass.name, pass.level, pass.cost)) continue;
+        size = tackySize(cfg);
+        if (!fits(pass)) continue;
+
+        if (pass.needsSSA && !inSSA) {
+            timed("ssa", ssaCost, size, [&] { buildSSA(cfg); });
+            inSSA = true;
+        }
+        timed(pass.name, pass.cost, size, [&] { pass.run(cfg); });
+    }
+    size = tackySize(cfg);
+    if (inSSA) timed("out-of-ssa", outOfSSACost, size, [&] { destructSSA(cfg); });
+    timed("cfg", cfgCost, size, [&] { flattenTackyCFG(cfg, instructions); });
+}
+
+void runAsmPasses(AsmIRNode* node) {
+    AsmPassState state;
+    for (size_t i = 0; i < std::size(asmPasses); ++i) {
+        const AsmPass& pass = asmPasses[i];
+        if (!scheduled(pass.name, pass.level, pass.cost)) continue;
+        size_t size = asmSize(node);
+        double reserve = 0;
+        for (size_t j = i + 1; j < std::size(asmPasses); ++j) {
+            if (asmPasses[j].level == 0) reserve += estimateMs(asmPasses[j].cost, size);
+        }
+        if (!fitsBudget(pass.level, pass.cost, size, reserve)) continue;
+
+        timed(pass.name, pass.cost, size, [&] { pass.run(node, state); });
+        if (!pass.keepsInstructions) state.analyses.invalidate();
+    }
+}
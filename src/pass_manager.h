@@ -0,0 +1,53 @@
+#ifndef PASS_MANAGER_H
+#define PASS_MANAGER_H
+
+#include "tacky_cfg.h"
+#include "asm_ir.h"
+#include "asm_liveness.h"
+#include <string>
+#include <unordered_map>
+
+/*
+    The TACKY and AsmIR passes, registered by name in pipeline order. Every pass has the
+    lowest -O level it runs at: level 0 passes are required and always run, -O1 adds the
+    cheap ones, -O2 (the default) adds the rest, and a few only run when asked for with
+    -fpass. Analyses live with the IR they describe, in TackyCFG::analyses and
+    AsmPassState::analyses, so a pass reuses whatever the passes before it left valid.
+
+        -fpass=-gvn,+egraph     drop every gvn run, add equality saturation
+
+    With -fcompile-budget=<ms> the level is picked per function instead: each pass has a
+    cost model in instructions, the function's TACKY size gives the cost of each level,
+    and the highest level that fits what is left of the budget runs (never above -O),
+    plus whichever passes above it grow linearly and still fit. The passes that have run
+    so far scale the models to the machine, and an optional pass whose scaled estimate
+    no longer fits is skipped. Required passes always run.
+*/
+extern int optLevel;
+extern double compileBudget; // milliseconds, 0 for no budget
+extern bool printPassStats;
+
+// State the AsmIR passes share: cached analyses and the frame slots handed from slot
+// assignment to legalization
+struct AsmPassState {
+    AsmAnalyses analyses;
+    std::unordered_map<int64_t, int> pseudoToOffset;
+    int nextOffset = -4;
+};
+
+// -O0, -O1 or -O2; false for anything else
+bool selectOptLevel(const std::string& arg);
+// The <ms> of -fcompile-budget=<ms>; false unless it is a positive number
+bool selectCompileBudget(const std::string& ms);
+// A comma-separated list of pass names, each optionally prefixed with + or -. False when
+// a name is unknown or a required pass would be dropped. Overrides win over -O.
+bool addPassOverrides(const std::string& list);
+
+// Runs the enabled TACKY passes over a function body. The CFG is only built when one is
+// enabled, and SSA form only when one needs it.
+void runTackyPasses(TackyIRInstructions* instructions);
+void runAsmPasses(AsmIRNode* node);
+// -fpass-stats: runs, instructions seen, time and estimated time per pass
+void printPassStatistics();
+
+#endif
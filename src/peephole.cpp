@@ -0,0 +1,319 @@
+#include "peephole.h"
+#include "asm_liveness.h"
+#include "superopt_rules.h"
+#include <algorithm>
+#include <iterator>
+
+using AsmInstructions = std::vector<std::unique_ptr<AsmIRNode>>;
+
+// --- Operand Helpers ---
+static bool isRegister(const AsmIROperand& operand) {
+    return operand.type == AsmIRNodeType::REGISTER;
+}
+
+static bool isMemory(const AsmIROperand& operand) {
+    return operand.type == AsmIRNodeType::STACK;
+}
+
+static bool isImmediate(const AsmIROperand& operand, int64_t value) {
+    return operand.type == AsmIRNodeType::IMMEDIATE && operand.value == value;
+}
+
+// --- Deadness Queries ---
+// Both scan forward along the fallthrough path and answer conservatively at jumps.
+static bool flagsDeadAfter(const AsmInstructions& instrs, size_t index) {
+    for (size_t i = index + 1; i < instrs.size(); ++i) {
+        const AsmIRNode* instr = instrs[i].get();
+        if (asmReadsFlags(instr)) return false;
+        if (asmWritesFlags(instr) || instr->type == AsmIRNodeType::RETURN) return true;
+        if (instr->type == AsmIRNodeType::JMP) return false;
+    }
+    return true;
+}
+
+static bool registerDeadAfter(const AsmInstructions& instrs, size_t index, const AsmIROperand& reg) {
+    for (size_t i = index + 1; i < instrs.size(); ++i) {
+        AsmIRNode* instr = instrs[i].get();
+        for (auto* use : asmUses(instr)) {
+            if (*use == reg) return false;
+        }
+        auto implicitUses = asmImplicitUses(instr);
+        if (std::find(implicitUses.begin(), implicitUses.end(), reg.reg) != implicitUses.end()) return false;
+
+        for (auto* def : asmDefinitions(instr)) {
+            if (*def == reg) return true;
+        }
+        auto implicitDefs = asmImplicitDefinitions(instr);
+        if (std::find(implicitDefs.begin(), implicitDefs.end(), reg.reg) != implicitDefs.end()) return true;
+
+        if (instr->type == AsmIRNodeType::RETURN) return true;
+        if (instr->type == AsmIRNodeType::JMP || instr->type == AsmIRNodeType::JMP_CC) return false;
+    }
+    return true;
+}
+
+// --- Rule Table ---
+struct PeepholeWindow {
+    AsmInstructions& instrs;
+    size_t start;
+
+    template <typename T>
+    T* at(size_t offset) const { return static_cast<T*>(instrs[start + offset].get()); }
+};
+
+struct PeepholeRule {
+    const char* name;
+    std::vector<AsmIRNodeType> pattern;
+    bool (*matches)(const PeepholeWindow& window);
+    AsmInstructions (*rewrite)(const PeepholeWindow& window); // may move instructions out of the window
+};
+
+static const AsmIROperand& compareOperand(const AsmIRNode* instr, int which) {
+    if (instr->type == AsmIRNodeType::CMP)
+        return which == 1 ? static_cast<const AsmIRCmp*>(instr)->operand1 : static_cast<const AsmIRCmp*>(instr)->operand2;
+    return which == 1 ? static_cast<const AsmIRTest*>(instr)->operand1 : static_cast<const AsmIRTest*>(instr)->operand2;
+}
+
+// mov x, x
+static bool matchSelfMove(const PeepholeWindow& w) {
+    auto* move = w.at<AsmIRMov>(0);
+    return move->src == move->dst;
+}
+static AsmInstructions rewriteSelfMove(const PeepholeWindow&) {
+    return {};
+}
+
+// mov a, r; mov r, a  =>  mov a, r
+static bool matchMoveBack(const PeepholeWindow& w) {
+    auto* first = w.at<AsmIRMov>(0);
+    auto* second = w.at<AsmIRMov>(1);
+    return first->dst == second->src && first->src == second->dst;
+}
+static AsmInstructions rewriteMoveBack(const PeepholeWindow& w) {
+    AsmInstructions out;
+    out.push_back(std::move(w.instrs[w.start]));
+    return out;
+}
+
+// mov a, r; mov r, b  =>  mov a, b  when r is dead afterwards
+static bool matchMoveChain(const PeepholeWindow& w) {
+    auto* first = w.at<AsmIRMov>(0);
+    auto* second = w.at<AsmIRMov>(1);
+    return isRegister(first->dst) && first->dst == second->src &&
+           !(isMemory(first->src) && isMemory(second->dst)) &&
+           registerDeadAfter(w.instrs, w.start + 1, first->dst);
+}
+static AsmInstructions rewriteMoveChain(const PeepholeWindow& w) {
+    AsmInstructions out;
+    out.push_back(std::make_unique<AsmIRMov>(w.at<AsmIRMov>(0)->src, w.at<AsmIRMov>(1)->dst));
+    return out;
+}
+
+// cmp a, b; setcc r; movzbl r, r  =>  xor r, r; cmp a, b; setcc r
+// The xor breaks setcc's dependency on the old value of r.
+static bool matchZeroBeforeCompare(const PeepholeWindow& w) {
+    auto* setCC = w.at<AsmIRSetCC>(1);
+    auto* extend = w.at<AsmIRMovZeroExtend>(2);
+    const AsmIRNode* compare = w.instrs[w.start].get();
+    return isRegister(setCC->operand) && setCC->operand == extend->src && setCC->operand == extend->dst &&
+           setCC->operand != compareOperand(compare, 1) && setCC->operand != compareOperand(compare, 2);
+}
+static AsmInstructions rewriteZeroBeforeCompare(const PeepholeWindow& w) {
+    auto* setCC = w.at<AsmIRSetCC>(1);
+    AsmInstructions out;
+    out.push_back(std::make_unique<AsmIRBinary>(AsmIRNodeType::XOR, setCC->operand, setCC->operand));
+    out.push_back(std::move(w.instrs[w.start]));
+    out.push_back(std::move(w.instrs[w.start + 1]));
+    return out;
+}
+
+// mov $0, r  =>  xor r, r  when nothing reads the flags it clobbers
+static bool matchZeroIdiom(const PeepholeWindow& w) {
+    auto* move = w.at<AsmIRMov>(0);
+    return isImmediate(move->src, 0) && isRegister(move->dst) && flagsDeadAfter(w.instrs, w.start);
+}
+static AsmInstructions rewriteZeroIdiom(const PeepholeWindow& w) {
+    auto* move = w.at<AsmIRMov>(0);
+    AsmInstructions out;
+    out.push_back(std::make_unique<AsmIRBinary>(AsmIRNodeType::XOR, move->dst, move->dst));
+    return out;
+}
+
+// cmp $0, r  =>  test r, r  (same flags for every condition code)
+static bool matchCompareZero(const PeepholeWindow& w) {
+    auto* cmp = w.at<AsmIRCmp>(0);
+    return isImmediate(cmp->operand1, 0) && isRegister(cmp->operand2);
+}
+static AsmInstructions rewriteCompareZero(const PeepholeWindow& w) {
+    auto* cmp = w.at<AsmIRCmp>(0);
+    AsmInstructions out;
+    out.push_back(std::make_unique<AsmIRTest>(cmp->operand2, cmp->operand2));
+    return out;
+}
+
+// Tried in order at every position; the first rule that matches wins.
+static const std::vector<PeepholeRule> peepholeRules = {
+    {"self-move", {AsmIRNodeType::MOV}, matchSelfMove, rewriteSelfMove},
+    {"move-back", {AsmIRNodeType::MOV, AsmIRNodeType::MOV}, matchMoveBack, rewriteMoveBack},
+    {"move-chain", {AsmIRNodeType::MOV, AsmIRNodeType::MOV}, matchMoveChain, rewriteMoveChain},
+    {"zero-before-cmp", {AsmIRNodeType::CMP, AsmIRNodeType::SET_CC, AsmIRNodeType::MOVZX}, matchZeroBeforeCompare, rewriteZeroBeforeCompare},
+    {"zero-before-test", {AsmIRNodeType::TEST, AsmIRNodeType::SET_CC, AsmIRNodeType::MOVZX}, matchZeroBeforeCompare, rewriteZeroBeforeCompare},
+    {"zero-idiom", {AsmIRNodeType::MOV}, matchZeroIdiom, rewriteZeroIdiom},
+    {"cmp-zero-test", {AsmIRNodeType::CMP}, matchCompareZero, rewriteCompareZero},
+};
+
+// --- Superoptimizer Rules ---
+/*
+    superopt_rules.h is generated by tools/superopt.cpp and holds windows with a cheaper
+    equivalent, proven equal at 32 bits. A rule's slots bind to distinct registers, so
+    stack operands never match, and they're only tried once no hand-written rule applies.
+*/
+bool useSuperoptRules = true;
+
+static AsmIRNodeType opcodeOf(const AsmIRNode* instr) {
+    if (instr->type == AsmIRNodeType::UNARY) return static_cast<const AsmIRUnary*>(instr)->unary_operator;
+    if (instr->type == AsmIRNodeType::BINARY) return static_cast<const AsmIRBinary*>(instr)->binary_operator;
+    return instr->type;
+}
+
+struct SlotBinding {
+    AsmIROperand slots[3];
+
+    bool match(int8_t slot, int32_t imm, const AsmIROperand& operand) {
+        if (slot == SUPEROPT_NONE) return !operand;
+        if (slot == SUPEROPT_IMMEDIATE) return isImmediate(operand, imm);
+        if (!isRegister(operand)) return false;
+        if (slots[slot]) return slots[slot] == operand;
+        for (const auto& other : slots) {
+            if (other == operand) return false;
+        }
+        slots[slot] = operand;
+        return true;
+    }
+
+    AsmIROperand operand(int8_t slot, int32_t imm) const {
+        if (slot == SUPEROPT_NONE) return {};
+        return slot == SUPEROPT_IMMEDIATE ? asmImm(imm) : slots[slot];
+    }
+};
+
+static bool isShift(AsmIRNodeType op) {
+    return op == AsmIRNodeType::SHL || op == AsmIRNodeType::SAR || op == AsmIRNodeType::SHR;
+}
+
+static bool matchSuperoptInstr(const SuperoptInstr& pattern, const AsmIRNode* instr, SlotBinding& binding) {
+    if (opcodeOf(instr) != pattern.op) return false;
+    switch (instr->type) {
+        case AsmIRNodeType::MOV: {
+            auto* move = static_cast<const AsmIRMov*>(instr);
+            return binding.match(pattern.src, pattern.imm, move->src) && binding.match(pattern.dst, 0, move->dst);
+        }
+        case AsmIRNodeType::MOVZX: {
+            auto* extend = static_cast<const AsmIRMovZeroExtend*>(instr);
+            return binding.match(pattern.src, 0, extend->src) && binding.match(pattern.dst, 0, extend->dst);
+        }
+        case AsmIRNodeType::UNARY:
+            return binding.match(pattern.dst, 0, static_cast<const AsmIRUnary*>(instr)->operand);
+        case AsmIRNodeType::BINARY: {
+            auto* binary = static_cast<const AsmIRBinary*>(instr);
+            int8_t src = isShift(pattern.op) ? SUPEROPT_IMMEDIATE : pattern.src;
+            return binding.match(src, pattern.imm, binary->operand1) && binding.match(pattern.dst, 0, binary->operand2);
+        }
+        case AsmIRNodeType::CMP:
+        case AsmIRNodeType::TEST:
+            return binding.match(pattern.src, pattern.imm, compareOperand(instr, 1)) && binding.match(pattern.dst, 0, compareOperand(instr, 2));
+        case AsmIRNodeType::SET_CC: {
+            auto* setCC = static_cast<const AsmIRSetCC*>(instr);
+            return setCC->cond_code == pattern.cond && binding.match(pattern.dst, 0, setCC->operand);
+        }
+        case AsmIRNodeType::LEA: {
+            auto* lea = static_cast<const AsmIRLea*>(instr);
+            return lea->displacement == pattern.imm && (!lea->index || lea->scale == pattern.scale) &&
+                   binding.match(pattern.src, 0, lea->base) && binding.match(pattern.index, 0, lea->index) &&
+                   binding.match(pattern.dst, 0, lea->dst);
+        }
+        default:
+            return false;
+    }
+}
+
+static std::unique_ptr<AsmIRNode> buildSuperoptInstr(const SuperoptInstr& pattern, const SlotBinding& binding) {
+    AsmIROperand src = binding.operand(pattern.src, pattern.imm);
+    AsmIROperand dst = binding.operand(pattern.dst, 0);
+    switch (pattern.op) {
+        case AsmIRNodeType::MOV: return std::make_unique<AsmIRMov>(src, dst);
+        case AsmIRNodeType::MOVZX: return std::make_unique<AsmIRMovZeroExtend>(src, dst);
+        case AsmIRNodeType::NEG:
+        case AsmIRNodeType::NOT:
+            return std::make_unique<AsmIRUnary>(pattern.op, dst);
+        case AsmIRNodeType::CMP: return std::make_unique<AsmIRCmp>(src, dst);
+        case AsmIRNodeType::TEST: return std::make_unique<AsmIRTest>(src, dst);
+        case AsmIRNodeType::SET_CC: return std::make_unique<AsmIRSetCC>(pattern.cond, dst);
+        case AsmIRNodeType::LEA:
+            return std::make_unique<AsmIRLea>(binding.operand(pattern.src, 0), binding.operand(pattern.index, 0), pattern.scale, pattern.imm, dst);
+        default:
+            return std::make_unique<AsmIRBinary>(pattern.op, isShift(pattern.op) ? asmImm(pattern.imm) : src, dst);
+    }
+}
+
+static bool applySuperoptRule(AsmInstructions& instrs, size_t i) {
+    for (const auto& rule : superoptRules) {
+        size_t length = static_cast<size_t>(rule.sourceLength);
+        if (i + length > instrs.size() || opcodeOf(instrs[i].get()) != rule.source[0].op) continue;
+        SlotBinding binding;
+        bool matches = true;
+        for (size_t k = 0; k < length && matches; ++k) matches = matchSuperoptInstr(rule.source[k], instrs[i + k].get(), binding);
+        if (!matches || (rule.clobbersFlags && !flagsDeadAfter(instrs, i + length - 1))) continue;
+
+        AsmInstructions replacement;
+        for (int k = 0; k < rule.replacementLength; ++k) replacement.push_back(buildSuperoptInstr(rule.replacement[k], binding));
+        instrs.erase(instrs.begin() + i, instrs.begin() + i + length);
+        instrs.insert(instrs.begin() + i, std::make_move_iterator(replacement.begin()), std::make_move_iterator(replacement.end()));
+        return true;
+    }
+    return false;
+}
+
+static bool applyRules(AsmInstructions& instrs) {
+    size_t longest = 0;
+    for (const auto& rule : peepholeRules) longest = std::max(longest, rule.pattern.size());
+    for (const auto& rule : superoptRules) longest = std::max(longest, static_cast<size_t>(rule.sourceLength));
+
+    bool changed = false;
+    size_t i = 0;
+    while (i < instrs.size()) {
+        bool applied = false;
+        for (const auto& rule : peepholeRules) {
+            size_t length = rule.pattern.size();
+            if (i + length > instrs.size()) continue;
+            bool typesMatch = true;
+            for (size_t k = 0; k < length && typesMatch; ++k) typesMatch = instrs[i + k]->type == rule.pattern[k];
+            PeepholeWindow window{instrs, i};
+            if (!typesMatch || !rule.matches(window)) continue;
+
+            AsmInstructions replacement = rule.rewrite(window);
+            instrs.erase(instrs.begin() + i, instrs.begin() + i + length);
+            instrs.insert(instrs.begin() + i, std::make_move_iterator(replacement.begin()), std::make_move_iterator(replacement.end()));
+            applied = true;
+            break;
+        }
+        if (!applied && useSuperoptRules) applied = applySuperoptRule(instrs, i);
+
+        if (applied) {
+            // the rewrite may complete a pattern that starts a little earlier
+            changed = true;
+            i = i >= longest ? i - longest + 1 : 0;
+        } else {
+            i++;
+        }
+    }
+    return changed;
+}
+
+void passPeephole(AsmIRNode* node) {
+    if (!node || node->type != AsmIRNodeType::PROGRAM) return;
+    auto* fn = static_cast<AsmIRProgram*>(node)->function.get();
+    if (!fn || !fn->instructions) return;
+
+    while (applyRules(fn->instructions->instructions)) {}
+}
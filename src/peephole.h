@@ -0,0 +1,14 @@
+#ifndef PEEPHOLE_H
+#define PEEPHOLE_H
+
+#include "asm_ir.h"
+
+// Rewrites short instruction windows using the rule table in peephole.cpp. Runs on the
+// final instruction stream, after passLegalize.
+void passPeephole(AsmIRNode* node);
+
+// Cleared by -fno-superopt-rules, which leaves only the hand-written rules; the sample corpus
+// for tools/superopt.cpp is compiled that way so it doesn't depend on the rules it produces
+extern bool useSuperoptRules;
+
+#endif
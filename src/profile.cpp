@@ -0,0 +1,91 @@
+#include "profile.h"
+#include "tacky_cfg.h"
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+ProfileMode profileMode = ProfileMode::NONE;
+std::string profilePath;
+std::vector<std::string> profileSites;
+
+static std::unordered_map<std::string, BranchCounts> profile;
+
+// --- Reading ---
+bool loadProfile() {
+    std::ifstream in(profilePath);
+    if (!in) return false;
+    profile.clear();
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string site;
+        BranchCounts counts;
+        if (!(fields >> site >> counts.taken >> counts.notTaken)) return false;
+        // a site seen by several runs adds up
+        profile[site].taken += counts.taken;
+        profile[site].notTaken += counts.notTaken;
+    }
+    return true;
+}
+
+const BranchCounts* profileCounts(const std::string& site) {
+    auto it = profile.find(site);
+    return it == profile.end() ? nullptr : &it->second;
+}
+
+// --- Sites ---
+std::string branchSiteKey(const std::string& target, int ordinal) {
+    return target + "/" + std::to_string(ordinal);
+}
+
+std::vector<std::string> branchSiteKeys(const std::vector<std::unique_ptr<AsmIRNode>>& instrs) {
+    std::vector<std::string> keys(instrs.size());
+    std::unordered_map<std::string, int> jumpsTo;
+    for (size_t i = 0; i < instrs.size(); ++i) {
+        if (instrs[i]->type != AsmIRNodeType::JMP_CC) continue;
+        const std::string& target = static_cast<const AsmIRJmpCC*>(instrs[i].get())->identifier;
+        keys[i] = branchSiteKey(target, jumpsTo[target]++);
+    }
+    return keys;
+}
+
+// --- Instrumentation ---
+/*
+    JmpCC(cc, target)           JmpCC(cc, stub)
+    ...                   ->    CountEdge(2k + 1)
+                                ...
+                                Label(stub)           -- after the last instruction
+                                CountEdge(2k)
+                                Jmp(target)
+*/
+void passInstrumentBranches(AsmIRNode* node) {
+    if (profileMode != ProfileMode::GENERATE) return;
+    if (!node || node->type != AsmIRNodeType::PROGRAM) return;
+    auto* fn = static_cast<AsmIRProgram*>(node)->function.get();
+    if (!fn || !fn->instructions) return;
+    auto& instrs = fn->instructions->instructions;
+
+    std::vector<std::string> keys = branchSiteKeys(instrs);
+    std::vector<std::unique_ptr<AsmIRNode>> instrumented, stubs;
+    instrumented.reserve(instrs.size() * 2);
+    for (size_t i = 0; i < instrs.size(); ++i) {
+        if (keys[i].empty()) {
+            instrumented.push_back(std::move(instrs[i]));
+            continue;
+        }
+        int site = static_cast<int>(profileSites.size());
+        profileSites.push_back(keys[i]);
+
+        auto* jump = static_cast<AsmIRJmpCC*>(instrs[i].get());
+        std::string stub = makeBlockLabel();
+        stubs.push_back(std::make_unique<AsmIRLabel>(stub));
+        stubs.push_back(std::make_unique<AsmIRCountEdge>(2 * site));
+        stubs.push_back(std::make_unique<AsmIRJmp>(jump->identifier));
+        jump->identifier = stub;
+
+        instrumented.push_back(std::move(instrs[i]));
+        instrumented.push_back(std::make_unique<AsmIRCountEdge>(2 * site + 1));
+    }
+    for (auto& stub : stubs) instrumented.push_back(std::move(stub));
+    instrs = std::move(instrumented);
+}
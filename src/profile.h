@@ -0,0 +1,42 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "asm_ir.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+    Profile-guided optimization. -fprofile-generate instruments every conditional jump
+    with a taken and a not-taken counter; the program writes them to profilePath when it
+    exits, one "site taken not-taken" line per jump. -fprofile-use reads that file back
+    and the counts replace the static guesses in block layout and in the branchy vs.
+    branchless choice for && and ||.
+
+    A site is the jump's target label plus its position among the jumps to that label,
+    taken before block layout moves anything, so both builds name the same jump the same way.
+*/
+enum class ProfileMode { NONE, GENERATE, USE };
+
+struct BranchCounts {
+    uint64_t taken = 0;
+    uint64_t notTaken = 0;
+};
+
+extern ProfileMode profileMode;
+extern std::string profilePath;
+extern std::vector<std::string> profileSites; // instrumented sites, counter 2k/2k+1 belong to profileSites[k]
+
+// False when the file can't be read; the static heuristics are used then
+bool loadProfile();
+// Counts for a site, or nullptr when the profile never saw it
+const BranchCounts* profileCounts(const std::string& site);
+
+std::string branchSiteKey(const std::string& target, int ordinal);
+// The site of every conditional jump in instrs, empty for all other instructions
+std::vector<std::string> branchSiteKeys(const std::vector<std::unique_ptr<AsmIRNode>>& instrs);
+
+// Adds the edge counters. Runs before passLayoutBlocks so the sites match a -fprofile-use build.
+void passInstrumentBranches(AsmIRNode* node);
+
+#endif
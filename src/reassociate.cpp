@@ -0,0 +1,285 @@
+#include "reassociate.h"
+#include "generate_tacky.h"
+#include "tacky_eval.h"
+#include <iostream>
+#include <algorithm>
+#include <queue>
+
+/*
+    x86 addl/subl/imull wrap, so + and * are associative and commutative on
+    the values the emitted code computes. Regrouping a tree of them therefore
+    yields bit-identical results even where the C source would overflow.
+*/
+
+enum class Family { NONE, ADDITIVE, MULTIPLICATIVE };
+
+static Family familyOf(const TackyIRNode* instr) {
+    if (instr->type == TackyIRNodeType::BINARY) {
+        TackyIRNodeType op = static_cast<const TackyIRBinary*>(instr)->op->type;
+        if (op == TackyIRNodeType::ADD || op == TackyIRNodeType::SUBTRACT) return Family::ADDITIVE;
+        if (op == TackyIRNodeType::MULTIPLY) return Family::MULTIPLICATIVE;
+    } else if (instr->type == TackyIRNodeType::UNARY &&
+               static_cast<const TackyIRUnary*>(instr)->op->type == TackyIRNodeType::NEGATE) {
+        return Family::ADDITIVE;
+    }
+    return Family::NONE;
+}
+
+struct Leaf {
+    std::string name;
+    bool negative;
+    int depth;
+};
+
+struct Tree {
+    std::vector<Leaf> leaves;
+    uint32_t constant;
+    int constantCount = 0;
+    std::vector<size_t> interiors;
+};
+
+enum class Role { FREE, DELETED, KEPT };
+
+struct BlockReassociator {
+    std::vector<std::unique_ptr<TackyIRNode>>& instrs;
+    std::unordered_map<std::string, int>& useCount;
+    std::unordered_map<std::string, size_t> defIndex;
+    std::unordered_map<std::string, int> depth;
+    std::vector<Role> roles;
+
+    BlockReassociator(std::vector<std::unique_ptr<TackyIRNode>>& instrs, std::unordered_map<std::string, int>& useCount)
+        : instrs(instrs), useCount(useCount), roles(instrs.size(), Role::FREE) {
+        for (size_t i = 0; i < instrs.size(); ++i) {
+            int d = 0;
+            for (auto* use : tackyUses(instrs[i].get())) {
+                const std::string* name = tackyVarName(use->get());
+                if (name && depth.count(*name)) d = std::max(d, depth[*name]);
+            }
+            auto* dst = tackyDestination(instrs[i].get());
+            if (dst) {
+                const std::string& name = *tackyVarName(dst->get());
+                defIndex[name] = i;
+                depth[name] = instrs[i]->type == TackyIRNodeType::COPY ? d : d + 1;
+            }
+        }
+    }
+
+    int depthOf(const std::string& name) {
+        auto it = depth.find(name);
+        return it == depth.end() ? 0 : it->second;
+    }
+
+    void gatherOperand(const TackyIRNode* operand, bool negative, Family family, Tree& tree) {
+        int32_t constant;
+        if (parseTackyConstant(operand, constant)) {
+            uint32_t value = static_cast<uint32_t>(constant);
+            if (family == Family::ADDITIVE) tree.constant += negative ? 0u - value : value;
+            else tree.constant *= value;
+            tree.constantCount++;
+            return;
+        }
+
+        const std::string& name = *tackyVarName(operand);
+        auto it = defIndex.find(name);
+        if (it != defIndex.end() && roles[it->second] == Role::FREE && useCount[name] == 1 &&
+            familyOf(instrs[it->second].get()) == family) {
+            tree.interiors.push_back(it->second);
+            gatherInstruction(instrs[it->second].get(), negative, family, tree);
+            return;
+        }
+        tree.leaves.push_back({name, negative, depthOf(name)});
+    }
+
+    void gatherInstruction(const TackyIRNode* instr, bool negative, Family family, Tree& tree) {
+        if (instr->type == TackyIRNodeType::UNARY) {
+            gatherOperand(static_cast<const TackyIRUnary*>(instr)->src.get(), !negative, family, tree);
+            return;
+        }
+        const auto* binary = static_cast<const TackyIRBinary*>(instr);
+        gatherOperand(binary->src1.get(), negative, family, tree);
+        bool flip = binary->op->type == TackyIRNodeType::SUBTRACT;
+        gatherOperand(binary->src2.get(), flip ? !negative : negative, family, tree);
+    }
+
+    // Combines the two shallowest operands first, which minimizes the depth of the result (Huffman-style)
+    std::pair<std::unique_ptr<TackyIRNode>, int> combine(std::vector<Leaf> leaves, TackyIRNodeType op,
+                                                         std::vector<std::unique_ptr<TackyIRNode>>& out) {
+        using Item = std::pair<int, std::string>;
+        std::priority_queue<Item, std::vector<Item>, std::greater<Item>> queue;
+        for (auto& leaf : leaves) queue.push({leaf.depth, leaf.name});
+
+        while (queue.size() > 1) {
+            Item a = queue.top();
+            queue.pop();
+            Item b = queue.top();
+            queue.pop();
+            std::string temp = makeTemporary();
+            out.push_back(std::make_unique<TackyIRBinary>(
+                op == TackyIRNodeType::ADD ? std::unique_ptr<TackyIRNode>(std::make_unique<TackyIRAdd>())
+                                           : std::unique_ptr<TackyIRNode>(std::make_unique<TackyIRMultiply>()),
+                std::make_unique<TackyIRVar>(a.second),
+                std::make_unique<TackyIRVar>(b.second),
+                std::make_unique<TackyIRVar>(temp)));
+            queue.push({std::max(a.first, b.first) + 1, temp});
+        }
+        return {std::make_unique<TackyIRVar>(queue.top().second), queue.top().first};
+    }
+
+    // Emits the rebuilt tree; the last instruction writes `dst`. Returns the depth of the result.
+    int rebuild(Tree& tree, Family family, const std::string& dst, std::vector<std::unique_ptr<TackyIRNode>>& out) {
+        std::unique_ptr<TackyIRNode> result;
+        int resultDepth = 0;
+        int32_t constant = static_cast<int32_t>(tree.constant);
+
+        auto emitBinary = [&](std::unique_ptr<TackyIRNode> op, std::unique_ptr<TackyIRNode> lhs, std::unique_ptr<TackyIRNode> rhs) {
+            std::string temp = makeTemporary();
+            out.push_back(std::make_unique<TackyIRBinary>(std::move(op), std::move(lhs), std::move(rhs), std::make_unique<TackyIRVar>(temp)));
+            resultDepth++;
+            return std::make_unique<TackyIRVar>(temp);
+        };
+
+        if (family == Family::MULTIPLICATIVE) {
+            if (constant == 0) {
+                result = std::make_unique<TackyIRConstant>("0");
+            } else {
+                if (!tree.leaves.empty()) {
+                    auto combined = combine(tree.leaves, TackyIRNodeType::MULTIPLY, out);
+                    result = std::move(combined.first);
+                    resultDepth = combined.second;
+                }
+                if (!result) {
+                    result = std::make_unique<TackyIRConstant>(tackyConstantString(constant));
+                } else if (constant == -1) {
+                    std::string temp = makeTemporary();
+                    out.push_back(std::make_unique<TackyIRUnary>(std::make_unique<TackyIRNegate>(), std::move(result), std::make_unique<TackyIRVar>(temp)));
+                    result = std::make_unique<TackyIRVar>(temp);
+                    resultDepth++;
+                } else if (constant != 1) {
+                    result = emitBinary(std::make_unique<TackyIRMultiply>(), std::move(result), std::make_unique<TackyIRConstant>(tackyConstantString(constant)));
+                }
+            }
+        } else {
+            std::vector<Leaf> positive, negative;
+            for (auto& leaf : tree.leaves) (leaf.negative ? negative : positive).push_back(leaf);
+
+            std::unique_ptr<TackyIRNode> sumPositive, sumNegative;
+            int depthPositive = 0, depthNegative = 0;
+            if (!positive.empty()) {
+                auto combined = combine(positive, TackyIRNodeType::ADD, out);
+                sumPositive = std::move(combined.first);
+                depthPositive = combined.second;
+            }
+            if (!negative.empty()) {
+                auto combined = combine(negative, TackyIRNodeType::ADD, out);
+                sumNegative = std::move(combined.first);
+                depthNegative = combined.second;
+            }
+
+            if (sumPositive && sumNegative) {
+                resultDepth = std::max(depthPositive, depthNegative);
+                result = emitBinary(std::make_unique<TackyIRSubtract>(), std::move(sumPositive), std::move(sumNegative));
+            } else if (sumPositive) {
+                resultDepth = depthPositive;
+                result = std::move(sumPositive);
+            } else if (sumNegative) {
+                resultDepth = depthNegative;
+                if (constant != 0) {
+                    result = emitBinary(std::make_unique<TackyIRSubtract>(), std::make_unique<TackyIRConstant>(tackyConstantString(constant)), std::move(sumNegative));
+                    constant = 0;
+                } else {
+                    std::string temp = makeTemporary();
+                    out.push_back(std::make_unique<TackyIRUnary>(std::make_unique<TackyIRNegate>(), std::move(sumNegative), std::make_unique<TackyIRVar>(temp)));
+                    result = std::make_unique<TackyIRVar>(temp);
+                    resultDepth++;
+                }
+            }
+
+            if (!result) {
+                result = std::make_unique<TackyIRConstant>(tackyConstantString(constant));
+            } else if (constant != 0) {
+                result = emitBinary(std::make_unique<TackyIRAdd>(), std::move(result), std::make_unique<TackyIRConstant>(tackyConstantString(constant)));
+            }
+        }
+
+        // retarget the final instruction at the tree's original destination
+        const std::string* resultName = tackyVarName(result.get());
+        if (!out.empty() && resultName && *tackyVarName(tackyDestination(out.back().get())->get()) == *resultName) {
+            *tackyDestination(out.back().get()) = std::make_unique<TackyIRVar>(dst);
+        } else {
+            out.push_back(std::make_unique<TackyIRCopy>(std::move(result), std::make_unique<TackyIRVar>(dst)));
+        }
+        return resultDepth;
+    }
+
+    void run() {
+        std::vector<std::vector<std::unique_ptr<TackyIRNode>>> replacements(instrs.size());
+
+        // walk backwards so every tree is seen from its root first
+        for (size_t i = instrs.size(); i-- > 0;) {
+            if (roles[i] != Role::FREE) continue;
+            Family family = familyOf(instrs[i].get());
+            if (family == Family::NONE) continue;
+
+            Tree tree;
+            tree.constant = family == Family::ADDITIVE ? 0u : 1u;
+            gatherInstruction(instrs[i].get(), false, family, tree);
+
+            // x - x cancels in wrapping arithmetic
+            int cancelled = 0;
+            if (family == Family::ADDITIVE) {
+                for (size_t a = 0; a < tree.leaves.size(); ++a) {
+                    for (size_t b = a + 1; b < tree.leaves.size(); ++b) {
+                        if (tree.leaves[a].name == tree.leaves[b].name && tree.leaves[a].negative != tree.leaves[b].negative) {
+                            tree.leaves.erase(tree.leaves.begin() + b);
+                            tree.leaves.erase(tree.leaves.begin() + a);
+                            cancelled++;
+                            a--;
+                            break;
+                        }
+                    }
+                }
+            }
+
+            const std::string dst = *tackyVarName(tackyDestination(instrs[i].get())->get());
+            std::vector<std::unique_ptr<TackyIRNode>> out;
+            int newDepth = rebuild(tree, family, dst, out);
+            bool zeroProduct = family == Family::MULTIPLICATIVE && tree.constantCount > 0 && tree.constant == 0;
+
+            if (newDepth < depthOf(dst) || tree.constantCount >= 2 || cancelled > 0 || zeroProduct) {
+                replacements[i] = std::move(out);
+                for (size_t interior : tree.interiors) roles[interior] = Role::DELETED;
+            } else {
+                for (size_t interior : tree.interiors) roles[interior] = Role::KEPT;
+            }
+            roles[i] = Role::KEPT;
+        }
+
+        std::vector<std::unique_ptr<TackyIRNode>> result;
+        for (size_t i = 0; i < instrs.size(); ++i) {
+            if (roles[i] == Role::DELETED) continue;
+            if (!replacements[i].empty()) {
+                for (auto& instr : replacements[i]) result.push_back(std::move(instr));
+            } else {
+                result.push_back(std::move(instrs[i]));
+            }
+        }
+        instrs = std::move(result);
+    }
+};
+
+void passReassociate(TackyCFG& cfg) {
+    std::unordered_map<std::string, int> useCount;
+    for (auto& block : cfg.blocks) {
+        for (auto& instr : block.instructions) {
+            for (auto* use : tackyUses(instr.get())) {
+                const std::string* name = tackyVarName(use->get());
+                if (name) useCount[*name]++;
+            }
+        }
+    }
+
+    for (auto& block : cfg.blocks) {
+        BlockReassociator reassociator(block.instructions, useCount);
+        reassociator.run();
+    }
+}
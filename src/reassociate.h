@@ -0,0 +1,10 @@
+#ifndef REASSOCIATE_H
+#define REASSOCIATE_H
+
+#include "tacky_cfg.h"
+
+// Flattens single-use Add/Subtract/Negate and Multiply trees inside a block, folds
+// their constants and rebuilds them as minimum-depth trees. The CFG must be in SSA form.
+void passReassociate(TackyCFG& cfg);
+
+#endif
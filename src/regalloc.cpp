@@ -0,0 +1,366 @@
+#include "regalloc.h"
+#include "asm_liveness.h"
+#include <algorithm>
+#include <unordered_set>
+
+// R10 and R11 are left out so passLegalize can still use them as scratch registers. These are
+// all caller-saved and main makes no calls, so none of them has to be saved.
+static const std::vector<AsmIRRegister> allocatableRegisters = {
+    AsmIRRegister::AX, AsmIRRegister::CX, AsmIRRegister::DX, AsmIRRegister::SI, AsmIRRegister::DI, AsmIRRegister::R8, AsmIRRegister::R9};
+static const size_t registerCount = allocatableRegisters.size();
+
+struct InterferenceGraph {
+    std::vector<int> nodes; // locations
+    std::unordered_map<int, int> index;
+    std::vector<std::unordered_set<int>> adjacent;
+
+    int nodeFor(int location) {
+        auto it = index.find(location);
+        if (it != index.end()) return it->second;
+        index[location] = static_cast<int>(nodes.size());
+        nodes.push_back(location);
+        adjacent.emplace_back();
+        return static_cast<int>(nodes.size()) - 1;
+    }
+
+    void addEdge(int a, int b) {
+        if (a == b) return;
+        adjacent[a].insert(b);
+        adjacent[b].insert(a);
+    }
+
+    bool interferes(int a, int b) const {
+        return adjacent[a].count(b) > 0;
+    }
+
+    // precolored registers can never be simplified away, so count them as significant
+    bool significant(int n) const {
+        return isAsmRegisterLocation(nodes[n]) || adjacent[n].size() >= registerCount;
+    }
+};
+
+static InterferenceGraph buildInterference(std::vector<std::unique_ptr<AsmIRNode>>& instrs, AsmAnalyses& analyses) {
+    InterferenceGraph graph;
+    for (AsmIRRegister reg : allocatableRegisters) graph.nodeFor(asmLocation(reg));
+
+    const AsmLiveness& liveness = analyses.liveness(instrs);
+    std::vector<int> node(liveness.locations.size());
+    for (size_t i = 0; i < liveness.locations.size(); ++i) node[i] = graph.nodeFor(liveness.locations[i]);
+
+    for (size_t b = 0; b < liveness.blocks.size(); ++b) {
+        std::vector<bool> live = liveness.liveOut[b];
+        const AsmBlock& block = liveness.blocks[b];
+        for (size_t i = block.end; i-- > block.begin;) {
+            AsmIRNode* instr = instrs[i].get();
+
+            std::vector<int> defs;
+            for (AsmIRRegister reg : asmImplicitDefinitions(instr)) defs.push_back(asmLocation(reg));
+            for (auto* def : asmDefinitions(instr)) {
+                int location = asmLocation(*def);
+                if (location != -1) defs.push_back(location);
+            }
+            // the two sides of a move may share a register (that's what coalescing is after)
+            int moveSource = instr->type == AsmIRNodeType::MOV ? asmLocation(static_cast<AsmIRMov*>(instr)->src) : -1;
+
+            for (int def : defs) {
+                int d = graph.nodeFor(def);
+                for (size_t l = 0; l < live.size(); ++l) {
+                    if (live[l] && liveness.locations[l] != moveSource) graph.addEdge(d, node[l]);
+                }
+            }
+            asmLiveTransfer(instr, live, liveness);
+        }
+    }
+    return graph;
+}
+
+static AsmIROperand locationOperand(int location) {
+    if (isAsmRegisterLocation(location)) return asmReg(static_cast<AsmIRRegister>(location));
+    AsmIROperand pseudo;
+    pseudo.type = AsmIRNodeType::PSEUDO;
+    pseudo.value = location - asmRegisterLocations;
+    return pseudo;
+}
+
+static void replaceOperands(std::vector<std::unique_ptr<AsmIRNode>>& instrs,
+                            const std::unordered_map<int, int>& replacement) {
+    for (auto& instr : instrs) {
+        auto slots = asmUses(instr.get());
+        for (auto* def : asmDefinitions(instr.get())) slots.push_back(def);
+        for (auto* slot : slots) {
+            if (slot->type != AsmIRNodeType::PSEUDO) continue;
+            auto it = replacement.find(asmLocation(*slot));
+            if (it == replacement.end()) continue;
+            *slot = locationOperand(it->second);
+        }
+    }
+}
+
+static void removeSelfMoves(std::vector<std::unique_ptr<AsmIRNode>>& instrs) {
+    std::vector<std::unique_ptr<AsmIRNode>> kept;
+    for (auto& instr : instrs) {
+        if (instr->type == AsmIRNodeType::MOV) {
+            auto* move = static_cast<AsmIRMov*>(instr.get());
+            int src = asmLocation(move->src);
+            if (src != -1 && src == asmLocation(move->dst)) continue;
+        }
+        kept.push_back(std::move(instr));
+    }
+    instrs = std::move(kept);
+}
+
+// --- Coalescing ---
+// Merges the two sides of non-interfering moves when that can't make the graph uncolorable
+// (Briggs' test between pseudos, George's test against a register). Returns false once no
+// move was coalesced, in which case the liveness it started from is still current.
+static bool coalesceMoves(std::vector<std::unique_ptr<AsmIRNode>>& instrs, AsmAnalyses& analyses) {
+    InterferenceGraph graph = buildInterference(instrs, analyses);
+    std::vector<int> alias(graph.nodes.size());
+    for (size_t i = 0; i < alias.size(); ++i) alias[i] = static_cast<int>(i);
+    auto find = [&](int n) {
+        while (alias[n] != n) n = alias[n];
+        return n;
+    };
+
+    auto briggs = [&](int a, int b) {
+        std::unordered_set<int> neighbors(graph.adjacent[a].begin(), graph.adjacent[a].end());
+        neighbors.insert(graph.adjacent[b].begin(), graph.adjacent[b].end());
+        size_t significant = 0;
+        for (int n : neighbors) {
+            if (graph.significant(n)) significant++;
+        }
+        return significant < registerCount;
+    };
+    auto george = [&](int reg, int pseudo) {
+        for (int t : graph.adjacent[pseudo]) {
+            if (!graph.interferes(t, reg) && !isAsmRegisterLocation(graph.nodes[t]) && graph.significant(t)) return false;
+        }
+        return true;
+    };
+
+    bool merged = false;
+    for (auto& instr : instrs) {
+        if (instr->type != AsmIRNodeType::MOV) continue;
+        auto* move = static_cast<AsmIRMov*>(instr.get());
+        int src = asmLocation(move->src);
+        int dst = asmLocation(move->dst);
+        if (src == -1 || dst == -1) continue;
+
+        int keep = find(graph.index.at(src));
+        int drop = find(graph.index.at(dst));
+        if (keep == drop || graph.interferes(keep, drop)) continue;
+        if (isAsmRegisterLocation(graph.nodes[drop])) std::swap(keep, drop);
+        if (isAsmRegisterLocation(graph.nodes[drop])) continue;
+
+        bool safe = isAsmRegisterLocation(graph.nodes[keep]) ? george(keep, drop) : briggs(keep, drop);
+        if (!safe) continue;
+
+        alias[drop] = keep;
+        for (int n : graph.adjacent[drop]) {
+            graph.adjacent[n].erase(drop);
+            graph.addEdge(keep, n);
+        }
+        graph.adjacent[drop].clear();
+        merged = true;
+    }
+    if (!merged) return false;
+
+    std::unordered_map<int, int> replacement;
+    for (size_t i = 0; i < graph.nodes.size(); ++i) {
+        int root = find(static_cast<int>(i));
+        if (root != static_cast<int>(i)) replacement[graph.nodes[i]] = graph.nodes[root];
+    }
+    replaceOperands(instrs, replacement);
+
+    removeSelfMoves(instrs);
+    analyses.invalidate();
+    return true;
+}
+
+// --- Coloring ---
+static std::unordered_map<int, int> colorGraph(std::vector<std::unique_ptr<AsmIRNode>>& instrs, AsmAnalyses& analyses) {
+    InterferenceGraph graph = buildInterference(instrs, analyses);
+
+    // spill cost: how many instructions would need a memory operand instead
+    std::vector<int> cost(graph.nodes.size(), 0);
+    for (auto& instr : instrs) {
+        auto slots = asmUses(instr.get());
+        for (auto* def : asmDefinitions(instr.get())) slots.push_back(def);
+        for (auto* slot : slots) {
+            auto it = graph.index.find(asmLocation(*slot));
+            if (it != graph.index.end()) cost[it->second]++;
+        }
+    }
+
+    std::vector<size_t> degree(graph.nodes.size());
+    std::vector<bool> removed(graph.nodes.size(), false);
+    std::vector<int> lowDegree;
+    size_t remaining = 0;
+    for (size_t n = 0; n < graph.nodes.size(); ++n) {
+        degree[n] = graph.adjacent[n].size();
+        if (isAsmRegisterLocation(graph.nodes[n])) continue;
+        remaining++;
+        if (degree[n] < registerCount) lowDegree.push_back(static_cast<int>(n));
+    }
+
+    // simplify, pushing a spill candidate optimistically when every node is significant
+    std::vector<int> stack;
+    while (remaining > 0) {
+        int pick = -1;
+        while (!lowDegree.empty() && pick == -1) {
+            int n = lowDegree.back();
+            lowDegree.pop_back();
+            if (!removed[n]) pick = n;
+        }
+        if (pick == -1) {
+            double best = 0;
+            for (size_t n = 0; n < graph.nodes.size(); ++n) {
+                if (removed[n] || isAsmRegisterLocation(graph.nodes[n])) continue;
+                double weight = static_cast<double>(cost[n]) / static_cast<double>(degree[n] + 1);
+                if (pick == -1 || weight < best) {
+                    pick = static_cast<int>(n);
+                    best = weight;
+                }
+            }
+        }
+
+        removed[pick] = true;
+        remaining--;
+        stack.push_back(pick);
+        for (int m : graph.adjacent[pick]) {
+            if (removed[m]) continue;
+            if (degree[m]-- == registerCount && !isAsmRegisterLocation(graph.nodes[m])) lowDegree.push_back(m);
+        }
+    }
+
+    // select
+    std::unordered_map<int, int> colors;
+    while (!stack.empty()) {
+        int n = stack.back();
+        stack.pop_back();
+
+        std::unordered_set<int> taken;
+        for (int m : graph.adjacent[n]) {
+            int location = graph.nodes[m];
+            if (isAsmRegisterLocation(location)) {
+                taken.insert(location);
+            } else {
+                auto it = colors.find(location);
+                if (it != colors.end()) taken.insert(it->second);
+            }
+        }
+        for (AsmIRRegister reg : allocatableRegisters) {
+            if (!taken.count(asmLocation(reg))) {
+                colors[graph.nodes[n]] = asmLocation(reg);
+                break;
+            }
+        }
+    }
+    return colors;
+}
+
+void passAllocateRegisters(AsmIRNode* node, AsmAnalyses& analyses) {
+    if (!node || node->type != AsmIRNodeType::PROGRAM) return;
+    auto* fn = static_cast<AsmIRProgram*>(node)->function.get();
+    if (!fn || !fn->instructions) return;
+    auto& instrs = fn->instructions->instructions;
+
+    // the last, unsuccessful round leaves its liveness cached for coloring
+    while (coalesceMoves(instrs, analyses)) {}
+    replaceOperands(instrs, colorGraph(instrs, analyses));
+    // moves the coalescer turned down can still end up with both sides in the same register
+    removeSelfMoves(instrs);
+    analyses.invalidate();
+}
+
+// --- Stack Slots ---
+void passColorStackSlots(AsmIRNode* node, AsmAnalyses& analyses, std::unordered_map<int64_t, int>& pseudoToOffset, int& nextOffset) {
+    if (!node || node->type != AsmIRNodeType::PROGRAM) return;
+    auto* fn = static_cast<AsmIRProgram*>(node)->function.get();
+    if (!fn || !fn->instructions) return;
+    auto& instrs = fn->instructions->instructions;
+
+    InterferenceGraph graph = buildInterference(instrs, analyses);
+
+    // pseudos in order of first appearance, and the pseudos each one is moved to or from
+    std::vector<int> order;
+    std::vector<bool> seen(graph.nodes.size(), false);
+    std::vector<std::vector<int>> partners(graph.nodes.size());
+    for (auto& instr : instrs) {
+        auto slots = asmUses(instr.get());
+        for (auto* def : asmDefinitions(instr.get())) slots.push_back(def);
+        for (auto* slot : slots) {
+            if (slot->type != AsmIRNodeType::PSEUDO) continue;
+            int n = graph.index.at(asmLocation(*slot));
+            if (!seen[n]) order.push_back(n);
+            seen[n] = true;
+        }
+        if (instr->type == AsmIRNodeType::MOV) {
+            auto* move = static_cast<AsmIRMov*>(instr.get());
+            if (move->src.type == AsmIRNodeType::PSEUDO && move->dst.type == AsmIRNodeType::PSEUDO) {
+                int a = graph.index.at(asmLocation(move->src));
+                int b = graph.index.at(asmLocation(move->dst));
+                partners[a].push_back(b);
+                partners[b].push_back(a);
+            }
+        }
+    }
+
+    std::vector<int> slot(graph.nodes.size(), 0);
+    std::vector<int> offsets; // every slot handed out so far
+    for (int n : order) {
+        std::unordered_set<int> taken;
+        for (int m : graph.adjacent[n]) {
+            if (slot[m] != 0) taken.insert(slot[m]);
+        }
+
+        int chosen = 0;
+        // sharing with a move partner turns the move into a no-op
+        for (int m : partners[n]) {
+            if (slot[m] != 0 && !taken.count(slot[m])) {
+                chosen = slot[m];
+                break;
+            }
+        }
+        for (size_t i = 0; i < offsets.size() && chosen == 0; ++i) {
+            if (!taken.count(offsets[i])) chosen = offsets[i];
+        }
+        if (chosen == 0) {
+            chosen = nextOffset;
+            offsets.push_back(nextOffset);
+            nextOffset -= 4;
+        }
+        slot[n] = chosen;
+        pseudoToOffset[graph.nodes[n] - asmRegisterLocations] = chosen;
+    }
+
+    std::vector<std::unique_ptr<AsmIRNode>> kept;
+    for (auto& instr : instrs) {
+        if (instr->type == AsmIRNodeType::MOV) {
+            auto* move = static_cast<AsmIRMov*>(instr.get());
+            if (move->src.type == AsmIRNodeType::PSEUDO && move->dst.type == AsmIRNodeType::PSEUDO &&
+                slot[graph.index.at(asmLocation(move->src))] == slot[graph.index.at(asmLocation(move->dst))]) {
+                continue;
+            }
+        }
+        kept.push_back(std::move(instr));
+    }
+    instrs = std::move(kept);
+    analyses.invalidate();
+}
+
+void passAssignStackSlots(AsmIRNode* node, std::unordered_map<int64_t, int>& pseudoToOffset, int& nextOffset) {
+    if (!node || node->type != AsmIRNodeType::PROGRAM) return;
+    auto* fn = static_cast<AsmIRProgram*>(node)->function.get();
+    if (!fn || !fn->instructions) return;
+
+    for (auto& instr : fn->instructions->instructions) {
+        auto slots = asmUses(instr.get());
+        for (auto* def : asmDefinitions(instr.get())) slots.push_back(def);
+        for (auto* slot : slots) {
+            if (slot->type != AsmIRNodeType::PSEUDO || pseudoToOffset.count(slot->value)) continue;
+            pseudoToOffset[slot->value] = nextOffset;
+            nextOffset -= 4;
+        }
+    }
+}
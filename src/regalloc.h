@@ -0,0 +1,19 @@
+#ifndef REGALLOC_H
+#define REGALLOC_H
+
+#include "asm_ir.h"
+#include "asm_liveness.h"
+#include <unordered_map>
+
+// Chaitin-Briggs register allocation: builds an interference graph from liveness,
+// conservatively coalesces moves, then colors pseudos with the allocatable registers.
+// Pseudos that don't get a register are left for passLegalize to put on the stack.
+void passAllocateRegisters(AsmIRNode* node, AsmAnalyses& analyses);
+// Gives the remaining pseudos stack offsets, sharing a slot between pseudos whose live
+// ranges don't overlap. The offsets go into pseudoToOffset for passLegalize to apply.
+void passColorStackSlots(AsmIRNode* node, AsmAnalyses& analyses, std::unordered_map<int64_t, int>& pseudoToOffset, int& nextOffset);
+// One fresh slot for every pseudo still without an offset: linear, and the fallback when
+// slot coloring is switched off. A no-op after passColorStackSlots.
+void passAssignStackSlots(AsmIRNode* node, std::unordered_map<int64_t, int>& pseudoToOffset, int& nextOffset);
+
+#endif
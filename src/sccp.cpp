@@ -0,0 +1,249 @@
+#include "sccp.h"
+#include "tacky_eval.h"
+#include <iostream>
+#include <set>
+#include <unordered_map>
+
+enum class LatticeState { TOP, CONSTANT, BOTTOM };
+
+struct LatticeValue {
+    LatticeState state = LatticeState::TOP;
+    int32_t value = 0;
+};
+
+struct InstrRef {
+    int block;
+    TackyIRNode* instr;
+};
+
+void passSCCP(TackyCFG& cfg) {
+    std::unordered_map<std::string, LatticeValue> values;
+    std::unordered_map<std::string, std::vector<InstrRef>> users;
+    std::unordered_set<std::string> defined = tackyDefinedNames(cfg);
+
+    for (size_t b = 0; b < cfg.blocks.size(); ++b) {
+        for (auto& instr : cfg.blocks[b].instructions) {
+            for (auto* use : tackyUses(instr.get())) {
+                const std::string* name = tackyVarName(use->get());
+                if (name) users[*name].push_back({static_cast<int>(b), instr.get()});
+            }
+        }
+    }
+
+    auto valueOf = [&](const TackyIRNode* operand) {
+        LatticeValue result;
+        auto constant = [](int32_t value) { return LatticeValue{LatticeState::CONSTANT, value}; };
+        tackyOperandLattice(operand, defined, values, constant, LatticeValue{LatticeState::BOTTOM}, result);
+        return result;
+    };
+
+    std::vector<bool> executableBlock(cfg.blocks.size(), false);
+    std::set<std::pair<int, int>> executableEdge;
+    std::vector<std::pair<int, int>> flowWork = {{-1, 0}};
+    std::vector<InstrRef> ssaWork;
+
+    auto lower = [&](const std::string& name, LatticeValue value) {
+        LatticeValue& current = values[name];
+        if (current.state == LatticeState::BOTTOM) return;
+        if (value.state == LatticeState::TOP) return;
+        if (current.state == LatticeState::CONSTANT &&
+            (value.state == LatticeState::BOTTOM || value.value != current.value)) {
+            current.state = LatticeState::BOTTOM;
+        } else if (current.state == LatticeState::TOP) {
+            current = value;
+        } else {
+            return;
+        }
+        for (auto& user : users[name]) ssaWork.push_back(user);
+    };
+
+    auto addEdge = [&](int from, int to) {
+        if (executableEdge.count({from, to})) return;
+        flowWork.push_back({from, to});
+    };
+
+    auto visit = [&](int b, TackyIRNode* instr) {
+        switch (instr->type) {
+            case TackyIRNodeType::PHI: {
+                auto* phi = static_cast<TackyIRPhi*>(instr);
+                LatticeValue merged;
+                for (auto& arg : phi->args) {
+                    if (!executableEdge.count({arg.first, b})) continue;
+                    LatticeValue v = valueOf(arg.second.get());
+                    if (v.state == LatticeState::TOP) continue;
+                    if (v.state == LatticeState::BOTTOM ||
+                        (merged.state == LatticeState::CONSTANT && merged.value != v.value)) {
+                        merged.state = LatticeState::BOTTOM;
+                        break;
+                    }
+                    merged = v;
+                }
+                lower(*tackyVarName(phi->dst.get()), merged);
+                break;
+            }
+            case TackyIRNodeType::COPY: {
+                auto* copy = static_cast<TackyIRCopy*>(instr);
+                lower(*tackyVarName(copy->dst.get()), valueOf(copy->src.get()));
+                break;
+            }
+            case TackyIRNodeType::UNARY: {
+                auto* unary = static_cast<TackyIRUnary*>(instr);
+                LatticeValue src = valueOf(unary->src.get());
+                LatticeValue result;
+                result.state = src.state;
+                if (src.state == LatticeState::CONSTANT &&
+                    !evalTackyUnary(unary->op->type, src.value, result.value)) {
+                    result.state = LatticeState::BOTTOM;
+                }
+                lower(*tackyVarName(unary->dst.get()), result);
+                break;
+            }
+            case TackyIRNodeType::BINARY: {
+                auto* binary = static_cast<TackyIRBinary*>(instr);
+                LatticeValue lhs = valueOf(binary->src1.get());
+                LatticeValue rhs = valueOf(binary->src2.get());
+                LatticeValue result;
+                TackyIRNodeType op = binary->op->type;
+
+                if (lhs.state == LatticeState::CONSTANT && rhs.state == LatticeState::CONSTANT) {
+                    result.state = LatticeState::CONSTANT;
+                    // a trapping division stays in the program
+                    if (!evalTackyBinary(op, lhs.value, rhs.value, result.value))
+                        result.state = LatticeState::BOTTOM;
+                } else if (op == TackyIRNodeType::MULTIPLY &&
+                           ((lhs.state == LatticeState::CONSTANT && lhs.value == 0) ||
+                            (rhs.state == LatticeState::CONSTANT && rhs.value == 0))) {
+                    result.state = LatticeState::CONSTANT;
+                    result.value = 0;
+                } else if (lhs.state == LatticeState::BOTTOM || rhs.state == LatticeState::BOTTOM) {
+                    result.state = LatticeState::BOTTOM;
+                }
+                lower(*tackyVarName(binary->dst.get()), result);
+                break;
+            }
+            case TackyIRNodeType::JUMP_IF_ZERO:
+            case TackyIRNodeType::JUMP_IF_NOT_ZERO: {
+                const TackyIRNode* condition = instr->type == TackyIRNodeType::JUMP_IF_ZERO
+                    ? static_cast<TackyIRJumpIfZero*>(instr)->condition.get()
+                    : static_cast<TackyIRJumpIfNotZero*>(instr)->condition.get();
+                LatticeValue v = valueOf(condition);
+                const auto& block = cfg.blocks[b];
+                if (v.state == LatticeState::BOTTOM) {
+                    for (int succ : block.successors) addEdge(b, succ);
+                } else if (v.state == LatticeState::CONSTANT) {
+                    bool jumps = (instr->type == TackyIRNodeType::JUMP_IF_ZERO) == (v.value == 0);
+                    // successors[0] is the jump target, the fallthrough comes after it
+                    int taken = jumps ? block.successors.front() : block.fallthrough;
+                    if (taken != -1) addEdge(b, taken);
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    };
+
+    while (!flowWork.empty() || !ssaWork.empty()) {
+        while (!flowWork.empty()) {
+            auto edge = flowWork.back();
+            flowWork.pop_back();
+            if (edge.first != -1) {
+                if (executableEdge.count(edge)) continue;
+                executableEdge.insert(edge);
+            }
+            int b = edge.second;
+            bool firstVisit = !executableBlock[b];
+            executableBlock[b] = true;
+
+            auto& block = cfg.blocks[b];
+            for (auto& instr : block.instructions) {
+                if (instr->type == TackyIRNodeType::PHI) {
+                    visit(b, instr.get());
+                } else if (firstVisit) {
+                    visit(b, instr.get());
+                }
+            }
+            if (!firstVisit) continue;
+
+            const TackyIRNode* last = block.instructions.empty() ? nullptr : block.instructions.back().get();
+            if (!last || (last->type != TackyIRNodeType::JUMP_IF_ZERO && last->type != TackyIRNodeType::JUMP_IF_NOT_ZERO)) {
+                for (int succ : block.successors) addEdge(b, succ);
+            }
+        }
+
+        while (!ssaWork.empty()) {
+            InstrRef ref = ssaWork.back();
+            ssaWork.pop_back();
+            if (executableBlock[ref.block]) visit(ref.block, ref.instr);
+        }
+    }
+
+    // --- Rewrite: substitute constants, fold branches, drop dead blocks and edges ---
+    auto constantFor = [&](const TackyIRNode* operand, int32_t& out) {
+        const std::string* name = tackyVarName(operand);
+        if (!name) return false;
+        auto it = values.find(*name);
+        if (it == values.end() || it->second.state != LatticeState::CONSTANT) return false;
+        out = it->second.value;
+        return true;
+    };
+
+    for (size_t b = 0; b < cfg.blocks.size(); ++b) {
+        auto& block = cfg.blocks[b];
+        if (!executableBlock[b]) {
+            block.instructions.clear();
+            block.fallthrough = -1;
+            continue;
+        }
+
+        std::vector<std::unique_ptr<TackyIRNode>> rewritten;
+        for (auto& instr : block.instructions) {
+            auto* dst = tackyDestination(instr.get());
+            int32_t constant;
+            if (dst && constantFor(dst->get(), constant)) continue;
+
+            if (instr->type == TackyIRNodeType::PHI) {
+                auto& args = static_cast<TackyIRPhi*>(instr.get())->args;
+                for (size_t i = 0; i < args.size();) {
+                    if (!executableEdge.count({args[i].first, static_cast<int>(b)})) args.erase(args.begin() + i);
+                    else ++i;
+                }
+            }
+
+            for (auto* use : tackyUses(instr.get())) {
+                if (constantFor(use->get(), constant))
+                    *use = std::make_unique<TackyIRConstant>(tackyConstantString(constant));
+            }
+
+            if (instr->type == TackyIRNodeType::JUMP_IF_ZERO || instr->type == TackyIRNodeType::JUMP_IF_NOT_ZERO) {
+                const TackyIRNode* condition = tackyUses(instr.get())[0]->get();
+                if (parseTackyConstant(condition, constant)) {
+                    bool jumps = (instr->type == TackyIRNodeType::JUMP_IF_ZERO) == (constant == 0);
+                    if (jumps) {
+                        std::string target = instr->type == TackyIRNodeType::JUMP_IF_ZERO
+                            ? static_cast<TackyIRJumpIfZero*>(instr.get())->target
+                            : static_cast<TackyIRJumpIfNotZero*>(instr.get())->target;
+                        rewritten.push_back(std::make_unique<TackyIRJump>(target));
+                        block.fallthrough = -1;
+                    }
+                    continue;
+                }
+            }
+            rewritten.push_back(std::move(instr));
+        }
+        block.instructions = std::move(rewritten);
+    }
+
+    recomputeTackyEdges(cfg);
+    removeUnreachableBlocks(cfg);
+
+    // phis left with a single incoming edge are plain copies
+    for (auto& block : cfg.blocks) {
+        for (auto& instr : block.instructions) {
+            if (instr->type != TackyIRNodeType::PHI) break;
+            auto* phi = static_cast<TackyIRPhi*>(instr.get());
+            if (phi->args.size() == 1)
+                instr = std::make_unique<TackyIRCopy>(std::move(phi->args[0].second), std::move(phi->dst));
+        }
+    }
+}
@@ -0,0 +1,9 @@
+#ifndef SCCP_H
+#define SCCP_H
+
+#include "tacky_cfg.h"
+
+// Sparse conditional constant propagation (Wegman & Zadeck). The CFG must be in SSA form.
+void passSCCP(TackyCFG& cfg);
+
+#endif
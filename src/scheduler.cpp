@@ -0,0 +1,225 @@
+#include "scheduler.h"
+#include "asm_liveness.h"
+#include "target.h"
+#include <algorithm>
+#include <unordered_map>
+
+using AsmInstructions = std::vector<std::unique_ptr<AsmIRNode>>;
+
+static bool isStack(const AsmIROperand& operand) {
+    return operand.type == AsmIRNodeType::STACK;
+}
+
+// --- Machine Model ---
+// Latencies, throughputs and unit counts come from the -mtune target
+static InstrClass classify(AsmIRNode* instr) {
+    switch (instr->type) {
+        case AsmIRNodeType::MOV: {
+            auto* move = static_cast<AsmIRMov*>(instr);
+            if (isStack(move->src)) return InstrClass::LOAD;
+            if (isStack(move->dst)) return InstrClass::STORE;
+            return InstrClass::MOVE;
+        }
+        case AsmIRNodeType::MOVZX: return InstrClass::MOVE;
+        case AsmIRNodeType::BINARY:
+            switch (static_cast<AsmIRBinary*>(instr)->binary_operator) {
+                case AsmIRNodeType::MULTIPLY: return InstrClass::MULTIPLY;
+                case AsmIRNodeType::SAR:
+                case AsmIRNodeType::SHL:
+                case AsmIRNodeType::SHR:
+                    return InstrClass::SHIFT;
+                default:
+                    return InstrClass::ALU;
+            }
+        case AsmIRNodeType::CMP:
+        case AsmIRNodeType::TEST:
+            return InstrClass::COMPARE;
+        case AsmIRNodeType::SET_CC: return InstrClass::SET_CC;
+        case AsmIRNodeType::IMUL_WIDE: return InstrClass::MULTIPLY_WIDE;
+        case AsmIRNodeType::IDIV: return InstrClass::DIVIDE;
+        case AsmIRNodeType::LEA: {
+            auto* lea = static_cast<AsmIRLea*>(instr);
+            if (lea->base && lea->index && lea->displacement != 0) return InstrClass::LEA_THREE_PART;
+            return lea->index && lea->scale > 1 ? InstrClass::LEA_SCALED : InstrClass::LEA;
+        }
+        default:
+            return InstrClass::ALU;
+    }
+}
+
+// Anything but a plain load that reads a stack slot waits on the load first
+static Timing timingOf(AsmIRNode* instr) {
+    InstrClass instrClass = classify(instr);
+    Timing timing = targetTiming(instrClass);
+    if (instrClass != InstrClass::LOAD) {
+        for (auto* use : asmUses(instr)) {
+            if (isStack(*use)) {
+                timing.latency += targetLatency(InstrClass::LOAD);
+                break;
+            }
+        }
+    }
+    return timing;
+}
+
+// --- Dependencies ---
+// Registers are keyed by location and stack slots by their (negative) offset, so neither
+// collides with the flags
+constexpr int64_t flagsResource = asmRegisterLocations;
+
+static int64_t resourceOf(const AsmIROperand& operand) {
+    if (operand.type == AsmIRNodeType::REGISTER) return asmLocation(operand.reg);
+    if (isStack(operand)) return operand.value;
+    return flagsResource;
+}
+
+static bool isResource(const AsmIROperand& operand) {
+    return operand.type == AsmIRNodeType::REGISTER || isStack(operand);
+}
+
+static void accesses(AsmIRNode* instr, std::vector<int64_t>& reads, std::vector<int64_t>& writes) {
+    for (auto* use : asmUses(instr)) {
+        if (isResource(*use)) reads.push_back(resourceOf(*use));
+    }
+    for (auto* def : asmDefinitions(instr)) {
+        if (isResource(*def)) writes.push_back(resourceOf(*def));
+    }
+    // setcc writes one byte and keeps the rest, so it also depends on the earlier value
+    if (instr->type == AsmIRNodeType::SET_CC) reads.push_back(resourceOf(static_cast<AsmIRSetCC*>(instr)->operand));
+    for (AsmIRRegister reg : asmImplicitUses(instr)) reads.push_back(asmLocation(reg));
+    for (AsmIRRegister reg : asmImplicitDefinitions(instr)) writes.push_back(asmLocation(reg));
+    if (asmReadsFlags(instr)) reads.push_back(flagsResource);
+    if (asmWritesFlags(instr)) writes.push_back(flagsResource);
+}
+
+struct DependenceNode {
+    Timing timing;
+    std::vector<std::pair<int, int>> successors; // node, cycles it has to wait after this one issues
+    int predecessors = 0;
+    int height = 0;   // longest latency path from this node to the end of the run
+    int earliest = 0; // first cycle every operand is ready
+};
+
+/*
+    Read after write waits out the writer's latency. Write after read and write after
+    write only have to keep their order, so the final value of every register, slot and
+    the flags is the same as before; the jump or return after the run sees no difference.
+*/
+static std::vector<DependenceNode> buildDependences(AsmInstructions& instrs, size_t begin, size_t end) {
+    std::vector<DependenceNode> nodes(end - begin);
+    std::unordered_map<int64_t, int> lastWriter;
+    std::unordered_map<int64_t, std::vector<int>> readersSinceWrite;
+
+    auto addEdge = [&](int from, int to, int latency) {
+        nodes[from].successors.push_back({to, latency});
+        nodes[to].predecessors++;
+    };
+
+    for (size_t i = begin; i < end; ++i) {
+        int n = static_cast<int>(i - begin);
+        nodes[n].timing = timingOf(instrs[i].get());
+
+        std::vector<int64_t> reads, writes;
+        accesses(instrs[i].get(), reads, writes);
+        for (int64_t resource : reads) {
+            auto it = lastWriter.find(resource);
+            if (it != lastWriter.end()) addEdge(it->second, n, nodes[it->second].timing.latency);
+            readersSinceWrite[resource].push_back(n);
+        }
+        for (int64_t resource : writes) {
+            auto it = lastWriter.find(resource);
+            if (it != lastWriter.end() && it->second != n) addEdge(it->second, n, 0);
+            for (int reader : readersSinceWrite[resource]) {
+                if (reader != n) addEdge(reader, n, 0);
+            }
+            readersSinceWrite[resource].clear();
+            lastWriter[resource] = n;
+        }
+    }
+
+    // edges only run forward, so one backwards sweep settles the heights
+    for (size_t n = nodes.size(); n-- > 0;) {
+        nodes[n].height = nodes[n].timing.latency;
+        for (auto [succ, latency] : nodes[n].successors)
+            nodes[n].height = std::max(nodes[n].height, latency + nodes[succ].height);
+    }
+    return nodes;
+}
+
+// --- List Scheduling ---
+// Each cycle issues up to the target's issue width of ready instructions, tallest first and in their
+// original order on ties, as long as a unit of the right kind is free.
+static void scheduleRun(AsmInstructions& instrs, size_t begin, size_t end) {
+    if (end - begin < 2) return;
+    std::vector<DependenceNode> nodes = buildDependences(instrs, begin, end);
+
+    std::vector<std::vector<int>> busyUntil(static_cast<size_t>(Unit::COUNT));
+    for (size_t u = 0; u < busyUntil.size(); ++u) busyUntil[u].assign(tuneTarget->unitCount[u], 0);
+
+    std::vector<int> ready, order;
+    for (size_t n = 0; n < nodes.size(); ++n) {
+        if (nodes[n].predecessors == 0) ready.push_back(static_cast<int>(n));
+    }
+
+    for (int cycle = 0; order.size() < nodes.size(); ++cycle) {
+        std::vector<int> candidates;
+        for (int n : ready) {
+            if (nodes[n].earliest <= cycle) candidates.push_back(n);
+        }
+        std::sort(candidates.begin(), candidates.end(), [&](int a, int b) {
+            if (nodes[a].height != nodes[b].height) return nodes[a].height > nodes[b].height;
+            return a < b;
+        });
+
+        int issued = 0;
+        for (int n : candidates) {
+            if (issued == tuneTarget->issueWidth) break;
+            auto& units = busyUntil[static_cast<size_t>(nodes[n].timing.unit)];
+            auto unit = std::find_if(units.begin(), units.end(), [&](int until) { return until <= cycle; });
+            if (unit == units.end()) continue;
+            *unit = cycle + nodes[n].timing.throughput;
+
+            order.push_back(n);
+            ready.erase(std::find(ready.begin(), ready.end(), n));
+            issued++;
+            for (auto [succ, latency] : nodes[n].successors) {
+                nodes[succ].earliest = std::max(nodes[succ].earliest, cycle + latency);
+                if (--nodes[succ].predecessors == 0) ready.push_back(succ);
+            }
+        }
+    }
+
+    AsmInstructions scheduled;
+    scheduled.reserve(order.size());
+    for (int n : order) scheduled.push_back(std::move(instrs[begin + static_cast<size_t>(n)]));
+    std::move(scheduled.begin(), scheduled.end(), instrs.begin() + static_cast<std::ptrdiff_t>(begin));
+}
+
+// Labels, jumps, returns and the frame allocation stay where they are
+static bool endsRun(const AsmIRNode* instr) {
+    switch (instr->type) {
+        case AsmIRNodeType::LABEL:
+        case AsmIRNodeType::JMP:
+        case AsmIRNodeType::JMP_CC:
+        case AsmIRNodeType::RETURN:
+        case AsmIRNodeType::ALLOCATE_STACK:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void passScheduleInstructions(AsmIRNode* node) {
+    if (!node || node->type != AsmIRNodeType::PROGRAM) return;
+    auto* fn = static_cast<AsmIRProgram*>(node)->function.get();
+    if (!fn || !fn->instructions) return;
+    auto& instrs = fn->instructions->instructions;
+
+    size_t begin = 0;
+    for (size_t i = 0; i < instrs.size(); ++i) {
+        if (!endsRun(instrs[i].get())) continue;
+        scheduleRun(instrs, begin, i);
+        begin = i + 1;
+    }
+    scheduleRun(instrs, begin, instrs.size());
+}
@@ -0,0 +1,12 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "asm_ir.h"
+
+// List scheduling of the straight-line runs between labels and jumps, using the
+// latency/throughput tables of the -mtune target in target.h. Instructions are reordered
+// only where register, stack-slot and flag dependencies allow. Runs last, on the final
+// registers.
+void passScheduleInstructions(AsmIRNode* node);
+
+#endif
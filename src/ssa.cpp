@@ -0,0 +1,472 @@
+#include "ssa.h"
+#include "generate_tacky.h"
+#include <iostream>
+#include <algorithm>
+#include <unordered_set>
+
+// --- SSA Construction ---
+void buildSSA(TackyCFG& cfg) {
+    removeUnreachableBlocks(cfg);
+    cfg.ssaOrigin.clear();
+
+    const std::vector<int>& idom = cachedDominators(cfg);
+    auto frontiers = dominanceFrontiers(cfg, idom);
+    const auto& children = cachedDominatorTree(cfg);
+
+    // variables live across a block boundary are the only ones that can need a phi
+    std::unordered_map<std::string, std::vector<int>> defBlocks;
+    std::unordered_set<std::string> globals;
+    for (size_t b = 0; b < cfg.blocks.size(); ++b) {
+        std::unordered_set<std::string> killed;
+        for (auto& instr : cfg.blocks[b].instructions) {
+            for (auto* use : tackyUses(instr.get())) {
+                const std::string* name = tackyVarName(use->get());
+                if (name && !killed.count(*name)) globals.insert(*name);
+            }
+            auto* dst = tackyDestination(instr.get());
+            if (dst) {
+                const std::string& name = *tackyVarName(dst->get());
+                killed.insert(name);
+                auto& blocks = defBlocks[name];
+                if (blocks.empty() || blocks.back() != static_cast<int>(b))
+                    blocks.push_back(static_cast<int>(b));
+            }
+        }
+    }
+
+    // --- Phi placement on the iterated dominance frontier ---
+    std::unordered_map<const TackyIRPhi*, std::string> phiVariable;
+    for (auto& entry : defBlocks) {
+        const std::string& name = entry.first;
+        if (!globals.count(name)) continue;
+
+        std::vector<bool> hasPhi(cfg.blocks.size(), false);
+        std::vector<bool> queued(cfg.blocks.size(), false);
+        std::vector<int> worklist = entry.second;
+        for (int b : worklist) queued[b] = true;
+
+        while (!worklist.empty()) {
+            int b = worklist.back();
+            worklist.pop_back();
+            for (int f : frontiers[b]) {
+                if (hasPhi[f]) continue;
+                hasPhi[f] = true;
+                auto phi = std::make_unique<TackyIRPhi>(std::make_unique<TackyIRVar>(name));
+                for (int pred : cfg.blocks[f].predecessors)
+                    phi->args.push_back({pred, std::make_unique<TackyIRVar>(name)});
+                phiVariable[phi.get()] = name;
+                auto& instrs = cfg.blocks[f].instructions;
+                instrs.insert(instrs.begin(), std::move(phi));
+                if (!queued[f]) {
+                    queued[f] = true;
+                    worklist.push_back(f);
+                }
+            }
+        }
+    }
+
+    // --- Renaming along the dominator tree ---
+    std::unordered_map<std::string, int> versionCount;
+    std::unordered_map<std::string, std::vector<std::string>> stacks;
+    std::vector<std::vector<std::string>> pushed(cfg.blocks.size());
+
+    auto rename = [&](std::unique_ptr<TackyIRNode>& operand) {
+        const std::string* name = tackyVarName(operand.get());
+        if (!name) return;
+        auto it = stacks.find(*name);
+        // a use with no reaching definition reads an uninitialized variable; leave it alone
+        if (it != stacks.end() && !it->second.empty())
+            operand = std::make_unique<TackyIRVar>(it->second.back());
+    };
+
+    auto define = [&](std::unique_ptr<TackyIRNode>& operand, int block) {
+        std::string name = static_cast<TackyIRVar*>(operand.get())->value;
+        std::string version = name + "." + std::to_string(++versionCount[name]);
+        stacks[name].push_back(version);
+        pushed[block].push_back(name);
+        cfg.ssaOrigin[version] = name;
+        operand = std::make_unique<TackyIRVar>(version);
+    };
+
+    std::vector<std::pair<int, bool>> work = {{0, false}};
+    while (!work.empty()) {
+        auto [b, done] = work.back();
+        work.pop_back();
+
+        if (done) {
+            for (const auto& name : pushed[b])
+                stacks[name].pop_back();
+            continue;
+        }
+
+        for (auto& instr : cfg.blocks[b].instructions) {
+            if (instr->type != TackyIRNodeType::PHI) {
+                for (auto* use : tackyUses(instr.get()))
+                    rename(*use);
+            }
+            auto* dst = tackyDestination(instr.get());
+            if (dst) define(*dst, b);
+        }
+
+        for (int succ : cfg.blocks[b].successors) {
+            for (auto& instr : cfg.blocks[succ].instructions) {
+                if (instr->type != TackyIRNodeType::PHI) break;
+                auto* phi = static_cast<TackyIRPhi*>(instr.get());
+                for (auto& arg : phi->args) {
+                    if (arg.first != b) continue;
+                    arg.second = std::make_unique<TackyIRVar>(phiVariable[phi]);
+                    rename(arg.second);
+                }
+            }
+        }
+
+        work.push_back({b, true});
+        for (int child : children[b])
+            work.push_back({child, false});
+    }
+}
+
+// --- Dead Code Elimination ---
+void passDeadCodeElimination(TackyCFG& cfg) {
+    std::unordered_map<std::string, int> useCount;
+    std::unordered_map<std::string, std::pair<int, size_t>> definition;
+
+    for (size_t b = 0; b < cfg.blocks.size(); ++b) {
+        auto& instrs = cfg.blocks[b].instructions;
+        for (size_t i = 0; i < instrs.size(); ++i) {
+            for (auto* use : tackyUses(instrs[i].get())) {
+                const std::string* name = tackyVarName(use->get());
+                if (name) useCount[*name]++;
+            }
+            auto* dst = tackyDestination(instrs[i].get());
+            if (dst) definition[*tackyVarName(dst->get())] = {static_cast<int>(b), i};
+        }
+    }
+
+    std::vector<std::string> worklist;
+    for (auto& def : definition) {
+        if (useCount[def.first] == 0) worklist.push_back(def.first);
+    }
+
+    while (!worklist.empty()) {
+        std::string name = worklist.back();
+        worklist.pop_back();
+        auto it = definition.find(name);
+        if (it == definition.end()) continue;
+        auto& instr = cfg.blocks[it->second.first].instructions[it->second.second];
+        if (!instr || !isTackyPure(instr.get())) continue;
+
+        for (auto* use : tackyUses(instr.get())) {
+            const std::string* used = tackyVarName(use->get());
+            if (used && --useCount[*used] == 0) worklist.push_back(*used);
+        }
+        instr.reset();
+        definition.erase(it);
+    }
+
+    for (auto& block : cfg.blocks) {
+        auto& instrs = block.instructions;
+        instrs.erase(std::remove(instrs.begin(), instrs.end(), nullptr), instrs.end());
+    }
+}
+
+// --- Out of SSA ---
+static void splitCriticalEdges(TackyCFG& cfg) {
+    size_t count = cfg.blocks.size();
+    for (size_t b = 0; b < count; ++b) {
+        auto& block = cfg.blocks[b];
+        if (block.instructions.empty() || block.instructions.back()->type == TackyIRNodeType::RETURN) continue;
+        auto& last = block.instructions.back();
+
+        // a conditional jump whose target is also its fallthrough is just a fallthrough
+        if ((last->type == TackyIRNodeType::JUMP_IF_ZERO || last->type == TackyIRNodeType::JUMP_IF_NOT_ZERO) &&
+            block.successors.size() == 1) {
+            block.instructions.pop_back();
+        }
+    }
+    recomputeTackyEdges(cfg);
+
+    for (size_t b = 0; b < count; ++b) {
+        if (cfg.blocks[b].successors.size() < 2) continue;
+        std::vector<int> succs = cfg.blocks[b].successors;
+
+        for (int succ : succs) {
+            auto& target = cfg.blocks[succ];
+            bool hasPhi = !target.instructions.empty() && target.instructions.front()->type == TackyIRNodeType::PHI;
+            if (!hasPhi || target.predecessors.size() < 2) continue;
+
+            int split = static_cast<int>(cfg.blocks.size());
+            cfg.blocks.emplace_back();
+            auto& edge = cfg.blocks.back();
+            edge.label = makeBlockLabel();
+            edge.fallthrough = succ;
+
+            auto& pred = cfg.blocks[b];
+            auto& last = pred.instructions.back();
+            if (pred.fallthrough == succ) {
+                pred.fallthrough = split;
+            } else if (last->type == TackyIRNodeType::JUMP_IF_ZERO) {
+                static_cast<TackyIRJumpIfZero*>(last.get())->target = edge.label;
+            } else if (last->type == TackyIRNodeType::JUMP_IF_NOT_ZERO) {
+                static_cast<TackyIRJumpIfNotZero*>(last.get())->target = edge.label;
+            }
+
+            for (auto& instr : cfg.blocks[succ].instructions) {
+                if (instr->type != TackyIRNodeType::PHI) break;
+                for (auto& arg : static_cast<TackyIRPhi*>(instr.get())->args) {
+                    if (arg.first == static_cast<int>(b)) arg.first = split;
+                }
+            }
+        }
+    }
+    recomputeTackyEdges(cfg);
+}
+
+struct VarIndex {
+    std::unordered_map<std::string, int> ids;
+    std::vector<std::string> names;
+
+    int get(const std::string& name) {
+        auto it = ids.find(name);
+        if (it != ids.end()) return it->second;
+        ids[name] = static_cast<int>(names.size());
+        names.push_back(name);
+        return static_cast<int>(names.size()) - 1;
+    }
+};
+
+static void sequentializeCopies(std::vector<std::pair<std::string, std::unique_ptr<TackyIRNode>>>& pending,
+                                std::vector<std::unique_ptr<TackyIRNode>>& out) {
+    auto readsVar = [&](const std::string& name, size_t except) {
+        for (size_t j = 0; j < pending.size(); ++j) {
+            const std::string* src = tackyVarName(pending[j].second.get());
+            if (j != except && src && *src == name) return true;
+        }
+        return false;
+    };
+
+    while (!pending.empty()) {
+        bool emitted = false;
+        for (size_t i = 0; i < pending.size(); ++i) {
+            if (readsVar(pending[i].first, i)) continue;
+            out.push_back(std::make_unique<TackyIRCopy>(std::move(pending[i].second), std::make_unique<TackyIRVar>(pending[i].first)));
+            pending.erase(pending.begin() + i);
+            emitted = true;
+            break;
+        }
+        if (emitted) continue;
+
+        // every destination is still read by another copy: break the cycle through a temporary
+        std::string saved = pending[0].first;
+        std::string temp = makeTemporary();
+        out.push_back(std::make_unique<TackyIRCopy>(std::make_unique<TackyIRVar>(saved), std::make_unique<TackyIRVar>(temp)));
+        for (auto& copy : pending) {
+            const std::string* src = tackyVarName(copy.second.get());
+            if (src && *src == saved) copy.second = std::make_unique<TackyIRVar>(temp);
+        }
+    }
+}
+
+void destructSSA(TackyCFG& cfg) {
+    splitCriticalEdges(cfg);
+
+    VarIndex vars;
+    for (auto& block : cfg.blocks) {
+        for (auto& instr : block.instructions) {
+            for (auto* use : tackyUses(instr.get())) {
+                const std::string* name = tackyVarName(use->get());
+                if (name) vars.get(*name);
+            }
+            auto* dst = tackyDestination(instr.get());
+            if (dst) vars.get(*tackyVarName(dst->get()));
+        }
+    }
+    size_t n = vars.names.size();
+    size_t blockCount = cfg.blocks.size();
+
+    // --- Liveness (phi defs live at block entry, phi uses at the end of the predecessor) ---
+    std::vector<std::vector<bool>> liveIn(blockCount, std::vector<bool>(n, false));
+    std::vector<std::vector<bool>> liveOut(blockCount, std::vector<bool>(n, false));
+    const std::vector<int>& rpo = cachedReversePostorder(cfg);
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (auto it = rpo.rbegin(); it != rpo.rend(); ++it) {
+            int b = *it;
+            auto& block = cfg.blocks[b];
+
+            std::vector<bool> live(n, false);
+            for (int succ : block.successors) {
+                const auto& succBlock = cfg.blocks[succ];
+                std::vector<bool> phiDefs(n, false);
+                for (auto& instr : succBlock.instructions) {
+                    if (instr->type != TackyIRNodeType::PHI) break;
+                    auto* phi = static_cast<TackyIRPhi*>(instr.get());
+                    phiDefs[vars.get(*tackyVarName(phi->dst.get()))] = true;
+                    for (auto& arg : phi->args) {
+                        const std::string* name = tackyVarName(arg.second.get());
+                        if (arg.first == b && name) live[vars.get(*name)] = true;
+                    }
+                }
+                for (size_t v = 0; v < n; ++v) {
+                    if (liveIn[succ][v] && !phiDefs[v]) live[v] = true;
+                }
+            }
+            liveOut[b] = live;
+
+            for (auto instr = block.instructions.rbegin(); instr != block.instructions.rend(); ++instr) {
+                if ((*instr)->type == TackyIRNodeType::PHI) {
+                    // phi defs stay in live-in so they interfere with everything else live there
+                    continue;
+                }
+                auto* dst = tackyDestination(instr->get());
+                if (dst) live[vars.get(*tackyVarName(dst->get()))] = false;
+                for (auto* use : tackyUses(instr->get())) {
+                    const std::string* name = tackyVarName(use->get());
+                    if (name) live[vars.get(*name)] = true;
+                }
+            }
+            for (auto& instr : block.instructions) {
+                if (instr->type != TackyIRNodeType::PHI) break;
+                live[vars.get(*tackyVarName(static_cast<TackyIRPhi*>(instr.get())->dst.get()))] = true;
+            }
+
+            if (live != liveIn[b]) {
+                liveIn[b] = std::move(live);
+                changed = true;
+            }
+        }
+    }
+
+    // --- Interference between versions of the same variable ---
+    auto origin = [&](int v) -> const std::string& {
+        auto it = cfg.ssaOrigin.find(vars.names[v]);
+        return it == cfg.ssaOrigin.end() ? vars.names[v] : it->second;
+    };
+    std::vector<int> groupOf(n);
+    std::unordered_map<std::string, int> groupIds;
+    for (size_t v = 0; v < n; ++v) {
+        auto it = groupIds.find(origin(static_cast<int>(v)));
+        if (it == groupIds.end()) {
+            int id = static_cast<int>(groupIds.size());
+            groupIds[origin(static_cast<int>(v))] = id;
+            groupOf[v] = id;
+        } else {
+            groupOf[v] = it->second;
+        }
+    }
+
+    std::vector<std::unordered_set<int>> interferes(n);
+    auto addInterference = [&](int a, const std::vector<bool>& live) {
+        for (size_t w = 0; w < n; ++w) {
+            if (live[w] && static_cast<int>(w) != a && groupOf[w] == groupOf[a]) {
+                interferes[a].insert(static_cast<int>(w));
+                interferes[w].insert(a);
+            }
+        }
+    };
+
+    for (size_t b = 0; b < blockCount; ++b) {
+        auto& block = cfg.blocks[b];
+        std::vector<bool> live = liveOut[b];
+        for (auto instr = block.instructions.rbegin(); instr != block.instructions.rend(); ++instr) {
+            if ((*instr)->type == TackyIRNodeType::PHI) break;
+            auto* dst = tackyDestination(instr->get());
+            if (dst) {
+                int d = vars.get(*tackyVarName(dst->get()));
+                // a copy's source may share a slot with its destination
+                const std::string* src = (*instr)->type == TackyIRNodeType::COPY
+                    ? tackyVarName(static_cast<TackyIRCopy*>(instr->get())->src.get()) : nullptr;
+                bool srcLive = src && live[vars.get(*src)];
+                if (srcLive) live[vars.get(*src)] = false;
+                addInterference(d, live);
+                if (srcLive) live[vars.get(*src)] = true;
+                live[d] = false;
+            }
+            for (auto* use : tackyUses(instr->get())) {
+                const std::string* name = tackyVarName(use->get());
+                if (name) live[vars.get(*name)] = true;
+            }
+        }
+        for (auto& instr : block.instructions) {
+            if (instr->type != TackyIRNodeType::PHI) break;
+            addInterference(vars.get(*tackyVarName(static_cast<TackyIRPhi*>(instr.get())->dst.get())), liveIn[b]);
+        }
+    }
+
+    // --- Greedy coalescing of each variable's versions into as few names as possible ---
+    std::vector<std::string> assigned(n);
+    std::unordered_map<int, std::vector<std::vector<int>>> classes;
+    for (size_t v = 0; v < n; ++v) {
+        auto& groupClasses = classes[groupOf[v]];
+        size_t c = 0;
+        for (; c < groupClasses.size(); ++c) {
+            bool conflict = false;
+            for (int member : groupClasses[c]) {
+                if (interferes[v].count(member)) {
+                    conflict = true;
+                    break;
+                }
+            }
+            if (!conflict) break;
+        }
+        if (c == groupClasses.size()) groupClasses.emplace_back();
+        groupClasses[c].push_back(static_cast<int>(v));
+        assigned[v] = c == 0 ? origin(static_cast<int>(v)) : origin(static_cast<int>(v)) + ".c" + std::to_string(c);
+    }
+
+    auto rewrite = [&](std::unique_ptr<TackyIRNode>& operand) {
+        const std::string* name = tackyVarName(operand.get());
+        if (name) operand = std::make_unique<TackyIRVar>(assigned[vars.get(*name)]);
+    };
+    for (auto& block : cfg.blocks) {
+        for (auto& instr : block.instructions) {
+            for (auto* use : tackyUses(instr.get())) rewrite(*use);
+            auto* dst = tackyDestination(instr.get());
+            if (dst) rewrite(*dst);
+        }
+    }
+
+    // --- Lower phis to copies at the end of each predecessor ---
+    for (size_t b = 0; b < blockCount; ++b) {
+        auto& instrs = cfg.blocks[b].instructions;
+        size_t phiCount = 0;
+        while (phiCount < instrs.size() && instrs[phiCount]->type == TackyIRNodeType::PHI) phiCount++;
+        if (phiCount == 0) continue;
+
+        for (int pred : cfg.blocks[b].predecessors) {
+            std::vector<std::pair<std::string, std::unique_ptr<TackyIRNode>>> pending;
+            for (size_t i = 0; i < phiCount; ++i) {
+                auto* phi = static_cast<TackyIRPhi*>(instrs[i].get());
+                const std::string& dst = *tackyVarName(phi->dst.get());
+                for (auto& arg : phi->args) {
+                    if (arg.first != pred) continue;
+                    const std::string* src = tackyVarName(arg.second.get());
+                    if (!src || *src != dst)
+                        pending.push_back({dst, cloneTackyOperand(arg.second.get())});
+                }
+            }
+
+            std::vector<std::unique_ptr<TackyIRNode>> copies;
+            sequentializeCopies(pending, copies);
+
+            auto& predInstrs = cfg.blocks[pred].instructions;
+            auto pos = predInstrs.end();
+            if (!predInstrs.empty() && isTackyTerminator(predInstrs.back().get())) --pos;
+            predInstrs.insert(pos, std::make_move_iterator(copies.begin()), std::make_move_iterator(copies.end()));
+        }
+        instrs.erase(instrs.begin(), instrs.begin() + phiCount);
+    }
+
+    for (auto& block : cfg.blocks) {
+        auto& instrs = block.instructions;
+        instrs.erase(std::remove_if(instrs.begin(), instrs.end(), [](const std::unique_ptr<TackyIRNode>& instr) {
+            if (instr->type != TackyIRNodeType::COPY) return false;
+            auto* copy = static_cast<TackyIRCopy*>(instr.get());
+            const std::string* src = tackyVarName(copy->src.get());
+            return src && *src == *tackyVarName(copy->dst.get());
+        }), instrs.end());
+    }
+    cfg.ssaOrigin.clear();
+}
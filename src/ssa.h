@@ -0,0 +1,14 @@
+#ifndef SSA_H
+#define SSA_H
+
+#include "tacky_cfg.h"
+
+// Pruned-by-liveness SSA construction (Cytron et al.) over a TACKY CFG.
+void buildSSA(TackyCFG& cfg);
+// Out-of-SSA translation: coalesces non-interfering versions back onto their
+// original variable and lowers phis to (sequentialized) parallel copies.
+void destructSSA(TackyCFG& cfg);
+// Removes pure definitions whose SSA name is never used.
+void passDeadCodeElimination(TackyCFG& cfg);
+
+#endif
@@ -0,0 +1,153 @@
+#include "stack_forwarding.h"
+#include "asm_liveness.h"
+#include <map>
+#include <set>
+
+using AsmInstructions = std::vector<std::unique_ptr<AsmIRNode>>;
+
+static bool isStack(const AsmIROperand& operand) {
+    return operand.type == AsmIRNodeType::STACK;
+}
+
+static int slotOf(const AsmIROperand& operand) {
+    return static_cast<int>(operand.value);
+}
+
+// Operand slots that are only read, so a register can stand in for memory there
+static std::vector<AsmIROperand*> readOnlyOperands(AsmIRNode* instr) {
+    switch (instr->type) {
+        case AsmIRNodeType::MOV: return {&static_cast<AsmIRMov*>(instr)->src};
+        case AsmIRNodeType::BINARY: return {&static_cast<AsmIRBinary*>(instr)->operand1};
+        case AsmIRNodeType::CMP: return {&static_cast<AsmIRCmp*>(instr)->operand1, &static_cast<AsmIRCmp*>(instr)->operand2};
+        case AsmIRNodeType::TEST: return {&static_cast<AsmIRTest*>(instr)->operand1, &static_cast<AsmIRTest*>(instr)->operand2};
+        case AsmIRNodeType::IDIV: return {&static_cast<AsmIRIdiv*>(instr)->operand};
+        case AsmIRNodeType::IMUL_WIDE: return {&static_cast<AsmIRImulWide*>(instr)->operand};
+        case AsmIRNodeType::MOVZX: return {&static_cast<AsmIRMovZeroExtend*>(instr)->src};
+        default: return {};
+    }
+}
+
+// --- Forwarding ---
+struct SlotRegisters {
+    std::map<int, AsmIRRegister> holder; // slot -> register holding its current value
+
+    void forgetRegister(AsmIRRegister reg) {
+        for (auto it = holder.begin(); it != holder.end();) {
+            if (it->second == reg) it = holder.erase(it);
+            else ++it;
+        }
+    }
+};
+
+static void forwardBlock(AsmInstructions& instrs, size_t begin, size_t end) {
+    SlotRegisters state;
+    for (size_t i = begin; i < end; ++i) {
+        AsmIRNode* instr = instrs[i].get();
+
+        for (auto* operand : readOnlyOperands(instr)) {
+            if (!isStack(*operand)) continue;
+            auto it = state.holder.find(slotOf(*operand));
+            if (it != state.holder.end()) *operand = asmReg(it->second);
+        }
+
+        // a mov between a register and a slot leaves both holding the same value
+        int loadedSlot = 0;
+        bool stored = false;
+        if (instr->type == AsmIRNodeType::MOV) {
+            auto* move = static_cast<AsmIRMov*>(instr);
+            if (isStack(move->src) && move->dst.type == AsmIRNodeType::REGISTER) loadedSlot = slotOf(move->src);
+            stored = move->src.type == AsmIRNodeType::REGISTER && isStack(move->dst);
+        }
+
+        for (auto* def : asmDefinitions(instr)) {
+            if (isStack(*def)) state.holder.erase(slotOf(*def));
+            else if (def->type == AsmIRNodeType::REGISTER) state.forgetRegister(def->reg);
+        }
+        for (AsmIRRegister reg : asmImplicitDefinitions(instr)) state.forgetRegister(reg);
+
+        if (loadedSlot != 0 && !state.holder.count(loadedSlot))
+            state.holder[loadedSlot] = static_cast<AsmIRMov*>(instr)->dst.reg;
+        if (stored) {
+            auto* move = static_cast<AsmIRMov*>(instr);
+            state.holder[slotOf(move->dst)] = move->src.reg;
+        }
+    }
+}
+
+// --- Dead Stores ---
+// A slot is read by any operand that mentions it except a destination. setcc only writes
+// the low byte, so it doesn't kill the slot either.
+static void slotEffects(AsmIRNode* instr, std::set<int>& reads, std::set<int>& kills) {
+    auto uses = asmUses(instr);
+    for (auto* use : uses) {
+        if (isStack(*use)) reads.insert(slotOf(*use));
+    }
+    if (instr->type == AsmIRNodeType::MOV && isStack(static_cast<AsmIRMov*>(instr)->dst))
+        kills.insert(slotOf(static_cast<AsmIRMov*>(instr)->dst));
+    if (instr->type == AsmIRNodeType::MOVZX && isStack(static_cast<AsmIRMovZeroExtend*>(instr)->dst))
+        kills.insert(slotOf(static_cast<AsmIRMovZeroExtend*>(instr)->dst));
+}
+
+static bool removeDeadStores(AsmInstructions& instrs, AsmAnalyses& analyses) {
+    const std::vector<AsmBlock>& blocks = analyses.blocks(instrs);
+    std::vector<std::set<int>> liveIn(blocks.size()), liveOut(blocks.size());
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t b = blocks.size(); b-- > 0;) {
+            std::set<int> live;
+            for (int succ : blocks[b].successors) live.insert(liveIn[succ].begin(), liveIn[succ].end());
+            liveOut[b] = live;
+            for (size_t i = blocks[b].end; i-- > blocks[b].begin;) {
+                std::set<int> reads, kills;
+                slotEffects(instrs[i].get(), reads, kills);
+                for (int slot : kills) live.erase(slot);
+                live.insert(reads.begin(), reads.end());
+            }
+            if (live != liveIn[b]) {
+                liveIn[b] = std::move(live);
+                changed = true;
+            }
+        }
+    }
+
+    std::vector<bool> dead(instrs.size(), false);
+    bool removed = false;
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        std::set<int> live = liveOut[b];
+        for (size_t i = blocks[b].end; i-- > blocks[b].begin;) {
+            AsmIRNode* instr = instrs[i].get();
+            // movs don't touch the flags, so a dead one can go without further checks
+            if (instr->type == AsmIRNodeType::MOV && isStack(static_cast<AsmIRMov*>(instr)->dst) &&
+                !live.count(slotOf(static_cast<AsmIRMov*>(instr)->dst))) {
+                dead[i] = removed = true;
+                continue;
+            }
+            std::set<int> reads, kills;
+            slotEffects(instr, reads, kills);
+            for (int slot : kills) live.erase(slot);
+            live.insert(reads.begin(), reads.end());
+        }
+    }
+    if (!removed) return false;
+
+    AsmInstructions kept;
+    for (size_t i = 0; i < instrs.size(); ++i) {
+        if (!dead[i]) kept.push_back(std::move(instrs[i]));
+    }
+    instrs = std::move(kept);
+    analyses.invalidate();
+    return true;
+}
+
+void passForwardStackSlots(AsmIRNode* node, AsmAnalyses& analyses) {
+    if (!node || node->type != AsmIRNodeType::PROGRAM) return;
+    auto* fn = static_cast<AsmIRProgram*>(node)->function.get();
+    if (!fn || !fn->instructions) return;
+    auto& instrs = fn->instructions->instructions;
+
+    // forwarding only rewrites operands, so the blocks carry over to dead-store removal
+    for (const auto& block : analyses.blocks(instrs)) forwardBlock(instrs, block.begin, block.end);
+    while (removeDeadStores(instrs, analyses)) {}
+}
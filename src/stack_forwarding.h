@@ -0,0 +1,12 @@
+#ifndef STACK_FORWARDING_H
+#define STACK_FORWARDING_H
+
+#include "asm_ir.h"
+#include "asm_liveness.h"
+
+// Store-to-load forwarding within each basic block: reads of a stack slot whose value is
+// still in a register use the register instead. Stores to slots that are never read
+// again are then deleted. Runs after passLegalize, on Stack operands.
+void passForwardStackSlots(AsmIRNode* node, AsmAnalyses& analyses);
+
+#endif
@@ -0,0 +1,233 @@
+#include "strength_reduction.h"
+#include "generate_tacky.h"
+#include "target.h"
+#include <vector>
+
+/*
+    Division by a constant d rounds toward zero, so every sequence below has to correct
+    the floor that shifts and multiply-high compute for negative dividends. The x86
+    instructions wrap, which the magic-number derivation already assumes.
+*/
+
+static AsmIROperand operandOf(const TackyIRNode* node) {
+    if (node->type == TackyIRNodeType::CONSTANT)
+        return asmImm(std::stoll(static_cast<const TackyIRConstant*>(node)->value));
+    return asmPseudo(static_cast<const TackyIRVar*>(node)->value);
+}
+
+static AsmIROperand pseudo(const std::string& name) {
+    return asmPseudo(name);
+}
+
+static AsmIROperand imm(int64_t value) {
+    return asmImm(value);
+}
+
+static void emitBinary(AsmIRInstructions* instructions, AsmIRNodeType op, AsmIROperand src, AsmIROperand dst) {
+    instructions->instructions.push_back(std::make_unique<AsmIRBinary>(op, src, dst));
+}
+
+static void emitMov(AsmIRInstructions* instructions, AsmIROperand src, AsmIROperand dst) {
+    instructions->instructions.push_back(std::make_unique<AsmIRMov>(src, dst));
+}
+
+static bool isPowerOfTwo(uint32_t value) {
+    return value != 0 && (value & (value - 1)) == 0;
+}
+
+static int log2Exact(uint32_t value) {
+    int shift = 0;
+    while (value > 1) {
+        value >>= 1;
+        shift++;
+    }
+    return shift;
+}
+
+// --- Magic Numbers ---
+// Hacker's Delight 10-1: the smallest M and shift s with q = (mulhs(M, n) >> s) + (n < 0)
+// for every 32-bit n. |d| must be at least 2.
+struct SignedMagic {
+    int32_t multiplier;
+    int shift;
+};
+
+static SignedMagic signedMagic(int32_t d) {
+    const uint32_t two31 = 0x80000000u;
+    uint32_t ad = d < 0 ? 0u - static_cast<uint32_t>(d) : static_cast<uint32_t>(d);
+    uint32_t t = two31 + (static_cast<uint32_t>(d) >> 31);
+    uint32_t anc = t - 1 - t % ad;
+    int p = 31;
+    uint32_t q1 = two31 / anc, r1 = two31 - q1 * anc;
+    uint32_t q2 = two31 / ad, r2 = two31 - q2 * ad;
+    uint32_t delta;
+    do {
+        p++;
+        q1 *= 2;
+        r1 *= 2;
+        if (r1 >= anc) {
+            q1++;
+            r1 -= anc;
+        }
+        q2 *= 2;
+        r2 *= 2;
+        if (r2 >= ad) {
+            q2++;
+            r2 -= ad;
+        }
+        delta = ad - r2;
+    } while (q1 < delta || (q1 == delta && r1 == 0));
+
+    uint32_t m = q2 + 1;
+    if (d < 0) m = 0u - m;
+    return {static_cast<int32_t>(m), p - 32};
+}
+
+// Critical path of the multiply-high sequence below against cdq + idivl. On every target
+// so far the multiply wins, but a fast enough divider would keep the idivl.
+static bool beatsIdiv(SignedMagic magic, int32_t divisor, bool remainder) {
+    int latency = targetLatency(InstrClass::MULTIPLY_WIDE);
+    if ((divisor > 0) != (magic.multiplier > 0)) latency += targetLatency(InstrClass::ALU);
+    if (magic.shift > 0) latency += targetLatency(InstrClass::SHIFT);
+    latency += targetLatency(InstrClass::SHIFT) + targetLatency(InstrClass::ALU);
+    if (remainder) latency += targetLatency(InstrClass::MULTIPLY) + targetLatency(InstrClass::ALU);
+    return latency < targetLatency(InstrClass::ALU) + targetLatency(InstrClass::DIVIDE);
+}
+
+// --- Division ---
+bool lowerDivideByConstant(const TackyIRNode* dividend, int32_t divisor, bool remainder, const TackyIRNode* dst, AsmIRInstructions* instructions) {
+    if (divisor == 0 || !instructions) return false;
+
+    if (divisor == 1 || divisor == -1) {
+        if (remainder) {
+            emitMov(instructions, imm(0), operandOf(dst));
+        } else {
+            emitMov(instructions, operandOf(dividend), operandOf(dst));
+            if (divisor == -1)
+                instructions->instructions.push_back(std::make_unique<AsmIRUnary>(AsmIRNodeType::NEG, operandOf(dst)));
+        }
+        return true;
+    }
+
+    uint32_t magnitude = divisor < 0 ? 0u - static_cast<uint32_t>(divisor) : static_cast<uint32_t>(divisor);
+    SignedMagic magic{0, 0};
+    if (!isPowerOfTwo(magnitude)) {
+        magic = signedMagic(divisor);
+        if (!beatsIdiv(magic, divisor, remainder)) return false;
+    }
+
+    // the dividend is read again after the quotient is formed, and dst may share its name
+    std::string n = makeTemporary();
+    emitMov(instructions, operandOf(dividend), pseudo(n));
+
+    if (isPowerOfTwo(magnitude)) {
+        /*
+            Mov(n, t)
+            Binary(Sar, 31, t)        -- all ones when n is negative
+            Binary(Shr, 32 - k, t)    -- bias = 2^k - 1 for negative n, else 0
+            Binary(Add, n, t)
+            Binary(Sar, k, t)         -- or And(-2^k, t) and n - t for the remainder
+        */
+        int k = log2Exact(magnitude);
+        std::string t = makeTemporary();
+        emitMov(instructions, pseudo(n), pseudo(t));
+        if (k > 1) emitBinary(instructions, AsmIRNodeType::SAR, imm(31), pseudo(t));
+        emitBinary(instructions, AsmIRNodeType::SHR, imm(32 - k), pseudo(t));
+        emitBinary(instructions, AsmIRNodeType::ADD, pseudo(n), pseudo(t));
+
+        if (remainder) {
+            emitBinary(instructions, AsmIRNodeType::AND, imm(-(int64_t(1) << k)), pseudo(t));
+            emitMov(instructions, pseudo(n), operandOf(dst));
+            emitBinary(instructions, AsmIRNodeType::SUBTRACT, pseudo(t), operandOf(dst));
+        } else {
+            emitBinary(instructions, AsmIRNodeType::SAR, imm(k), pseudo(t));
+            if (divisor < 0)
+                instructions->instructions.push_back(std::make_unique<AsmIRUnary>(AsmIRNodeType::NEG, pseudo(t)));
+            emitMov(instructions, pseudo(t), operandOf(dst));
+        }
+        return true;
+    }
+
+    /*
+        Mov(M, Reg(AX))
+        ImulWide(n)               -- EDX = high half of M * n
+        Mov(Reg(DX), q)
+        Binary(Add | Sub, n, q)   -- only when M's sign disagrees with d's
+        Binary(Sar, s, q)
+        Mov(q, t)
+        Binary(Shr, 31, t)
+        Binary(Add, t, q)         -- round toward zero
+    */
+    std::string q = makeTemporary();
+    std::string t = makeTemporary();
+    emitMov(instructions, imm(magic.multiplier), asmReg(AsmIRRegister::AX));
+    instructions->instructions.push_back(std::make_unique<AsmIRImulWide>(pseudo(n)));
+    emitMov(instructions, asmReg(AsmIRRegister::DX), pseudo(q));
+    if (divisor > 0 && magic.multiplier < 0) emitBinary(instructions, AsmIRNodeType::ADD, pseudo(n), pseudo(q));
+    if (divisor < 0 && magic.multiplier > 0) emitBinary(instructions, AsmIRNodeType::SUBTRACT, pseudo(n), pseudo(q));
+    if (magic.shift > 0) emitBinary(instructions, AsmIRNodeType::SAR, imm(magic.shift), pseudo(q));
+    emitMov(instructions, pseudo(q), pseudo(t));
+    emitBinary(instructions, AsmIRNodeType::SHR, imm(31), pseudo(t));
+    emitBinary(instructions, AsmIRNodeType::ADD, pseudo(t), pseudo(q));
+
+    if (remainder) {
+        // n - q * d
+        emitBinary(instructions, AsmIRNodeType::MULTIPLY, imm(divisor), pseudo(q));
+        emitMov(instructions, pseudo(n), operandOf(dst));
+        emitBinary(instructions, AsmIRNodeType::SUBTRACT, pseudo(q), operandOf(dst));
+    } else {
+        emitMov(instructions, pseudo(q), operandOf(dst));
+    }
+    return true;
+}
+
+// --- Multiplication ---
+/*
+    |c| = f1 * f2 * 2^k with each f in {3, 5, 9} becomes up to two leal and a shift, plus a
+    negation for negative c. Of the factorings of c, the one with the shortest latency on
+    the -mtune target wins, and it replaces the imull when it's no slower, which also
+    leaves the multiplier free.
+*/
+bool lowerMultiplyByConstant(const std::string& factor, int32_t multiplier, const std::string& dst, AsmIRInstructions* instructions) {
+    if (!instructions) return false;
+
+    uint32_t magnitude = multiplier < 0 ? 0u - static_cast<uint32_t>(multiplier) : static_cast<uint32_t>(multiplier);
+    if (magnitude == 0) {
+        emitMov(instructions, imm(0), pseudo(dst));
+        return true;
+    }
+
+    // fewer leal first, so a tie keeps the shorter sequence
+    static const std::vector<std::vector<int>> factorings = {
+        {}, {9}, {5}, {3}, {9, 9}, {9, 5}, {9, 3}, {5, 5}, {5, 3}, {3, 3},
+    };
+    const std::vector<int>* leaFactors = nullptr;
+    int shift = 0;
+    int bestLatency = 0;
+    for (const auto& factoring : factorings) {
+        uint32_t rest = magnitude;
+        for (int f : factoring) rest = rest % f == 0 ? rest / f : 0;
+        if (!isPowerOfTwo(rest)) continue;
+        int k = log2Exact(rest);
+        int latency = static_cast<int>(factoring.size()) * targetLatency(InstrClass::LEA_SCALED);
+        if (k > 0) latency += targetLatency(InstrClass::SHIFT);
+        if (multiplier < 0) latency += targetLatency(InstrClass::ALU);
+        if (!leaFactors || latency < bestLatency) {
+            leaFactors = &factoring;
+            shift = k;
+            bestLatency = latency;
+        }
+    }
+    if (!leaFactors || bestLatency > targetLatency(InstrClass::MULTIPLY)) return false;
+
+    std::string src = factor;
+    for (int f : *leaFactors) {
+        instructions->instructions.push_back(std::make_unique<AsmIRLea>(pseudo(src), pseudo(src), f - 1, 0, pseudo(dst)));
+        src = dst;
+    }
+    if (src != dst) emitMov(instructions, pseudo(src), pseudo(dst));
+    if (shift > 0) emitBinary(instructions, AsmIRNodeType::SHL, imm(shift), pseudo(dst));
+    if (multiplier < 0)
+        instructions->instructions.push_back(std::make_unique<AsmIRUnary>(AsmIRNodeType::NEG, pseudo(dst)));
+    return true;
+}
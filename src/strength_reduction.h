@@ -0,0 +1,15 @@
+#ifndef STRENGTH_REDUCTION_H
+#define STRENGTH_REDUCTION_H
+
+#include "asm_ir.h"
+#include "tacky_ir.h"
+#include <cstdint>
+
+// Constant-operand lowerings used in place of cdq/idivl and imull. Each appends its
+// sequence to instructions, writing the result to dst, and returns false without emitting
+// anything when the constant has no cheaper form. Multiplication works on pseudo names
+// because the instruction selector calls it on intermediate results.
+bool lowerDivideByConstant(const TackyIRNode* dividend, int32_t divisor, bool remainder, const TackyIRNode* dst, AsmIRInstructions* instructions);
+bool lowerMultiplyByConstant(const std::string& factor, int32_t multiplier, const std::string& dst, AsmIRInstructions* instructions);
+
+#endif
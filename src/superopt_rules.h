@@ -0,0 +1,371 @@
+// Generated by tools/superopt.cpp; rerun it rather than editing. 112 rules.
+// Samples: tools/superopt_corpus.py, seed 48, 300 programs x fold + nofold, 2405 distinct windows.
+#ifndef SUPEROPT_RULES_H
+#define SUPEROPT_RULES_H
+
+#include "asm_ir.h"
+
+// Operands name slots 0-2, which bind to distinct registers, or take imm instead
+constexpr int8_t SUPEROPT_IMMEDIATE = -1;
+constexpr int8_t SUPEROPT_NONE = -2;
+
+struct SuperoptInstr {
+    AsmIRNodeType op = AsmIRNodeType::NONE; // MOV, MOVZX, LEA, CMP, TEST, SET_CC or the Unary/Binary operator
+    int8_t src = SUPEROPT_NONE;             // Lea's base
+    int8_t index = SUPEROPT_NONE;           // Lea only
+    int8_t dst = SUPEROPT_NONE;
+    int32_t imm = 0;                        // immediate source, shift count or Lea displacement
+    int8_t scale = 1;
+    AsmIRCondCode cond = AsmIRCondCode::E;
+};
+
+// replacement leaves every slot as source does. Unless neither touches the flags, the
+// flags must be dead afterwards.
+struct SuperoptRule {
+    int sourceLength;
+    SuperoptInstr source[3];
+    int replacementLength;
+    SuperoptInstr replacement[2];
+    bool clobbersFlags;
+};
+
+static const SuperoptRule superoptRules[] = {
+    // movl %0, %0  =>  (nothing)
+    {1, {{AsmIRNodeType::MOV, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {}, {}},
+     0, {{}, {}}, false},
+    // addl $0, %0  =>  (nothing)
+    {1, {{AsmIRNodeType::ADD, -1, -2, 0, 0, 1, AsmIRCondCode::E}, {}, {}},
+     0, {{}, {}}, true},
+    // subl $0, %0  =>  (nothing)
+    {1, {{AsmIRNodeType::SUBTRACT, -1, -2, 0, 0, 1, AsmIRCondCode::E}, {}, {}},
+     0, {{}, {}}, true},
+    // imull $0, %0  =>  movl $0, %0
+    {1, {{AsmIRNodeType::MULTIPLY, -1, -2, 0, 0, 1, AsmIRCondCode::E}, {}, {}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 0, 0, 1, AsmIRCondCode::E}, {}}, true},
+    // imull $1, %0  =>  (nothing)
+    {1, {{AsmIRNodeType::MULTIPLY, -1, -2, 0, 1, 1, AsmIRCondCode::E}, {}, {}},
+     0, {{}, {}}, true},
+    // imull $-1, %0  =>  negl %0
+    {1, {{AsmIRNodeType::MULTIPLY, -1, -2, 0, -1, 1, AsmIRCondCode::E}, {}, {}},
+     1, {{AsmIRNodeType::NEG, -2, -2, 0, 0, 1, AsmIRCondCode::E}, {}}, true},
+    // imull $2, %0  =>  addl %0, %0
+    {1, {{AsmIRNodeType::MULTIPLY, -1, -2, 0, 2, 1, AsmIRCondCode::E}, {}, {}},
+     1, {{AsmIRNodeType::ADD, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {}}, true},
+    // andl %0, %0  =>  (nothing)
+    {1, {{AsmIRNodeType::AND, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {}, {}},
+     0, {{}, {}}, true},
+    // andl $-1, %0  =>  (nothing)
+    {1, {{AsmIRNodeType::AND, -1, -2, 0, -1, 1, AsmIRCondCode::E}, {}, {}},
+     0, {{}, {}}, true},
+    // orl %0, %0  =>  (nothing)
+    {1, {{AsmIRNodeType::OR, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {}, {}},
+     0, {{}, {}}, true},
+    // orl $0, %0  =>  (nothing)
+    {1, {{AsmIRNodeType::OR, -1, -2, 0, 0, 1, AsmIRCondCode::E}, {}, {}},
+     0, {{}, {}}, true},
+    // xorl $0, %0  =>  (nothing)
+    {1, {{AsmIRNodeType::XOR, -1, -2, 0, 0, 1, AsmIRCondCode::E}, {}, {}},
+     0, {{}, {}}, true},
+    // movl %0, %1; subl %0, %1  =>  movl $0, %1  (seen 9x)
+    {2, {{AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SUBTRACT, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 1, 0, 1, AsmIRCondCode::E}, {}}, true},
+    // negl %0; notl %0  =>  addl $-1, %0  (seen 7x)
+    {2, {{AsmIRNodeType::NEG, -2, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::NOT, -2, -2, 0, 0, 1, AsmIRCondCode::E}, {}},
+     1, {{AsmIRNodeType::ADD, -1, -2, 0, -1, 1, AsmIRCondCode::E}, {}}, true},
+    // movl %0, %1; xorl %1, %1  =>  movl $0, %1  (seen 6x)
+    {2, {{AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::XOR, 1, -2, 1, 0, 1, AsmIRCondCode::E}, {}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 1, 0, 1, AsmIRCondCode::E}, {}}, true},
+    // movzbl %0, %0; xorl %0, %0  =>  movl $0, %0  (seen 5x)
+    {2, {{AsmIRNodeType::MOVZX, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::XOR, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 0, 0, 1, AsmIRCondCode::E}, {}}, true},
+    // movl %0, %1; movl %1, %0  =>  movl %0, %1  (seen 3x)
+    {2, {{AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 1, -2, 0, 0, 1, AsmIRCondCode::E}, {}},
+     1, {{AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {}}, false},
+    // notl %0; negl %0  =>  addl $1, %0  (seen 3x)
+    {2, {{AsmIRNodeType::NOT, -2, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::NEG, -2, -2, 0, 0, 1, AsmIRCondCode::E}, {}},
+     1, {{AsmIRNodeType::ADD, -1, -2, 0, 1, 1, AsmIRCondCode::E}, {}}, true},
+    // imull %0, %1; xorl %1, %1  =>  movl $0, %1  (seen 3x)
+    {2, {{AsmIRNodeType::MULTIPLY, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::XOR, 1, -2, 1, 0, 1, AsmIRCondCode::E}, {}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 1, 0, 1, AsmIRCondCode::E}, {}}, true},
+    // leal (%0, %1, 1), %0; xorl %0, %0  =>  movl $0, %0  (seen 2x)
+    {2, {{AsmIRNodeType::LEA, 0, 1, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::XOR, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 0, 0, 1, AsmIRCondCode::E}, {}}, true},
+    // notl %0; notl %0  =>  (nothing)  (seen 2x)
+    {2, {{AsmIRNodeType::NOT, -2, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::NOT, -2, -2, 0, 0, 1, AsmIRCondCode::E}, {}},
+     0, {{}, {}}, false},
+    // subl %0, %1; xorl %1, %1  =>  movl $0, %1  (seen 2x)
+    {2, {{AsmIRNodeType::SUBTRACT, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::XOR, 1, -2, 1, 0, 1, AsmIRCondCode::E}, {}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 1, 0, 1, AsmIRCondCode::E}, {}}, true},
+    // andl %0, %1; xorl %1, %1  =>  movl $0, %1  (seen 2x)
+    {2, {{AsmIRNodeType::AND, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::XOR, 1, -2, 1, 0, 1, AsmIRCondCode::E}, {}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 1, 0, 1, AsmIRCondCode::E}, {}}, true},
+    // movl $1, %0; leal 1(%0), %0  =>  movl $2, %0  (seen 1x)
+    {2, {{AsmIRNodeType::MOV, -1, -2, 0, 1, 1, AsmIRCondCode::E}, {AsmIRNodeType::LEA, 0, -2, 0, 1, 1, AsmIRCondCode::E}, {}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 0, 2, 1, AsmIRCondCode::E}, {}}, false},
+    // movl $1, %0; negl %0  =>  movl $-1, %0  (seen 1x)
+    {2, {{AsmIRNodeType::MOV, -1, -2, 0, 1, 1, AsmIRCondCode::E}, {AsmIRNodeType::NEG, -2, -2, 0, 0, 1, AsmIRCondCode::E}, {}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 0, -1, 1, AsmIRCondCode::E}, {}}, true},
+    // movl %0, %1; leal (%1, %2, 1), %1  =>  leal (%0, %2, 1), %1  (seen 1x)
+    {2, {{AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::LEA, 1, 2, 1, 0, 1, AsmIRCondCode::E}, {}},
+     1, {{AsmIRNodeType::LEA, 0, 2, 1, 0, 1, AsmIRCondCode::E}, {}}, false},
+    // movl %0, %1; subl %1, %1  =>  movl $0, %1  (seen 1x)
+    {2, {{AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SUBTRACT, 1, -2, 1, 0, 1, AsmIRCondCode::E}, {}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 1, 0, 1, AsmIRCondCode::E}, {}}, true},
+    // movzbl %0, %0; subl %0, %0  =>  movl $0, %0  (seen 1x)
+    {2, {{AsmIRNodeType::MOVZX, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SUBTRACT, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 0, 0, 1, AsmIRCondCode::E}, {}}, true},
+    // leal (, %0, 8), %0; leal (%1, %0, 1), %0  =>  leal (%1, %0, 8), %0  (seen 1x)
+    {2, {{AsmIRNodeType::LEA, -2, 0, 0, 0, 8, AsmIRCondCode::E}, {AsmIRNodeType::LEA, 1, 0, 0, 0, 1, AsmIRCondCode::E}, {}},
+     1, {{AsmIRNodeType::LEA, 1, 0, 0, 0, 8, AsmIRCondCode::E}, {}}, false},
+    // leal (%0, %1, 1), %2; leal (%1, %2, 1), %2  =>  leal (%0, %1, 2), %2  (seen 1x)
+    {2, {{AsmIRNodeType::LEA, 0, 1, 2, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::LEA, 1, 2, 2, 0, 1, AsmIRCondCode::E}, {}},
+     1, {{AsmIRNodeType::LEA, 0, 1, 2, 0, 2, AsmIRCondCode::E}, {}}, false},
+    // leal (%0, %1, 1), %2; xorl %2, %2  =>  movl $0, %2  (seen 1x)
+    {2, {{AsmIRNodeType::LEA, 0, 1, 2, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::XOR, 2, -2, 2, 0, 1, AsmIRCondCode::E}, {}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 2, 0, 1, AsmIRCondCode::E}, {}}, true},
+    // notl %0; xorl %0, %0  =>  movl $0, %0  (seen 1x)
+    {2, {{AsmIRNodeType::NOT, -2, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::XOR, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 0, 0, 1, AsmIRCondCode::E}, {}}, true},
+    // subl %0, %0; subl %0, %1  =>  movl $0, %0  (seen 1x)
+    {2, {{AsmIRNodeType::SUBTRACT, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SUBTRACT, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 0, 0, 1, AsmIRCondCode::E}, {}}, true},
+    // subl %0, %1; leal (%0, %1, 1), %1  =>  (nothing)  (seen 1x)
+    {2, {{AsmIRNodeType::SUBTRACT, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::LEA, 0, 1, 1, 0, 1, AsmIRCondCode::E}, {}},
+     0, {{}, {}}, true},
+    // orl %0, %1; xorl %1, %1  =>  movl $0, %1  (seen 1x)
+    {2, {{AsmIRNodeType::OR, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::XOR, 1, -2, 1, 0, 1, AsmIRCondCode::E}, {}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 1, 0, 1, AsmIRCondCode::E}, {}}, true},
+    // xorl %0, %0; leal 1(%0), %0  =>  movl $1, %0  (seen 1x)
+    {2, {{AsmIRNodeType::XOR, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::LEA, 0, -2, 0, 1, 1, AsmIRCondCode::E}, {}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 0, 1, 1, AsmIRCondCode::E}, {}}, true},
+    // xorl %0, %0; leal (%0, %0, 4), %0  =>  movl $0, %0  (seen 1x)
+    {2, {{AsmIRNodeType::XOR, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::LEA, 0, 0, 0, 0, 4, AsmIRCondCode::E}, {}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 0, 0, 1, AsmIRCondCode::E}, {}}, true},
+    // xorl %0, %0; negl %0  =>  movl $0, %0  (seen 1x)
+    {2, {{AsmIRNodeType::XOR, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::NEG, -2, -2, 0, 0, 1, AsmIRCondCode::E}, {}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 0, 0, 1, AsmIRCondCode::E}, {}}, true},
+    // xorl %0, %0; notl %0  =>  movl $-1, %0  (seen 1x)
+    {2, {{AsmIRNodeType::XOR, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::NOT, -2, -2, 0, 0, 1, AsmIRCondCode::E}, {}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 0, -1, 1, AsmIRCondCode::E}, {}}, true},
+    // xorl %0, %0; imull %0, %1  =>  movl $0, %0; movl %0, %1  (seen 1x)
+    {2, {{AsmIRNodeType::XOR, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MULTIPLY, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {}},
+     2, {{AsmIRNodeType::MOV, -1, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}}, true},
+    // xorl %0, %0; xorl %0, %0  =>  movl $0, %0  (seen 1x)
+    {2, {{AsmIRNodeType::XOR, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::XOR, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 0, 0, 1, AsmIRCondCode::E}, {}}, true},
+    // movzbl %0, %0; movl %0, %1; xorl %0, %0  =>  movzbl %0, %1; movl $0, %0  (seen 28x)
+    {3, {{AsmIRNodeType::MOVZX, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::XOR, 0, -2, 0, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::MOVZX, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, -1, -2, 0, 0, 1, AsmIRCondCode::E}}, true},
+    // subl %0, %1; testl %1, %1; setne %1  =>  subl %0, %1; setne %1  (seen 14x)
+    {3, {{AsmIRNodeType::SUBTRACT, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::TEST, 1, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SET_CC, -2, -2, 1, 0, 1, AsmIRCondCode::NE}},
+     2, {{AsmIRNodeType::SUBTRACT, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SET_CC, -2, -2, 1, 0, 1, AsmIRCondCode::NE}}, true},
+    // xorl %0, %0; cmpl %1, %1; setle %0  =>  movl $1, %0  (seen 14x)
+    {3, {{AsmIRNodeType::XOR, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::CMP, 1, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SET_CC, -2, -2, 0, 0, 1, AsmIRCondCode::LE}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 0, 1, 1, AsmIRCondCode::E}, {}}, true},
+    // xorl %0, %0; cmpl %1, %1; setl %0  =>  movl $0, %0  (seen 12x)
+    {3, {{AsmIRNodeType::XOR, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::CMP, 1, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SET_CC, -2, -2, 0, 0, 1, AsmIRCondCode::L}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 0, 0, 1, AsmIRCondCode::E}, {}}, true},
+    // xorl %0, %0; cmpl %1, %1; sete %0  =>  movl $1, %0  (seen 11x)
+    {3, {{AsmIRNodeType::XOR, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::CMP, 1, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SET_CC, -2, -2, 0, 0, 1, AsmIRCondCode::E}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 0, 1, 1, AsmIRCondCode::E}, {}}, true},
+    // xorl %0, %0; cmpl %1, %1; setge %0  =>  movl $1, %0  (seen 10x)
+    {3, {{AsmIRNodeType::XOR, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::CMP, 1, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SET_CC, -2, -2, 0, 0, 1, AsmIRCondCode::GE}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 0, 1, 1, AsmIRCondCode::E}, {}}, true},
+    // negl %0; testl %0, %0; setne %0  =>  negl %0; setne %0  (seen 9x)
+    {3, {{AsmIRNodeType::NEG, -2, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::TEST, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SET_CC, -2, -2, 0, 0, 1, AsmIRCondCode::NE}},
+     2, {{AsmIRNodeType::NEG, -2, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SET_CC, -2, -2, 0, 0, 1, AsmIRCondCode::NE}}, true},
+    // xorl %0, %0; cmpl %1, %1; setg %0  =>  movl $0, %0  (seen 9x)
+    {3, {{AsmIRNodeType::XOR, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::CMP, 1, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SET_CC, -2, -2, 0, 0, 1, AsmIRCondCode::G}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 0, 0, 1, AsmIRCondCode::E}, {}}, true},
+    // notl %0; testl %0, %0; setne %0  =>  xorl $-1, %0; setne %0  (seen 8x)
+    {3, {{AsmIRNodeType::NOT, -2, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::TEST, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SET_CC, -2, -2, 0, 0, 1, AsmIRCondCode::NE}},
+     2, {{AsmIRNodeType::XOR, -1, -2, 0, -1, 1, AsmIRCondCode::E}, {AsmIRNodeType::SET_CC, -2, -2, 0, 0, 1, AsmIRCondCode::NE}}, true},
+    // xorl %0, %0; cmpl %1, %1; setne %0  =>  movl $0, %0  (seen 8x)
+    {3, {{AsmIRNodeType::XOR, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::CMP, 1, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SET_CC, -2, -2, 0, 0, 1, AsmIRCondCode::NE}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 0, 0, 1, AsmIRCondCode::E}, {}}, true},
+    // leal (%0, %1, 1), %0; movl %0, %2; xorl %0, %0  =>  leal (%0, %1, 1), %2; movl $0, %0  (seen 4x)
+    {3, {{AsmIRNodeType::LEA, 0, 1, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 0, -2, 2, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::XOR, 0, -2, 0, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::LEA, 0, 1, 2, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, -1, -2, 0, 0, 1, AsmIRCondCode::E}}, true},
+    // cmpl %0, %0; setne %0; movzbl %0, %0  =>  movl $0, %0  (seen 4x)
+    {3, {{AsmIRNodeType::CMP, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SET_CC, -2, -2, 0, 0, 1, AsmIRCondCode::NE}, {AsmIRNodeType::MOVZX, 0, -2, 0, 0, 1, AsmIRCondCode::E}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 0, 0, 1, AsmIRCondCode::E}, {}}, true},
+    // subl %0, %1; testl %1, %1; sete %1  =>  subl %0, %1; sete %1  (seen 4x)
+    {3, {{AsmIRNodeType::SUBTRACT, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::TEST, 1, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SET_CC, -2, -2, 1, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::SUBTRACT, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SET_CC, -2, -2, 1, 0, 1, AsmIRCondCode::E}}, true},
+    // movl $2, %0; movl %0, %1; sarl $31, %1  =>  movl $2, %0; movl $0, %1  (seen 3x)
+    {3, {{AsmIRNodeType::MOV, -1, -2, 0, 2, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SAR, -2, -2, 1, 31, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::MOV, -1, -2, 0, 2, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, -1, -2, 1, 0, 1, AsmIRCondCode::E}}, true},
+    // movl %0, %1; movl %1, %2; movl %1, %0  =>  movl %0, %1; movl %0, %2  (seen 3x)
+    {3, {{AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 1, -2, 2, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 1, -2, 0, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 0, -2, 2, 0, 1, AsmIRCondCode::E}}, false},
+    // movzbl %0, %0; movl %0, %1; movl %2, %0  =>  movzbl %0, %1; movl %2, %0  (seen 3x)
+    {3, {{AsmIRNodeType::MOVZX, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 2, -2, 0, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::MOVZX, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 2, -2, 0, 0, 1, AsmIRCondCode::E}}, false},
+    // movzbl %0, %0; movl %0, %1; subl %1, %0  =>  movzbl %0, %1; movl $0, %0  (seen 3x)
+    {3, {{AsmIRNodeType::MOVZX, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SUBTRACT, 1, -2, 0, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::MOVZX, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, -1, -2, 0, 0, 1, AsmIRCondCode::E}}, true},
+    // testl %0, %0; setl %0; movzbl %0, %0  =>  shrl $31, %0  (seen 3x)
+    {3, {{AsmIRNodeType::TEST, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SET_CC, -2, -2, 0, 0, 1, AsmIRCondCode::L}, {AsmIRNodeType::MOVZX, 0, -2, 0, 0, 1, AsmIRCondCode::E}},
+     1, {{AsmIRNodeType::SHR, -2, -2, 0, 31, 1, AsmIRCondCode::E}, {}}, true},
+    // negl %0; testl %0, %0; sete %0  =>  negl %0; sete %0  (seen 3x)
+    {3, {{AsmIRNodeType::NEG, -2, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::TEST, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SET_CC, -2, -2, 0, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::NEG, -2, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SET_CC, -2, -2, 0, 0, 1, AsmIRCondCode::E}}, true},
+    // movl %0, %1; movl %2, %0; imull %1, %0  =>  movl %0, %1; imull %2, %0  (seen 2x)
+    {3, {{AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 2, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MULTIPLY, 1, -2, 0, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MULTIPLY, 2, -2, 0, 0, 1, AsmIRCondCode::E}}, true},
+    // leal (, %0, 2), %0; movl %0, %1; xorl %0, %0  =>  leal (, %0, 2), %1; movl $0, %0  (seen 2x)
+    {3, {{AsmIRNodeType::LEA, -2, 0, 0, 0, 2, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::XOR, 0, -2, 0, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::LEA, -2, 0, 1, 0, 2, AsmIRCondCode::E}, {AsmIRNodeType::MOV, -1, -2, 0, 0, 1, AsmIRCondCode::E}}, true},
+    // leal (%0, %0, 4), %0; movl %0, %1; xorl %0, %0  =>  leal (%0, %0, 4), %1; movl $0, %0  (seen 2x)
+    {3, {{AsmIRNodeType::LEA, 0, 0, 0, 0, 4, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::XOR, 0, -2, 0, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::LEA, 0, 0, 1, 0, 4, AsmIRCondCode::E}, {AsmIRNodeType::MOV, -1, -2, 0, 0, 1, AsmIRCondCode::E}}, true},
+    // leal (%0, %0, 2), %1; movl %1, %2; xorl %1, %1  =>  movl $0, %1; leal (%0, %0, 2), %2  (seen 2x)
+    {3, {{AsmIRNodeType::LEA, 0, 0, 1, 0, 2, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 1, -2, 2, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::XOR, 1, -2, 1, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::MOV, -1, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::LEA, 0, 0, 2, 0, 2, AsmIRCondCode::E}}, true},
+    // leal (%0, %1, 1), %0; movl %0, %1; xorl %0, %0  =>  addl %0, %1; movl $0, %0  (seen 2x)
+    {3, {{AsmIRNodeType::LEA, 0, 1, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::XOR, 0, -2, 0, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::ADD, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, -1, -2, 0, 0, 1, AsmIRCondCode::E}}, true},
+    // leal (%0, %1, 1), %1; movl %1, %0; xorl %1, %1  =>  addl %1, %0; movl $0, %1  (seen 2x)
+    {3, {{AsmIRNodeType::LEA, 0, 1, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 1, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::XOR, 1, -2, 1, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::ADD, 1, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, -1, -2, 1, 0, 1, AsmIRCondCode::E}}, true},
+    // cmpl %0, %0; setge %0; movzbl %0, %0  =>  movl $1, %0  (seen 2x)
+    {3, {{AsmIRNodeType::CMP, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SET_CC, -2, -2, 0, 0, 1, AsmIRCondCode::GE}, {AsmIRNodeType::MOVZX, 0, -2, 0, 0, 1, AsmIRCondCode::E}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 0, 1, 1, AsmIRCondCode::E}, {}}, true},
+    // negl %0; movl %1, %2; subl %0, %2  =>  leal (%0, %1, 1), %2; negl %0  (seen 2x)
+    {3, {{AsmIRNodeType::NEG, -2, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 1, -2, 2, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SUBTRACT, 0, -2, 2, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::LEA, 0, 1, 2, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::NEG, -2, -2, 0, 0, 1, AsmIRCondCode::E}}, true},
+    // orl %0, %1; testl %1, %1; sete %1  =>  orl %0, %1; sete %1  (seen 2x)
+    {3, {{AsmIRNodeType::OR, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::TEST, 1, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SET_CC, -2, -2, 1, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::OR, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SET_CC, -2, -2, 1, 0, 1, AsmIRCondCode::E}}, true},
+    // xorl %0, %0; testl %1, %1; setl %0  =>  movl %1, %0; shrl $31, %0  (seen 2x)
+    {3, {{AsmIRNodeType::XOR, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::TEST, 1, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SET_CC, -2, -2, 0, 0, 1, AsmIRCondCode::L}},
+     2, {{AsmIRNodeType::MOV, 1, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SHR, -2, -2, 0, 31, 1, AsmIRCondCode::E}}, true},
+    // movl %0, %1; leal (, %1, 2), %0; movl %0, %1  =>  addl %0, %0; movl %0, %1  (seen 1x)
+    {3, {{AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::LEA, -2, 1, 0, 0, 2, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::ADD, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}}, true},
+    // movl %0, %1; leal 1(%0, %0, 1), %2; subl %0, %1  =>  movl $0, %1; leal 1(, %0, 2), %2  (seen 1x)
+    {3, {{AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::LEA, 0, 0, 2, 1, 1, AsmIRCondCode::E}, {AsmIRNodeType::SUBTRACT, 0, -2, 1, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::MOV, -1, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::LEA, -2, 0, 2, 1, 2, AsmIRCondCode::E}}, true},
+    // movl %0, %1; leal (%2, %1, 1), %2; movl %2, %1  =>  leal (%0, %2, 1), %1; movl %1, %2  (seen 1x)
+    {3, {{AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::LEA, 2, 1, 2, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 2, -2, 1, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::LEA, 0, 2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 1, -2, 2, 0, 1, AsmIRCondCode::E}}, false},
+    // movl %0, %1; cmpl %1, %1; setne %1  =>  movzbl %0, %1; xorl %0, %1  (seen 1x)
+    {3, {{AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::CMP, 1, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SET_CC, -2, -2, 1, 0, 1, AsmIRCondCode::NE}},
+     2, {{AsmIRNodeType::MOVZX, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::XOR, 0, -2, 1, 0, 1, AsmIRCondCode::E}}, true},
+    // movl %0, %1; negl %0; leal -1(%1), %1  =>  leal -1(%0), %1; negl %0  (seen 1x)
+    {3, {{AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::NEG, -2, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::LEA, 1, -2, 1, -1, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::LEA, 0, -2, 1, -1, 1, AsmIRCondCode::E}, {AsmIRNodeType::NEG, -2, -2, 0, 0, 1, AsmIRCondCode::E}}, true},
+    // movl %0, %1; negl %1; subl %2, %1  =>  leal (%0, %2, 1), %1; negl %1  (seen 1x)
+    {3, {{AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::NEG, -2, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SUBTRACT, 2, -2, 1, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::LEA, 0, 2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::NEG, -2, -2, 1, 0, 1, AsmIRCondCode::E}}, true},
+    // movl %0, %1; notl %0; leal (%1, %1, 1), %1  =>  leal (, %0, 2), %1; xorl $-1, %0  (seen 1x)
+    {3, {{AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::NOT, -2, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::LEA, 1, 1, 1, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::LEA, -2, 0, 1, 0, 2, AsmIRCondCode::E}, {AsmIRNodeType::XOR, -1, -2, 0, -1, 1, AsmIRCondCode::E}}, true},
+    // movl %0, %1; notl %1; movl %1, %0  =>  xorl $-1, %0; movl %0, %1  (seen 1x)
+    {3, {{AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::NOT, -2, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 1, -2, 0, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::XOR, -1, -2, 0, -1, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}}, true},
+    // movl %0, %1; subl %1, %2; xorl %1, %1  =>  movl $0, %1; subl %0, %2  (seen 1x)
+    {3, {{AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SUBTRACT, 1, -2, 2, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::XOR, 1, -2, 1, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::MOV, -1, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SUBTRACT, 0, -2, 2, 0, 1, AsmIRCondCode::E}}, true},
+    // movl %0, %1; subl %2, %1; negl %1  =>  movl %2, %1; subl %0, %1  (seen 1x)
+    {3, {{AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SUBTRACT, 2, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::NEG, -2, -2, 1, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::MOV, 2, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SUBTRACT, 0, -2, 1, 0, 1, AsmIRCondCode::E}}, true},
+    // movl %0, %1; imull %1, %0; movl %0, %1  =>  imull %0, %0; movl %0, %1  (seen 1x)
+    {3, {{AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MULTIPLY, 1, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::MULTIPLY, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}}, true},
+    // movl %0, %1; imull %1, %2; movl %2, %1  =>  imull %0, %2; movl %2, %1  (seen 1x)
+    {3, {{AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MULTIPLY, 1, -2, 2, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 2, -2, 1, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::MULTIPLY, 0, -2, 2, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 2, -2, 1, 0, 1, AsmIRCondCode::E}}, true},
+    // movl %0, %1; imull %2, %1; movl %1, %0  =>  imull %2, %0; movl %0, %1  (seen 1x)
+    {3, {{AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MULTIPLY, 2, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 1, -2, 0, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::MULTIPLY, 2, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}}, true},
+    // movl %0, %1; imull %2, %1; movl %1, %2  =>  imull %0, %2; movl %2, %1  (seen 1x)
+    {3, {{AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MULTIPLY, 2, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 1, -2, 2, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::MULTIPLY, 0, -2, 2, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 2, -2, 1, 0, 1, AsmIRCondCode::E}}, true},
+    // movl %0, %1; xorl %0, %0; leal (%1, %1, 1), %1  =>  leal (, %0, 2), %1; movl $0, %0  (seen 1x)
+    {3, {{AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::XOR, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::LEA, 1, 1, 1, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::LEA, -2, 0, 1, 0, 2, AsmIRCondCode::E}, {AsmIRNodeType::MOV, -1, -2, 0, 0, 1, AsmIRCondCode::E}}, true},
+    // movzbl %0, %0; movl %0, %1; sarl $31, %0  =>  movzbl %0, %1; movl $0, %0  (seen 1x)
+    {3, {{AsmIRNodeType::MOVZX, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SAR, -2, -2, 0, 31, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::MOVZX, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, -1, -2, 0, 0, 1, AsmIRCondCode::E}}, true},
+    // movzbl %0, %0; movl %0, %1; leal (%2, %1, 1), %0  =>  movzbl %0, %1; leal (%1, %2, 1), %0  (seen 1x)
+    {3, {{AsmIRNodeType::MOVZX, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::LEA, 2, 1, 0, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::MOVZX, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::LEA, 1, 2, 0, 0, 1, AsmIRCondCode::E}}, false},
+    // movzbl %0, %0; cmpl %0, %0; setne %0  =>  movl $0, %0  (seen 1x)
+    {3, {{AsmIRNodeType::MOVZX, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::CMP, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SET_CC, -2, -2, 0, 0, 1, AsmIRCondCode::NE}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 0, 0, 1, AsmIRCondCode::E}, {}}, true},
+    // movzbl %0, %0; cmpl %0, %0; setl %0  =>  movl $0, %0  (seen 1x)
+    {3, {{AsmIRNodeType::MOVZX, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::CMP, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SET_CC, -2, -2, 0, 0, 1, AsmIRCondCode::L}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 0, 0, 1, AsmIRCondCode::E}, {}}, true},
+    // sall $1, %0; andl %1, %2; leal (%0, %2, 1), %0  =>  andl %1, %2; leal (%2, %0, 2), %0  (seen 1x)
+    {3, {{AsmIRNodeType::SHL, -2, -2, 0, 1, 1, AsmIRCondCode::E}, {AsmIRNodeType::AND, 1, -2, 2, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::LEA, 0, 2, 0, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::AND, 1, -2, 2, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::LEA, 2, 0, 0, 0, 2, AsmIRCondCode::E}}, true},
+    // leal 1(%0), %1; movl %1, %0; xorl %1, %1  =>  addl $1, %0; movl $0, %1  (seen 1x)
+    {3, {{AsmIRNodeType::LEA, 0, -2, 1, 1, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 1, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::XOR, 1, -2, 1, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::ADD, -1, -2, 0, 1, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, -1, -2, 1, 0, 1, AsmIRCondCode::E}}, true},
+    // leal (%0, %0, 1), %1; leal (%2, %1, 1), %2; subl %0, %2  =>  leal (, %0, 2), %1; addl %0, %2  (seen 1x)
+    {3, {{AsmIRNodeType::LEA, 0, 0, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::LEA, 2, 1, 2, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SUBTRACT, 0, -2, 2, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::LEA, -2, 0, 1, 0, 2, AsmIRCondCode::E}, {AsmIRNodeType::ADD, 0, -2, 2, 0, 1, AsmIRCondCode::E}}, true},
+    // leal (%0, %0, 1), %1; negl %1; subl %2, %1  =>  leal (%2, %0, 2), %1; negl %1  (seen 1x)
+    {3, {{AsmIRNodeType::LEA, 0, 0, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::NEG, -2, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SUBTRACT, 2, -2, 1, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::LEA, 2, 0, 1, 0, 2, AsmIRCondCode::E}, {AsmIRNodeType::NEG, -2, -2, 1, 0, 1, AsmIRCondCode::E}}, true},
+    // leal (%0, %1, 1), %0; movl %0, %1; leal (, %1, 2), %0  =>  addl %0, %1; leal (, %1, 2), %0  (seen 1x)
+    {3, {{AsmIRNodeType::LEA, 0, 1, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::LEA, -2, 1, 0, 0, 2, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::ADD, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::LEA, -2, 1, 0, 0, 2, AsmIRCondCode::E}}, true},
+    // leal (%0, %1, 1), %1; subl %2, %1; subl %0, %1  =>  subl %2, %1  (seen 1x)
+    {3, {{AsmIRNodeType::LEA, 0, 1, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SUBTRACT, 2, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SUBTRACT, 0, -2, 1, 0, 1, AsmIRCondCode::E}},
+     1, {{AsmIRNodeType::SUBTRACT, 2, -2, 1, 0, 1, AsmIRCondCode::E}, {}}, true},
+    // leal (%0, %1, 1), %2; movl %2, %1; subl %1, %2  =>  addl %0, %1; movl $0, %2  (seen 1x)
+    {3, {{AsmIRNodeType::LEA, 0, 1, 2, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 2, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SUBTRACT, 1, -2, 2, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::ADD, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, -1, -2, 2, 0, 1, AsmIRCondCode::E}}, true},
+    // cmpl $1, %0; setge %1; xorl %1, %1  =>  movl $0, %1  (seen 1x)
+    {3, {{AsmIRNodeType::CMP, -1, -2, 0, 1, 1, AsmIRCondCode::E}, {AsmIRNodeType::SET_CC, -2, -2, 1, 0, 1, AsmIRCondCode::GE}, {AsmIRNodeType::XOR, 1, -2, 1, 0, 1, AsmIRCondCode::E}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 1, 0, 1, AsmIRCondCode::E}, {}}, true},
+    // cmpl %0, %0; sete %0; movzbl %0, %0  =>  movl $1, %0  (seen 1x)
+    {3, {{AsmIRNodeType::CMP, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SET_CC, -2, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOVZX, 0, -2, 0, 0, 1, AsmIRCondCode::E}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 0, 1, 1, AsmIRCondCode::E}, {}}, true},
+    // cmpl %0, %0; setl %0; movzbl %0, %0  =>  movl $0, %0  (seen 1x)
+    {3, {{AsmIRNodeType::CMP, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SET_CC, -2, -2, 0, 0, 1, AsmIRCondCode::L}, {AsmIRNodeType::MOVZX, 0, -2, 0, 0, 1, AsmIRCondCode::E}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 0, 0, 1, AsmIRCondCode::E}, {}}, true},
+    // testl %0, %0; setge %0; movzbl %0, %0  =>  xorl $-1, %0; shrl $31, %0  (seen 1x)
+    {3, {{AsmIRNodeType::TEST, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SET_CC, -2, -2, 0, 0, 1, AsmIRCondCode::GE}, {AsmIRNodeType::MOVZX, 0, -2, 0, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::XOR, -1, -2, 0, -1, 1, AsmIRCondCode::E}, {AsmIRNodeType::SHR, -2, -2, 0, 31, 1, AsmIRCondCode::E}}, true},
+    // testl %0, %0; setle %1; xorl %1, %1  =>  movl $0, %1  (seen 1x)
+    {3, {{AsmIRNodeType::TEST, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SET_CC, -2, -2, 1, 0, 1, AsmIRCondCode::LE}, {AsmIRNodeType::XOR, 1, -2, 1, 0, 1, AsmIRCondCode::E}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 1, 0, 1, AsmIRCondCode::E}, {}}, true},
+    // negl %0; leal (%1, %0, 1), %1; movl %1, %0  =>  subl %0, %1; movl %1, %0  (seen 1x)
+    {3, {{AsmIRNodeType::NEG, -2, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::LEA, 1, 0, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 1, -2, 0, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::SUBTRACT, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 1, -2, 0, 0, 1, AsmIRCondCode::E}}, true},
+    // negl %0; subl %1, %0; negl %0  =>  addl %1, %0  (seen 1x)
+    {3, {{AsmIRNodeType::NEG, -2, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SUBTRACT, 1, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::NEG, -2, -2, 0, 0, 1, AsmIRCondCode::E}},
+     1, {{AsmIRNodeType::ADD, 1, -2, 0, 0, 1, AsmIRCondCode::E}, {}}, true},
+    // notl %0; movl %0, %1; notl %1  =>  movl %0, %1; xorl $-1, %0  (seen 1x)
+    {3, {{AsmIRNodeType::NOT, -2, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::NOT, -2, -2, 1, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::MOV, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::XOR, -1, -2, 0, -1, 1, AsmIRCondCode::E}}, true},
+    // addl %0, %1; movl %1, %2; xorl %1, %1  =>  leal (%0, %1, 1), %2; movl $0, %1  (seen 1x)
+    {3, {{AsmIRNodeType::ADD, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 1, -2, 2, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::XOR, 1, -2, 1, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::LEA, 0, 1, 2, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, -1, -2, 1, 0, 1, AsmIRCondCode::E}}, true},
+    // subl %0, %0; testl %0, %0; sete %0  =>  movl $1, %0  (seen 1x)
+    {3, {{AsmIRNodeType::SUBTRACT, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::TEST, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SET_CC, -2, -2, 0, 0, 1, AsmIRCondCode::E}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 0, 1, 1, AsmIRCondCode::E}, {}}, true},
+    // subl %0, %1; leal (%0, %0, 1), %0; leal (%1, %0, 1), %1  =>  addl %0, %1; addl %0, %0  (seen 1x)
+    {3, {{AsmIRNodeType::SUBTRACT, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::LEA, 0, 0, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::LEA, 1, 0, 1, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::ADD, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::ADD, 0, -2, 0, 0, 1, AsmIRCondCode::E}}, true},
+    // subl %0, %1; leal (%1, %0, 1), %2; xorl %1, %1  =>  movl %1, %2; movl $0, %1  (seen 1x)
+    {3, {{AsmIRNodeType::SUBTRACT, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::LEA, 1, 0, 2, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::XOR, 1, -2, 1, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::MOV, 1, -2, 2, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, -1, -2, 1, 0, 1, AsmIRCondCode::E}}, true},
+    // subl %0, %1; subl %0, %2; subl %2, %1  =>  subl %2, %1; subl %0, %2  (seen 1x)
+    {3, {{AsmIRNodeType::SUBTRACT, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SUBTRACT, 0, -2, 2, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SUBTRACT, 2, -2, 1, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::SUBTRACT, 2, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SUBTRACT, 0, -2, 2, 0, 1, AsmIRCondCode::E}}, true},
+    // imull %0, %1; movl %1, %0; xorl %1, %1  =>  imull %1, %0; movl $0, %1  (seen 1x)
+    {3, {{AsmIRNodeType::MULTIPLY, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 1, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::XOR, 1, -2, 1, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::MULTIPLY, 1, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, -1, -2, 1, 0, 1, AsmIRCondCode::E}}, true},
+    // andl %0, %1; movl %1, %0; movl %2, %1  =>  andl %1, %0; movl %2, %1  (seen 1x)
+    {3, {{AsmIRNodeType::AND, 0, -2, 1, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 1, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 2, -2, 1, 0, 1, AsmIRCondCode::E}},
+     2, {{AsmIRNodeType::AND, 1, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::MOV, 2, -2, 1, 0, 1, AsmIRCondCode::E}}, true},
+    // xorl %0, %0; cmpl %0, %0; setge %0  =>  movl $1, %0  (seen 1x)
+    {3, {{AsmIRNodeType::XOR, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::CMP, 0, -2, 0, 0, 1, AsmIRCondCode::E}, {AsmIRNodeType::SET_CC, -2, -2, 0, 0, 1, AsmIRCondCode::GE}},
+     1, {{AsmIRNodeType::MOV, -1, -2, 0, 1, 1, AsmIRCondCode::E}, {}}, true},
+};
+
+#endif
@@ -0,0 +1,386 @@
+#include "tacky_cfg.h"
+#include <iostream>
+#include <algorithm>
+
+int blockLabelCount = 0;
+
+std::string makeBlockLabel() {
+    return "bb" + std::to_string(blockLabelCount++);
+}
+
+// --- Operand Helpers ---
+std::vector<std::unique_ptr<TackyIRNode>*> tackyUses(TackyIRNode* instr) {
+    std::vector<std::unique_ptr<TackyIRNode>*> uses;
+    if (!instr) return uses;
+
+    switch (instr->type) {
+        case TackyIRNodeType::RETURN:
+            uses.push_back(&static_cast<TackyIRReturn*>(instr)->expr);
+            break;
+        case TackyIRNodeType::UNARY:
+            uses.push_back(&static_cast<TackyIRUnary*>(instr)->src);
+            break;
+        case TackyIRNodeType::BINARY: {
+            auto* binary = static_cast<TackyIRBinary*>(instr);
+            uses.push_back(&binary->src1);
+            uses.push_back(&binary->src2);
+            break;
+        }
+        case TackyIRNodeType::COPY:
+            uses.push_back(&static_cast<TackyIRCopy*>(instr)->src);
+            break;
+        case TackyIRNodeType::JUMP_IF_ZERO:
+            uses.push_back(&static_cast<TackyIRJumpIfZero*>(instr)->condition);
+            break;
+        case TackyIRNodeType::JUMP_IF_NOT_ZERO:
+            uses.push_back(&static_cast<TackyIRJumpIfNotZero*>(instr)->condition);
+            break;
+        case TackyIRNodeType::PHI:
+            for (auto& arg : static_cast<TackyIRPhi*>(instr)->args)
+                uses.push_back(&arg.second);
+            break;
+        default:
+            break;
+    }
+    return uses;
+}
+
+std::unique_ptr<TackyIRNode>* tackyDestination(TackyIRNode* instr) {
+    if (!instr) return nullptr;
+
+    switch (instr->type) {
+        case TackyIRNodeType::UNARY: return &static_cast<TackyIRUnary*>(instr)->dst;
+        case TackyIRNodeType::BINARY: return &static_cast<TackyIRBinary*>(instr)->dst;
+        case TackyIRNodeType::COPY: return &static_cast<TackyIRCopy*>(instr)->dst;
+        case TackyIRNodeType::PHI: return &static_cast<TackyIRPhi*>(instr)->dst;
+        default: return nullptr;
+    }
+}
+
+bool isTackyTerminator(const TackyIRNode* instr) {
+    return instr && (instr->type == TackyIRNodeType::JUMP ||
+                     instr->type == TackyIRNodeType::JUMP_IF_ZERO ||
+                     instr->type == TackyIRNodeType::JUMP_IF_NOT_ZERO ||
+                     instr->type == TackyIRNodeType::RETURN);
+}
+
+bool isTackyPure(const TackyIRNode* instr) {
+    return instr && (instr->type == TackyIRNodeType::UNARY ||
+                     instr->type == TackyIRNodeType::BINARY ||
+                     instr->type == TackyIRNodeType::COPY ||
+                     instr->type == TackyIRNodeType::PHI);
+}
+
+const std::string* tackyVarName(const TackyIRNode* operand) {
+    if (!operand || operand->type != TackyIRNodeType::VAR) return nullptr;
+    return &static_cast<const TackyIRVar*>(operand)->value;
+}
+
+std::unique_ptr<TackyIRNode> cloneTackyOperand(const TackyIRNode* operand) {
+    if (!operand) return nullptr;
+    if (operand->type == TackyIRNodeType::VAR)
+        return std::make_unique<TackyIRVar>(static_cast<const TackyIRVar*>(operand)->value);
+    if (operand->type == TackyIRNodeType::CONSTANT)
+        return std::make_unique<TackyIRConstant>(static_cast<const TackyIRConstant*>(operand)->value);
+    std::cout << "Error: cannot clone TACKY operand" << std::endl;
+    return nullptr;
+}
+
+std::unordered_set<std::string> tackyDefinedNames(const TackyCFG& cfg) {
+    std::unordered_set<std::string> defined;
+    for (auto& block : cfg.blocks) {
+        for (auto& instr : block.instructions) {
+            if (auto* dst = tackyDestination(instr.get())) defined.insert(*tackyVarName(dst->get()));
+        }
+    }
+    return defined;
+}
+
+static const std::string* jumpTarget(const TackyIRNode* instr) {
+    switch (instr->type) {
+        case TackyIRNodeType::JUMP: return &static_cast<const TackyIRJump*>(instr)->target;
+        case TackyIRNodeType::JUMP_IF_ZERO: return &static_cast<const TackyIRJumpIfZero*>(instr)->target;
+        case TackyIRNodeType::JUMP_IF_NOT_ZERO: return &static_cast<const TackyIRJumpIfNotZero*>(instr)->target;
+        default: return nullptr;
+    }
+}
+
+// --- CFG Construction ---
+TackyCFG buildTackyCFG(TackyIRInstructions* instructions) {
+    TackyCFG cfg;
+    cfg.blocks.emplace_back();
+
+    for (auto& instr : instructions->instructions) {
+        if (!instr) continue;
+
+        if (instr->type == TackyIRNodeType::LABEL) {
+            auto& current = cfg.blocks.back();
+            if (!current.instructions.empty() || !current.label.empty())
+                cfg.blocks.emplace_back();
+            cfg.blocks.back().label = static_cast<TackyIRLabel*>(instr.get())->identifier;
+            continue;
+        }
+
+        bool terminator = isTackyTerminator(instr.get());
+        cfg.blocks.back().instructions.push_back(std::move(instr));
+        if (terminator)
+            cfg.blocks.emplace_back();
+    }
+    instructions->instructions.clear();
+
+    // the entry block must not be a jump target, so it never needs phis
+    if (!cfg.blocks[0].label.empty()) {
+        TackyBasicBlock entry;
+        cfg.blocks.insert(cfg.blocks.begin(), std::move(entry));
+    }
+
+    for (size_t i = 0; i < cfg.blocks.size(); ++i) {
+        auto& block = cfg.blocks[i];
+        const TackyIRNode* last = block.instructions.empty() ? nullptr : block.instructions.back().get();
+        bool falls = !last || (last->type != TackyIRNodeType::JUMP && last->type != TackyIRNodeType::RETURN);
+        block.fallthrough = (falls && i + 1 < cfg.blocks.size()) ? static_cast<int>(i + 1) : -1;
+    }
+
+    recomputeTackyEdges(cfg);
+    return cfg;
+}
+
+int findBlockByLabel(const TackyCFG& cfg, const std::string& label) {
+    for (size_t i = 0; i < cfg.blocks.size(); ++i) {
+        if (cfg.blocks[i].label == label) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+void recomputeTackyEdges(TackyCFG& cfg) {
+    cfg.analyses = TackyAnalyses();
+    std::unordered_map<std::string, int> labelToBlock;
+    for (size_t i = 0; i < cfg.blocks.size(); ++i) {
+        cfg.blocks[i].predecessors.clear();
+        cfg.blocks[i].successors.clear();
+        if (!cfg.blocks[i].label.empty())
+            labelToBlock[cfg.blocks[i].label] = static_cast<int>(i);
+    }
+
+    for (size_t i = 0; i < cfg.blocks.size(); ++i) {
+        auto& block = cfg.blocks[i];
+        const TackyIRNode* last = block.instructions.empty() ? nullptr : block.instructions.back().get();
+        const std::string* target = last ? jumpTarget(last) : nullptr;
+
+        if (target) {
+            auto it = labelToBlock.find(*target);
+            if (it == labelToBlock.end()) {
+                std::cout << "Error: jump to unknown label " << *target << std::endl;
+            } else {
+                block.successors.push_back(it->second);
+            }
+        }
+        if (block.fallthrough != -1 &&
+            std::find(block.successors.begin(), block.successors.end(), block.fallthrough) == block.successors.end()) {
+            block.successors.push_back(block.fallthrough);
+        }
+        for (int succ : block.successors)
+            cfg.blocks[succ].predecessors.push_back(static_cast<int>(i));
+    }
+}
+
+void removeUnreachableBlocks(TackyCFG& cfg) {
+    std::vector<bool> reachable(cfg.blocks.size(), false);
+    std::vector<int> stack = {0};
+    reachable[0] = true;
+    while (!stack.empty()) {
+        int b = stack.back();
+        stack.pop_back();
+        for (int succ : cfg.blocks[b].successors) {
+            if (!reachable[succ]) {
+                reachable[succ] = true;
+                stack.push_back(succ);
+            }
+        }
+    }
+
+    std::vector<int> remap(cfg.blocks.size(), -1);
+    std::vector<TackyBasicBlock> kept;
+    for (size_t i = 0; i < cfg.blocks.size(); ++i) {
+        if (reachable[i]) {
+            remap[i] = static_cast<int>(kept.size());
+            kept.push_back(std::move(cfg.blocks[i]));
+        }
+    }
+
+    for (auto& block : kept) {
+        block.fallthrough = block.fallthrough == -1 ? -1 : remap[block.fallthrough];
+        for (auto& instr : block.instructions) {
+            if (instr->type != TackyIRNodeType::PHI) continue;
+            auto& args = static_cast<TackyIRPhi*>(instr.get())->args;
+            args.erase(std::remove_if(args.begin(), args.end(),
+                [&](const std::pair<int, std::unique_ptr<TackyIRNode>>& arg) { return remap[arg.first] == -1; }),
+                args.end());
+            for (auto& arg : args)
+                arg.first = remap[arg.first];
+        }
+    }
+
+    cfg.blocks = std::move(kept);
+    recomputeTackyEdges(cfg);
+}
+
+void flattenTackyCFG(TackyCFG& cfg, TackyIRInstructions* instructions) {
+    instructions->instructions.clear();
+
+    for (size_t i = 0; i < cfg.blocks.size(); ++i) {
+        int ft = cfg.blocks[i].fallthrough;
+        if (ft != -1 && ft != static_cast<int>(i + 1) && cfg.blocks[ft].label.empty())
+            cfg.blocks[ft].label = makeBlockLabel();
+    }
+
+    std::unordered_map<std::string, bool> targeted;
+    for (size_t i = 0; i < cfg.blocks.size(); ++i) {
+        const auto& block = cfg.blocks[i];
+        if (!block.instructions.empty()) {
+            const TackyIRNode* last = block.instructions.back().get();
+            const std::string* target = jumpTarget(last);
+            bool toNext = last->type == TackyIRNodeType::JUMP && i + 1 < cfg.blocks.size() &&
+                          *target == cfg.blocks[i + 1].label;
+            if (target && !toNext) targeted[*target] = true;
+        }
+        if (block.fallthrough != -1 && block.fallthrough != static_cast<int>(i + 1))
+            targeted[cfg.blocks[block.fallthrough].label] = true;
+    }
+
+    for (size_t i = 0; i < cfg.blocks.size(); ++i) {
+        auto& block = cfg.blocks[i];
+        if (!block.label.empty() && targeted.count(block.label))
+            instructions->instructions.push_back(std::make_unique<TackyIRLabel>(block.label));
+
+        for (auto& instr : block.instructions) {
+            if (instr->type == TackyIRNodeType::PHI)
+                std::cout << "Error: phi left in flattened TACKY" << std::endl;
+
+            // a jump to the block laid out next is a no-op
+            if (instr->type == TackyIRNodeType::JUMP && &instr == &block.instructions.back() &&
+                i + 1 < cfg.blocks.size() &&
+                static_cast<TackyIRJump*>(instr.get())->target == cfg.blocks[i + 1].label) {
+                continue;
+            }
+            instructions->instructions.push_back(std::move(instr));
+        }
+
+        if (block.fallthrough != -1 && block.fallthrough != static_cast<int>(i + 1))
+            instructions->instructions.push_back(std::make_unique<TackyIRJump>(cfg.blocks[block.fallthrough].label));
+    }
+
+    cfg.blocks.clear();
+}
+
+// --- Dominators (Cooper, Harvey & Kennedy) ---
+std::vector<int> reversePostorder(const TackyCFG& cfg) {
+    std::vector<int> order;
+    std::vector<bool> visited(cfg.blocks.size(), false);
+    // iterative DFS so huge generated functions don't overflow the stack
+    std::vector<std::pair<int, size_t>> stack;
+    stack.push_back({0, 0});
+    visited[0] = true;
+    while (!stack.empty()) {
+        auto& top = stack.back();
+        const auto& succs = cfg.blocks[top.first].successors;
+        if (top.second < succs.size()) {
+            int succ = succs[top.second++];
+            if (!visited[succ]) {
+                visited[succ] = true;
+                stack.push_back({succ, 0});
+            }
+        } else {
+            order.push_back(top.first);
+            stack.pop_back();
+        }
+    }
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+std::vector<int> computeDominators(const TackyCFG& cfg) {
+    std::vector<int> rpo = reversePostorder(cfg);
+    std::vector<int> rpoIndex(cfg.blocks.size(), -1);
+    for (size_t i = 0; i < rpo.size(); ++i)
+        rpoIndex[rpo[i]] = static_cast<int>(i);
+
+    std::vector<int> idom(cfg.blocks.size(), -1);
+    idom[0] = 0;
+
+    auto intersect = [&](int a, int b) {
+        while (a != b) {
+            while (rpoIndex[a] > rpoIndex[b]) a = idom[a];
+            while (rpoIndex[b] > rpoIndex[a]) b = idom[b];
+        }
+        return a;
+    };
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = 1; i < rpo.size(); ++i) {
+            int b = rpo[i];
+            int newIdom = -1;
+            for (int pred : cfg.blocks[b].predecessors) {
+                if (idom[pred] == -1) continue;
+                newIdom = newIdom == -1 ? pred : intersect(pred, newIdom);
+            }
+            if (newIdom != idom[b]) {
+                idom[b] = newIdom;
+                changed = true;
+            }
+        }
+    }
+    return idom;
+}
+
+std::vector<std::vector<int>> dominatorTreeChildren(const std::vector<int>& idom) {
+    std::vector<std::vector<int>> children(idom.size());
+    for (size_t b = 1; b < idom.size(); ++b) {
+        if (idom[b] != -1)
+            children[idom[b]].push_back(static_cast<int>(b));
+    }
+    return children;
+}
+
+// --- Cached Analyses ---
+const std::vector<int>& cachedReversePostorder(TackyCFG& cfg) {
+    if (!cfg.analyses.haveOrder) {
+        cfg.analyses.reversePostorder = reversePostorder(cfg);
+        cfg.analyses.haveOrder = true;
+    }
+    return cfg.analyses.reversePostorder;
+}
+
+const std::vector<int>& cachedDominators(TackyCFG& cfg) {
+    if (!cfg.analyses.haveDominators) {
+        cfg.analyses.idom = computeDominators(cfg);
+        cfg.analyses.dominatorChildren = dominatorTreeChildren(cfg.analyses.idom);
+        cfg.analyses.haveDominators = true;
+    }
+    return cfg.analyses.idom;
+}
+
+const std::vector<std::vector<int>>& cachedDominatorTree(TackyCFG& cfg) {
+    cachedDominators(cfg);
+    return cfg.analyses.dominatorChildren;
+}
+
+std::vector<std::vector<int>> dominanceFrontiers(const TackyCFG& cfg, const std::vector<int>& idom) {
+    std::vector<std::vector<int>> frontiers(cfg.blocks.size());
+    for (size_t b = 0; b < cfg.blocks.size(); ++b) {
+        const auto& preds = cfg.blocks[b].predecessors;
+        if (preds.size() < 2 || idom[b] == -1) continue;
+        for (int pred : preds) {
+            int runner = pred;
+            while (runner != -1 && runner != idom[b]) {
+                auto& df = frontiers[runner];
+                if (std::find(df.begin(), df.end(), static_cast<int>(b)) == df.end())
+                    df.push_back(static_cast<int>(b));
+                runner = runner == idom[runner] ? -1 : idom[runner];
+            }
+        }
+    }
+    return frontiers;
+}
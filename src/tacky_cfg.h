@@ -0,0 +1,94 @@
+#ifndef TACKY_CFG_H
+#define TACKY_CFG_H
+
+#include "tacky_ir.h"
+#include "tacky_eval.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+
+/*
+    A function body split into basic blocks. Labels are pulled out of the
+    instruction stream into TackyBasicBlock::label and re-emitted when the
+    CFG is flattened. blocks[0] is always the entry block.
+*/
+struct TackyBasicBlock {
+    std::string label;
+    std::vector<std::unique_ptr<TackyIRNode>> instructions;
+    std::vector<int> predecessors;
+    std::vector<int> successors;
+    int fallthrough = -1; // block reached when the last instruction doesn't jump
+};
+
+/*
+    Edge-derived analyses kept with the CFG between passes. They are computed on first
+    use and dropped by recomputeTackyEdges, which every change to the block structure
+    goes through, so a pass that only rewrites instructions reuses them.
+*/
+struct TackyAnalyses {
+    bool haveOrder = false;
+    bool haveDominators = false;
+    std::vector<int> reversePostorder;
+    std::vector<int> idom;
+    std::vector<std::vector<int>> dominatorChildren;
+};
+
+struct TackyCFG {
+    std::vector<TackyBasicBlock> blocks;
+    std::unordered_map<std::string, std::string> ssaOrigin; // SSA name -> variable it renames
+    TackyAnalyses analyses;
+};
+
+TackyCFG buildTackyCFG(TackyIRInstructions* instructions);
+void flattenTackyCFG(TackyCFG& cfg, TackyIRInstructions* instructions);
+void recomputeTackyEdges(TackyCFG& cfg);
+void removeUnreachableBlocks(TackyCFG& cfg);
+int findBlockByLabel(const TackyCFG& cfg, const std::string& label);
+std::string makeBlockLabel();
+
+std::vector<int> reversePostorder(const TackyCFG& cfg);
+std::vector<int> computeDominators(const TackyCFG& cfg);
+std::vector<std::vector<int>> dominatorTreeChildren(const std::vector<int>& idom);
+std::vector<std::vector<int>> dominanceFrontiers(const TackyCFG& cfg, const std::vector<int>& idom);
+// The same through cfg.analyses, recomputed only after the edges changed
+const std::vector<int>& cachedReversePostorder(TackyCFG& cfg);
+const std::vector<int>& cachedDominators(TackyCFG& cfg);
+const std::vector<std::vector<int>>& cachedDominatorTree(TackyCFG& cfg);
+
+// Operand helpers shared by the TACKY passes
+std::vector<std::unique_ptr<TackyIRNode>*> tackyUses(TackyIRNode* instr);
+std::unique_ptr<TackyIRNode>* tackyDestination(TackyIRNode* instr);
+bool isTackyTerminator(const TackyIRNode* instr);
+bool isTackyPure(const TackyIRNode* instr);
+const std::string* tackyVarName(const TackyIRNode* operand);
+std::unique_ptr<TackyIRNode> cloneTackyOperand(const TackyIRNode* operand);
+// Every name an instruction assigns. In SSA form any other name is an uninitialized read.
+std::unordered_set<std::string> tackyDefinedNames(const TackyCFG& cfg);
+
+// Operand lookup for the sparse analyses over SSA names: a constant maps through
+// fromConstant, a name nothing defines reads an uninitialized variable and gets unknown,
+// and any other name comes from values. False while the name has no value yet.
+template <typename Lattice, typename FromConstant>
+bool tackyOperandLattice(const TackyIRNode* operand, const std::unordered_set<std::string>& defined,
+                         const std::unordered_map<std::string, Lattice>& values,
+                         FromConstant fromConstant, const Lattice& unknown, Lattice& out) {
+    int32_t constant;
+    if (parseTackyConstant(operand, constant)) {
+        out = fromConstant(constant);
+        return true;
+    }
+    const std::string* name = tackyVarName(operand);
+    if (!name) return false;
+    if (!defined.count(*name)) {
+        out = unknown;
+        return true;
+    }
+    auto it = values.find(*name);
+    if (it == values.end()) return false;
+    out = it->second;
+    return true;
+}
+
+#endif
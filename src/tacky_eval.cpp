@@ -0,0 +1,76 @@
+#include "tacky_eval.h"
+#include <climits>
+
+bool evalTackyUnary(TackyIRNodeType op, int32_t value, int32_t& result) {
+    switch (op) {
+        case TackyIRNodeType::NEGATE:
+            result = static_cast<int32_t>(0u - static_cast<uint32_t>(value));
+            return true;
+        case TackyIRNodeType::COMPLEMENT:
+            result = ~value;
+            return true;
+        case TackyIRNodeType::NOT:
+            result = value == 0;
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool evalTackyBinary(TackyIRNodeType op, int32_t lhs, int32_t rhs, int32_t& result) {
+    uint32_t a = static_cast<uint32_t>(lhs);
+    uint32_t b = static_cast<uint32_t>(rhs);
+
+    switch (op) {
+        case TackyIRNodeType::ADD: result = static_cast<int32_t>(a + b); return true;
+        case TackyIRNodeType::SUBTRACT: result = static_cast<int32_t>(a - b); return true;
+        case TackyIRNodeType::MULTIPLY: result = static_cast<int32_t>(a * b); return true;
+        case TackyIRNodeType::DIVIDE:
+            if (rhs == 0 || (lhs == INT32_MIN && rhs == -1)) return false;
+            result = lhs / rhs;
+            return true;
+        case TackyIRNodeType::REMAINDER:
+            if (rhs == 0 || (lhs == INT32_MIN && rhs == -1)) return false;
+            result = lhs % rhs;
+            return true;
+        case TackyIRNodeType::EQUAL: result = lhs == rhs; return true;
+        case TackyIRNodeType::NOT_EQUAL: result = lhs != rhs; return true;
+        case TackyIRNodeType::LESS_THAN: result = lhs < rhs; return true;
+        case TackyIRNodeType::LESS_OR_EQUAL: result = lhs <= rhs; return true;
+        case TackyIRNodeType::GREATER_THAN: result = lhs > rhs; return true;
+        case TackyIRNodeType::GREATER_OR_EQUAL: result = lhs >= rhs; return true;
+        // sarl only uses the low five bits of the count
+        case TackyIRNodeType::SHIFT_RIGHT: result = lhs >> (rhs & 31); return true;
+        case TackyIRNodeType::BITWISE_AND: result = lhs & rhs; return true;
+        case TackyIRNodeType::BITWISE_OR: result = lhs | rhs; return true;
+        default: return false;
+    }
+}
+
+bool parseTackyConstant(const TackyIRNode* operand, int32_t& value) {
+    if (!operand || operand->type != TackyIRNodeType::CONSTANT) return false;
+    const std::string& text = static_cast<const TackyIRConstant*>(operand)->value;
+    try {
+        // literals wider than 32 bits wrap, same as the movl the emitter produces
+        value = static_cast<int32_t>(static_cast<uint32_t>(std::stoll(text)));
+    } catch (...) {
+        return false;
+    }
+    return true;
+}
+
+std::string tackyConstantString(int32_t value) {
+    return std::to_string(value);
+}
+
+bool isTackyComparison(TackyIRNodeType op) {
+    return op == TackyIRNodeType::EQUAL || op == TackyIRNodeType::NOT_EQUAL ||
+           op == TackyIRNodeType::LESS_THAN || op == TackyIRNodeType::LESS_OR_EQUAL ||
+           op == TackyIRNodeType::GREATER_THAN || op == TackyIRNodeType::GREATER_OR_EQUAL;
+}
+
+bool isTackyCommutative(TackyIRNodeType op) {
+    return op == TackyIRNodeType::ADD || op == TackyIRNodeType::MULTIPLY ||
+           op == TackyIRNodeType::EQUAL || op == TackyIRNodeType::NOT_EQUAL ||
+           op == TackyIRNodeType::BITWISE_AND || op == TackyIRNodeType::BITWISE_OR;
+}
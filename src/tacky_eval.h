@@ -0,0 +1,18 @@
+#ifndef TACKY_EVAL_H
+#define TACKY_EVAL_H
+
+#include "tacky_ir.h"
+#include <cstdint>
+#include <string>
+
+// 32-bit two's complement evaluation of TACKY operators, as the emitted x86 computes them.
+// Returns false when the operation traps or is undefined (division by zero, INT_MIN / -1).
+bool evalTackyUnary(TackyIRNodeType op, int32_t value, int32_t& result);
+bool evalTackyBinary(TackyIRNodeType op, int32_t lhs, int32_t rhs, int32_t& result);
+
+bool parseTackyConstant(const TackyIRNode* operand, int32_t& value);
+std::string tackyConstantString(int32_t value);
+bool isTackyComparison(TackyIRNodeType op);
+bool isTackyCommutative(TackyIRNodeType op);
+
+#endif
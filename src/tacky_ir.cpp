@@ -74,6 +74,18 @@ TackyIRGreaterOrEqual::TackyIRGreaterOrEqual() {
     type = TackyIRNodeType::GREATER_OR_EQUAL;
 }
 
+TackyIRShiftRight::TackyIRShiftRight() {
+    type = TackyIRNodeType::SHIFT_RIGHT;
+}
+
+TackyIRBitwiseAnd::TackyIRBitwiseAnd() {
+    type = TackyIRNodeType::BITWISE_AND;
+}
+
+TackyIRBitwiseOr::TackyIRBitwiseOr() {
+    type = TackyIRNodeType::BITWISE_OR;
+}
+
 TackyIRConstant::TackyIRConstant(std::string v) {
     type = TackyIRNodeType::CONSTANT;
     value = std::move(v);
@@ -120,3 +132,8 @@ TackyIRLabel::TackyIRLabel(std::string identifier)
     : identifier(std::move(identifier)) {
     type = TackyIRNodeType::LABEL;
 }
+
+TackyIRPhi::TackyIRPhi(std::unique_ptr<TackyIRNode> dst)
+    : dst(std::move(dst)) {
+    type = TackyIRNodeType::PHI;
+}
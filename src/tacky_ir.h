@@ -31,7 +31,11 @@ enum class TackyIRNodeType {
     LESS_THAN,
     LESS_OR_EQUAL,
     GREATER_THAN,
-    GREATER_OR_EQUAL
+    GREATER_OR_EQUAL,
+    SHIFT_RIGHT,
+    BITWISE_AND,
+    BITWISE_OR,
+    PHI
 };
 
 class TackyIRNode {
@@ -137,6 +141,23 @@ public:
     TackyIRGreaterOrEqual();
 };
 
+// Not produced from source; value-range analysis lowers divisions to these
+class TackyIRShiftRight : public TackyIRNode {
+public:
+    TackyIRShiftRight();
+};
+
+class TackyIRBitwiseAnd : public TackyIRNode {
+public:
+    TackyIRBitwiseAnd();
+};
+
+// Not produced from source; combines the 0/1 operands of a branchless ||
+class TackyIRBitwiseOr : public TackyIRNode {
+public:
+    TackyIRBitwiseOr();
+};
+
 class TackyIRConstant : public TackyIRNode {
 public:
     std::string value;
@@ -199,6 +220,14 @@ public:
     TackyIRLabel(std::string identifier);
 };
 
+// Only present while a function is in SSA form; args are keyed by predecessor block id
+class TackyIRPhi : public TackyIRNode {
+public:
+    std::unique_ptr<TackyIRNode> dst;
+    std::vector<std::pair<int, std::unique_ptr<TackyIRNode>>> args;
+    TackyIRPhi(std::unique_ptr<TackyIRNode> dst);
+};
+
 
 
 #endif
@@ -0,0 +1,111 @@
+#include "target.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+#include <cstring>
+
+// --- Targets ---
+// Unit counts are in Unit order: ALU, SHIFT, MULTIPLY, DIVIDE, LOAD, STORE, BRANCH.
+
+// A middle-of-the-road core that doesn't model ports beyond the multiplier and divider
+static const TargetDescription generic = {
+    "generic", 4, {4, 1, 1, 1, 2, 1, 1}, {{
+        /* MOVE */           {1, 1, Unit::ALU},
+        /* LOAD */           {4, 1, Unit::LOAD},
+        /* STORE */          {1, 1, Unit::STORE},
+        /* ALU */            {1, 1, Unit::ALU},
+        /* SHIFT */          {1, 1, Unit::ALU},
+        /* COMPARE */        {1, 1, Unit::ALU},
+        /* SET_CC */         {1, 1, Unit::ALU},
+        /* BRANCH */         {1, 1, Unit::BRANCH},
+        /* LEA */            {1, 1, Unit::ALU},
+        /* LEA_SCALED */     {1, 1, Unit::ALU},
+        /* LEA_THREE_PART */ {3, 1, Unit::ALU},
+        /* MULTIPLY */       {3, 1, Unit::MULTIPLY},
+        /* MULTIPLY_WIDE */  {4, 1, Unit::MULTIPLY},
+        /* DIVIDE */         {26, 6, Unit::DIVIDE},
+    }},
+};
+
+// Shifts, setcc and taken branches share ports 0 and 6; the slow three-part leal and the
+// multiplier both sit on port 1
+static const TargetDescription skylake = {
+    "skylake", 4, {4, 2, 1, 1, 2, 1, 2}, {{
+        /* MOVE */           {1, 1, Unit::ALU},
+        /* LOAD */           {5, 1, Unit::LOAD},
+        /* STORE */          {1, 1, Unit::STORE},
+        /* ALU */            {1, 1, Unit::ALU},
+        /* SHIFT */          {1, 1, Unit::SHIFT},
+        /* COMPARE */        {1, 1, Unit::ALU},
+        /* SET_CC */         {1, 1, Unit::SHIFT},
+        /* BRANCH */         {1, 1, Unit::BRANCH},
+        /* LEA */            {1, 1, Unit::ALU},
+        /* LEA_SCALED */     {1, 1, Unit::ALU},
+        /* LEA_THREE_PART */ {3, 1, Unit::MULTIPLY},
+        /* MULTIPLY */       {3, 1, Unit::MULTIPLY},
+        /* MULTIPLY_WIDE */  {4, 1, Unit::MULTIPLY},
+        /* DIVIDE */         {26, 6, Unit::DIVIDE},
+    }},
+};
+
+// Every ALU shifts, a scaled leal costs an extra cycle, the wide multiply is as quick as
+// the narrow one and the divider is about twice as fast as Skylake's
+static const TargetDescription zen3 = {
+    "zen3", 6, {4, 1, 1, 1, 3, 2, 2}, {{
+        /* MOVE */           {1, 1, Unit::ALU},
+        /* LOAD */           {4, 1, Unit::LOAD},
+        /* STORE */          {1, 1, Unit::STORE},
+        /* ALU */            {1, 1, Unit::ALU},
+        /* SHIFT */          {1, 1, Unit::ALU},
+        /* COMPARE */        {1, 1, Unit::ALU},
+        /* SET_CC */         {1, 1, Unit::ALU},
+        /* BRANCH */         {1, 1, Unit::BRANCH},
+        /* LEA */            {1, 1, Unit::ALU},
+        /* LEA_SCALED */     {2, 1, Unit::ALU},
+        /* LEA_THREE_PART */ {2, 1, Unit::ALU},
+        /* MULTIPLY */       {3, 1, Unit::MULTIPLY},
+        /* MULTIPLY_WIDE */  {3, 1, Unit::MULTIPLY},
+        /* DIVIDE */         {12, 6, Unit::DIVIDE},
+    }},
+};
+
+const TargetDescription* tuneTarget = &generic;
+
+// --- Host Detection ---
+// Intel cores are tuned like Skylake and Zen or later AMD cores like Zen 3
+static const TargetDescription* detectHost() {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(0, &eax, &ebx, &ecx, &edx)) return &generic;
+    char vendor[13];
+    std::memcpy(vendor, &ebx, 4);
+    std::memcpy(vendor + 4, &edx, 4);
+    std::memcpy(vendor + 8, &ecx, 4);
+    vendor[12] = '\0';
+
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return &generic;
+    unsigned int family = (eax >> 8) & 0xf;
+    if (family == 0xf) family += (eax >> 20) & 0xff;
+
+    if (std::strcmp(vendor, "GenuineIntel") == 0) return &skylake;
+    if (std::strcmp(vendor, "AuthenticAMD") == 0 && family >= 0x17) return &zen3;
+#endif
+    return &generic;
+}
+
+bool selectTuneTarget(const std::string& name) {
+    if (name == "generic") tuneTarget = &generic;
+    else if (name == "skylake") tuneTarget = &skylake;
+    else if (name == "zen3") tuneTarget = &zen3;
+    else if (name == "native") tuneTarget = detectHost();
+    else return false;
+    return true;
+}
+
+const Timing& targetTiming(InstrClass instrClass) {
+    return tuneTarget->timings[static_cast<size_t>(instrClass)];
+}
+
+int targetLatency(InstrClass instrClass) {
+    return targetTiming(instrClass).latency;
+}
@@ -0,0 +1,54 @@
+#ifndef TARGET_H
+#define TARGET_H
+
+#include <array>
+#include <string>
+
+/*
+    Per-microarchitecture costs for the instructions antcc emits, picked with -mtune.
+    Instruction classes are charged to one kind of execution unit; latency is the cycles
+    until the result can be read and throughput the cycles that unit stays busy. The
+    scheduler, the strength reductions and the instruction selector's multiply rules all
+    read the current target instead of carrying their own numbers.
+*/
+enum class Unit { ALU, SHIFT, MULTIPLY, DIVIDE, LOAD, STORE, BRANCH, COUNT };
+
+enum class InstrClass {
+    MOVE,           // movl/movzbl between registers
+    LOAD,           // movl from a stack slot
+    STORE,          // movl to a stack slot
+    ALU,            // addl, subl, andl, orl, xorl, negl, notl, cdq
+    SHIFT,          // sall, sarl, shrl by an immediate
+    COMPARE,        // cmpl, testl
+    SET_CC,         // setcc
+    BRANCH,         // jmp, jcc
+    LEA,            // leal with a base and a displacement or an unscaled index
+    LEA_SCALED,     // leal with a scaled index
+    LEA_THREE_PART, // leal with base, index and displacement
+    MULTIPLY,       // two-operand imull
+    MULTIPLY_WIDE,  // one-operand imull into EDX:EAX
+    DIVIDE,         // idivl
+    COUNT
+};
+
+struct Timing {
+    int latency;
+    int throughput;
+    Unit unit;
+};
+
+struct TargetDescription {
+    const char* name;
+    int issueWidth;
+    std::array<int, static_cast<size_t>(Unit::COUNT)> unitCount;
+    std::array<Timing, static_cast<size_t>(InstrClass::COUNT)> timings;
+};
+
+extern const TargetDescription* tuneTarget;
+
+// generic, skylake, zen3, or native to ask cpuid; false for anything else
+bool selectTuneTarget(const std::string& name);
+const Timing& targetTiming(InstrClass instrClass);
+int targetLatency(InstrClass instrClass);
+
+#endif
@@ -0,0 +1,385 @@
+#include "value_range.h"
+#include "tacky_eval.h"
+#include <algorithm>
+#include <climits>
+
+// Bits of the 32-bit value known to be 0 and known to be 1
+struct KnownBits {
+    uint32_t zeros = 0;
+    uint32_t ones = 0;
+
+    bool operator==(const KnownBits& other) const { return zeros == other.zeros && ones == other.ones; }
+};
+
+// Bounds are int64 so the arithmetic below can detect when the 32-bit result wraps. The
+// known bits are tracked alongside and each refines the other, see refine.
+struct ValueRange {
+    int64_t lo = INT32_MIN;
+    int64_t hi = INT32_MAX;
+    KnownBits bits = {};
+
+    bool isConstant() const { return lo == hi; }
+    bool contains(int64_t value) const { return lo <= value && value <= hi; }
+    bool canBeZero() const { return contains(0) && bits.ones == 0; }
+    bool operator==(const ValueRange& other) const { return lo == other.lo && hi == other.hi && bits == other.bits; }
+    bool operator!=(const ValueRange& other) const { return !(*this == other); }
+};
+
+static const ValueRange fullRange;
+static const ValueRange booleanRange = {0, 1};
+// a phi still changing after this many rounds is sitting on a loop; give up on it
+static const int widenAfter = 8;
+
+static ValueRange clampToInt(int64_t lo, int64_t hi) {
+    if (lo < INT32_MIN || hi > INT32_MAX) return fullRange;
+    return {lo, hi};
+}
+
+static ValueRange fromCorners(std::initializer_list<int64_t> corners) {
+    return clampToInt(std::min(corners), std::max(corners));
+}
+
+// --- Known bits ---
+
+static int powerOfTwoLog(int64_t value) {
+    if (value <= 0 || (value & (value - 1)) != 0) return -1;
+    int log = 0;
+    while ((int64_t{1} << log) != value) log++;
+    return log;
+}
+
+static uint32_t lowMask(int count) {
+    return count >= 32 ? ~0u : (1u << count) - 1;
+}
+
+static int trailingOnes(uint32_t mask) {
+    int count = 0;
+    while (count < 32 && (mask >> count & 1)) count++;
+    return count;
+}
+
+// How many of the low bits are known, either way
+static int knownLowBits(const KnownBits& bits) {
+    return trailingOnes(bits.zeros | bits.ones);
+}
+
+static KnownBits lowBitsOf(uint32_t value, int count) {
+    return {~value & lowMask(count), value & lowMask(count)};
+}
+
+static KnownBits evalBitsUnary(TackyIRNodeType op, const ValueRange& range) {
+    const KnownBits& a = range.bits;
+    switch (op) {
+        case TackyIRNodeType::COMPLEMENT:
+            return {a.ones, a.zeros};
+        case TackyIRNodeType::NEGATE:
+            // -x is ~x + 1, so the low bits up to and including the lowest known one carry through
+            return lowBitsOf(0u - a.ones, knownLowBits(a));
+        default:
+            return {};
+    }
+}
+
+static KnownBits evalBitsBinary(TackyIRNodeType op, const ValueRange& a, const ValueRange& b) {
+    // the low bits of a sum, difference or product only depend on the low bits of the operands
+    int low = std::min(knownLowBits(a.bits), knownLowBits(b.bits));
+    switch (op) {
+        case TackyIRNodeType::ADD:
+            return lowBitsOf(a.bits.ones + b.bits.ones, low);
+        case TackyIRNodeType::SUBTRACT:
+            return lowBitsOf(a.bits.ones - b.bits.ones, low);
+        case TackyIRNodeType::MULTIPLY: {
+            KnownBits result = lowBitsOf(a.bits.ones * b.bits.ones, low);
+            result.zeros |= lowMask(trailingOnes(a.bits.zeros) + trailingOnes(b.bits.zeros));
+            return result;
+        }
+        case TackyIRNodeType::REMAINDER: {
+            int log = b.isConstant() ? powerOfTwoLog(std::abs(b.lo)) : -1;
+            if (log == -1) return {};
+            // a multiple of the divisor leaves nothing, whatever its sign
+            if ((a.bits.zeros & lowMask(log)) == lowMask(log)) return {~0u, 0};
+            // a non-negative dividend keeps its low bits and clears the rest
+            if (a.lo >= 0) return {a.bits.zeros | ~lowMask(log), a.bits.ones & lowMask(log)};
+            return {};
+        }
+        case TackyIRNodeType::SHIFT_RIGHT: {
+            if (!b.isConstant()) return {};
+            // shifting the masks arithmetically copies what is known of the sign bit into the top
+            int count = static_cast<int>(b.lo & 31);
+            return {static_cast<uint32_t>(static_cast<int32_t>(a.bits.zeros) >> count),
+                    static_cast<uint32_t>(static_cast<int32_t>(a.bits.ones) >> count)};
+        }
+        case TackyIRNodeType::BITWISE_AND:
+            return {a.bits.zeros | b.bits.zeros, a.bits.ones & b.bits.ones};
+        case TackyIRNodeType::BITWISE_OR:
+            return {a.bits.zeros & b.bits.zeros, a.bits.ones | b.bits.ones};
+        default:
+            return {};
+    }
+}
+
+/*
+    Each half of a ValueRange narrows the other. An interval that doesn't straddle zero
+    fixes the high bits lo and hi agree on, and the known bits bound the value between
+    the unknown bits all clear and all set, with an unknown sign bit taken as the
+    extreme that widens the bound. Conflicting facts only arise in code that can't run;
+    then the half that would be emptied is left as it was.
+*/
+static ValueRange refine(ValueRange range) {
+    if (range.lo >= 0 || range.hi < 0) {
+        uint32_t lo = static_cast<uint32_t>(range.lo);
+        uint32_t differ = lo ^ static_cast<uint32_t>(range.hi);
+        uint32_t prefix = ~0u;
+        while (differ) {
+            prefix <<= 1;
+            differ >>= 1;
+        }
+        KnownBits bits = {range.bits.zeros | (~lo & prefix), range.bits.ones | (lo & prefix)};
+        if (!(bits.zeros & bits.ones)) range.bits = bits;
+    }
+
+    uint32_t unknownSign = ~(range.bits.zeros | range.bits.ones) & 0x80000000u;
+    int64_t lo = std::max<int64_t>(range.lo, static_cast<int32_t>(range.bits.ones | unknownSign));
+    int64_t hi = std::min<int64_t>(range.hi, static_cast<int32_t>(~range.bits.zeros & ~unknownSign));
+    if (lo <= hi) {
+        range.lo = lo;
+        range.hi = hi;
+    }
+    return range;
+}
+
+static ValueRange join(const ValueRange& a, const ValueRange& b) {
+    return {std::min(a.lo, b.lo), std::max(a.hi, b.hi), {a.bits.zeros & b.bits.zeros, a.bits.ones & b.bits.ones}};
+}
+
+// --- Intervals ---
+
+static int64_t truncatedDivide(int64_t a, int64_t b) {
+    return a / b;
+}
+
+// Result of a comparison given the ranges of its operands: 0, 1, or -1 when either is possible
+static int compareRanges(TackyIRNodeType op, const ValueRange& a, const ValueRange& b) {
+    switch (op) {
+        case TackyIRNodeType::LESS_THAN:
+            if (a.hi < b.lo) return 1;
+            if (a.lo >= b.hi) return 0;
+            return -1;
+        case TackyIRNodeType::LESS_OR_EQUAL:
+            if (a.hi <= b.lo) return 1;
+            if (a.lo > b.hi) return 0;
+            return -1;
+        case TackyIRNodeType::GREATER_THAN:
+            return compareRanges(TackyIRNodeType::LESS_THAN, b, a);
+        case TackyIRNodeType::GREATER_OR_EQUAL:
+            return compareRanges(TackyIRNodeType::LESS_OR_EQUAL, b, a);
+        case TackyIRNodeType::EQUAL:
+            if (a.isConstant() && b.isConstant() && a.lo == b.lo) return 1;
+            if (a.hi < b.lo || b.hi < a.lo) return 0;
+            if ((a.bits.ones & b.bits.zeros) | (a.bits.zeros & b.bits.ones)) return 0;
+            return -1;
+        case TackyIRNodeType::NOT_EQUAL: {
+            int equal = compareRanges(TackyIRNodeType::EQUAL, a, b);
+            return equal == -1 ? -1 : !equal;
+        }
+        default:
+            return -1;
+    }
+}
+
+static ValueRange evalRangeUnary(TackyIRNodeType op, const ValueRange& a) {
+    switch (op) {
+        case TackyIRNodeType::NEGATE:
+            return clampToInt(-a.hi, -a.lo);
+        case TackyIRNodeType::COMPLEMENT:
+            return {~a.hi, ~a.lo};
+        case TackyIRNodeType::NOT:
+            if (!a.canBeZero()) return {0, 0};
+            if (a.isConstant()) return {1, 1};
+            return booleanRange;
+        default:
+            return fullRange;
+    }
+}
+
+static ValueRange evalRangeBinary(TackyIRNodeType op, const ValueRange& a, const ValueRange& b) {
+    if (isTackyComparison(op)) {
+        int outcome = compareRanges(op, a, b);
+        return outcome == -1 ? booleanRange : ValueRange{outcome, outcome};
+    }
+
+    switch (op) {
+        case TackyIRNodeType::ADD:
+            return clampToInt(a.lo + b.lo, a.hi + b.hi);
+        case TackyIRNodeType::SUBTRACT:
+            return clampToInt(a.lo - b.hi, a.hi - b.lo);
+        case TackyIRNodeType::MULTIPLY:
+            return fromCorners({a.lo * b.lo, a.lo * b.hi, a.hi * b.lo, a.hi * b.hi});
+        case TackyIRNodeType::DIVIDE:
+            // a divisor that may be zero could trap, so nothing is known about the result
+            if (b.contains(0)) return fullRange;
+            return fromCorners({truncatedDivide(a.lo, b.lo), truncatedDivide(a.lo, b.hi),
+                                truncatedDivide(a.hi, b.lo), truncatedDivide(a.hi, b.hi)});
+        case TackyIRNodeType::REMAINDER: {
+            if (b.contains(0)) return fullRange;
+            // |a % b| < |b| and never exceeds |a|; the sign follows the dividend
+            int64_t bound = std::max(std::abs(b.lo), std::abs(b.hi)) - 1;
+            if (a.lo >= 0) return {0, std::min(a.hi, bound)};
+            if (a.hi <= 0) return {std::max(a.lo, -bound), 0};
+            return {-bound, bound};
+        }
+        case TackyIRNodeType::SHIFT_RIGHT:
+            if (!b.isConstant()) return fullRange;
+            return {a.lo >> (b.lo & 31), a.hi >> (b.lo & 31)};
+        case TackyIRNodeType::BITWISE_AND:
+            if (a.lo >= 0 && b.lo >= 0) return {0, std::min(a.hi, b.hi)};
+            if (a.lo >= 0) return {0, a.hi};
+            if (b.lo >= 0) return {0, b.hi};
+            return fullRange;
+        case TackyIRNodeType::BITWISE_OR: {
+            if (a.lo < 0 || b.lo < 0) return fullRange;
+            // no bit above the highest one of either operand gets set
+            int64_t mask = 0;
+            while (mask < std::max(a.hi, b.hi)) mask = mask * 2 + 1;
+            return {std::max(a.lo, b.lo), mask};
+        }
+        default:
+            return fullRange;
+    }
+}
+
+static ValueRange evalUnary(TackyIRNodeType op, const ValueRange& a) {
+    ValueRange result = evalRangeUnary(op, a);
+    result.bits = evalBitsUnary(op, a);
+    return refine(result);
+}
+
+static ValueRange evalBinary(TackyIRNodeType op, const ValueRange& a, const ValueRange& b) {
+    ValueRange result = evalRangeBinary(op, a, b);
+    result.bits = evalBitsBinary(op, a, b);
+    return refine(result);
+}
+
+void passValueRange(TackyCFG& cfg) {
+    std::unordered_map<std::string, ValueRange> ranges;
+    std::unordered_map<std::string, int> updates;
+    std::unordered_set<std::string> defined = tackyDefinedNames(cfg);
+
+    // false while the operand's definition hasn't been reached yet
+    auto rangeOf = [&](const TackyIRNode* operand, ValueRange& out) {
+        auto constant = [](int32_t value) { return refine({value, value}); };
+        return tackyOperandLattice(operand, defined, ranges, constant, fullRange, out);
+    };
+
+    auto update = [&](const std::string& name, ValueRange range) {
+        auto it = ranges.find(name);
+        if (it != ranges.end() && it->second == range) return false;
+        if (++updates[name] > widenAfter) range = fullRange;
+        ranges[name] = range;
+        return true;
+    };
+
+    const std::vector<int>& rpo = cachedReversePostorder(cfg);
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int b : rpo) {
+            for (auto& instr : cfg.blocks[b].instructions) {
+                ValueRange a, c;
+                switch (instr->type) {
+                    case TackyIRNodeType::PHI: {
+                        auto* phi = static_cast<TackyIRPhi*>(instr.get());
+                        bool any = false;
+                        ValueRange merged;
+                        for (auto& arg : phi->args) {
+                            if (!rangeOf(arg.second.get(), a)) continue;
+                            merged = any ? join(merged, a) : a;
+                            any = true;
+                        }
+                        if (any) changed |= update(*tackyVarName(phi->dst.get()), refine(merged));
+                        break;
+                    }
+                    case TackyIRNodeType::COPY: {
+                        auto* copy = static_cast<TackyIRCopy*>(instr.get());
+                        if (rangeOf(copy->src.get(), a)) changed |= update(*tackyVarName(copy->dst.get()), a);
+                        break;
+                    }
+                    case TackyIRNodeType::UNARY: {
+                        auto* unary = static_cast<TackyIRUnary*>(instr.get());
+                        if (rangeOf(unary->src.get(), a))
+                            changed |= update(*tackyVarName(unary->dst.get()), evalUnary(unary->op->type, a));
+                        break;
+                    }
+                    case TackyIRNodeType::BINARY: {
+                        auto* binary = static_cast<TackyIRBinary*>(instr.get());
+                        if (rangeOf(binary->src1.get(), a) && rangeOf(binary->src2.get(), c))
+                            changed |= update(*tackyVarName(binary->dst.get()), evalBinary(binary->op->type, a, c));
+                        break;
+                    }
+                    default:
+                        break;
+                }
+            }
+        }
+    }
+
+    // --- Rewrite ---
+    for (auto& block : cfg.blocks) {
+        for (auto& instr : block.instructions) {
+            if (instr->type == TackyIRNodeType::JUMP_IF_ZERO || instr->type == TackyIRNodeType::JUMP_IF_NOT_ZERO) {
+                // a branch only cares whether its condition is zero
+                auto& condition = *tackyUses(instr.get())[0];
+                ValueRange range;
+                if (tackyVarName(condition.get()) && rangeOf(condition.get(), range) && !range.canBeZero())
+                    condition = std::make_unique<TackyIRConstant>("1");
+                continue;
+            }
+            if (instr->type != TackyIRNodeType::BINARY && instr->type != TackyIRNodeType::UNARY) continue;
+
+            auto& dst = *tackyDestination(instr.get());
+            ValueRange result;
+            if (!rangeOf(dst.get(), result)) continue;
+            if (result.isConstant()) {
+                instr = std::make_unique<TackyIRCopy>(
+                    std::make_unique<TackyIRConstant>(tackyConstantString(static_cast<int32_t>(result.lo))), std::move(dst));
+                continue;
+            }
+            if (instr->type != TackyIRNodeType::BINARY) continue;
+
+            auto* binary = static_cast<TackyIRBinary*>(instr.get());
+            TackyIRNodeType op = binary->op->type;
+            ValueRange lhs, rhs;
+            if (!rangeOf(binary->src1.get(), lhs) || !rangeOf(binary->src2.get(), rhs) || !rhs.isConstant()) continue;
+
+            uint32_t mask = static_cast<uint32_t>(rhs.lo);
+            if ((op == TackyIRNodeType::BITWISE_AND && (lhs.bits.zeros | mask) == ~0u) ||
+                (op == TackyIRNodeType::BITWISE_OR && (lhs.bits.ones & mask) == mask)) {
+                // the mask only clears bits already known to be 0, or sets bits already known to be 1
+                instr = std::make_unique<TackyIRCopy>(std::move(binary->src1), std::move(dst));
+                continue;
+            }
+            if (op != TackyIRNodeType::DIVIDE && op != TackyIRNodeType::REMAINDER) continue;
+
+            int64_t magnitude = std::abs(rhs.lo);
+            int log = powerOfTwoLog(magnitude);
+            bool nonNegative = lhs.lo >= 0;
+            // every bit a power-of-two divisor would drop is 0, so nothing needs rounding
+            bool exact = log != -1 && (lhs.bits.zeros & lowMask(log)) == lowMask(log);
+            if (op == TackyIRNodeType::REMAINDER && nonNegative && lhs.hi < magnitude) {
+                // x % d == x when 0 <= x < |d|
+                instr = std::make_unique<TackyIRCopy>(std::move(binary->src1), std::move(dst));
+            } else if (op == TackyIRNodeType::REMAINDER && nonNegative && log != -1) {
+                // the sign of the divisor doesn't affect a remainder
+                binary->op = std::make_unique<TackyIRBitwiseAnd>();
+                binary->src2 = std::make_unique<TackyIRConstant>(tackyConstantString(static_cast<int32_t>(magnitude - 1)));
+            } else if (op == TackyIRNodeType::DIVIDE && rhs.lo == 1) {
+                instr = std::make_unique<TackyIRCopy>(std::move(binary->src1), std::move(dst));
+            } else if (op == TackyIRNodeType::DIVIDE && rhs.lo > 0 && log != -1 && (nonNegative || exact)) {
+                // sarl rounds toward negative infinity, which only differs from truncation when
+                // a negative value has bits shifted out
+                binary->op = std::make_unique<TackyIRShiftRight>();
+                binary->src2 = std::make_unique<TackyIRConstant>(std::to_string(log));
+            }
+        }
+    }
+}
@@ -0,0 +1,13 @@
+#ifndef VALUE_RANGE_H
+#define VALUE_RANGE_H
+
+#include "tacky_cfg.h"
+
+// Interval and known-bits analysis over SSA names. Comparisons with a known outcome become
+// constants, branch conditions known to be nonzero become 1, masks that change no bit are
+// dropped, and divisions by powers of two become shifts and masks when the dividend is
+// non-negative or, for a shift, a multiple of the divisor. Run passSCCP afterwards to
+// propagate the new constants and fold the branches. The CFG must be in SSA form.
+void passValueRange(TackyCFG& cfg);
+
+#endif
@@ -0,0 +1,1070 @@
+#include "../src/target.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+    antcc-superopt: finds peephole rules for the legalized AsmIR the peephole pass sees.
+
+        clang++ -std=c++17 -O2 tools/superopt.cpp src/target.cpp -o antcc-superopt
+        ./antcc-superopt src/superopt_rules.h <antcc output>.s ...
+        tools/superopt_corpus.py ./antcc ./antcc-superopt src/superopt_rules.h
+
+    The last regenerates the checked-in header from its fixed sample corpus.
+
+    Every sequence of up to two instructions over three registers (slots), the immediates
+    0, 1, -1, 2 and the opcodes isel and legalization produce is run on a few fixed inputs
+    and filed under the resulting fingerprint. The source windows are every single
+    instruction plus the windows of up to three instructions found in the sample .s files;
+    each looks up the cheapest candidate with its fingerprint. A candidate is only taken
+    once the checker agrees: it runs both sequences on every input at 8 bits, where each
+    opcode has the same definition as at 32 bits (a "byte" is the low quarter and the top
+    shift count is width - 1), then on random and boundary inputs at 32 bits, and finally
+    proves them equal at 32 bits (see Proof).
+
+    Cost is the sum of -mtune=generic latencies, then the instruction count, and a rule must
+    be strictly cheaper, so rules can't undo each other. Windows that contain a smaller
+    window with a rule, or that throw a result away before reading it, are left out.
+*/
+
+// --- Instructions ---
+enum class Op : uint8_t { MOV, MOVZX, NEG, NOT, ADD, SUB, IMUL, AND, OR, XOR, SHL, SAR, SHR, LEA, CMP, TEST, SETCC };
+enum class Cond : uint8_t { E, NE, L, LE, G, GE }; // AsmIRCondCode order
+
+constexpr int SLOTS = 3;
+constexpr int8_t IMMEDIATE = -1;
+constexpr int8_t ABSENT = -2;
+constexpr int32_t TOP_SHIFT = 31; // shift count meaning width - 1
+
+struct Instr {
+    Op op;
+    int8_t src = ABSENT;   // slot or IMMEDIATE; Lea's base
+    int8_t index = ABSENT; // Lea only
+    int8_t dst = ABSENT;
+    int32_t imm = 0;       // immediate source, shift count or Lea displacement
+    int8_t scale = 1;
+    Cond cond = Cond::E;
+};
+
+using Sequence = std::vector<Instr>;
+
+static bool isBinary(Op op) {
+    return op == Op::ADD || op == Op::SUB || op == Op::IMUL || op == Op::AND || op == Op::OR || op == Op::XOR;
+}
+
+static bool isShift(Op op) {
+    return op == Op::SHL || op == Op::SAR || op == Op::SHR;
+}
+
+static bool writesFlags(Op op) {
+    return isBinary(op) || isShift(op) || op == Op::NEG || op == Op::CMP || op == Op::TEST;
+}
+
+static bool writesDst(Op op) {
+    return op != Op::CMP && op != Op::TEST;
+}
+
+// --- Interpreter ---
+struct Width {
+    int bits;
+    uint32_t mask;
+    uint32_t byteMask;
+};
+
+static Width widthOf(int bits) {
+    uint32_t mask = bits == 32 ? 0xffffffffu : (1u << bits) - 1;
+    return {bits, mask, (1u << (bits / 4)) - 1};
+}
+
+static int64_t signedValue(uint32_t value, const Width& w) {
+    uint32_t sign = 1u << (w.bits - 1);
+    return value & sign ? static_cast<int64_t>(value) - (int64_t(1) << w.bits) : value;
+}
+
+struct State {
+    uint32_t reg[SLOTS];
+    bool flagsKnown = false; // E..GE can be read off a signed compare of flagX with flagY
+    uint32_t flagX = 0, flagY = 0;
+};
+
+static bool holds(Cond cond, int64_t x, int64_t y) {
+    switch (cond) {
+        case Cond::E: return x == y;
+        case Cond::NE: return x != y;
+        case Cond::L: return x < y;
+        case Cond::LE: return x <= y;
+        case Cond::G: return x > y;
+        default: return x >= y;
+    }
+}
+
+// False when the sequence reads flags nothing in it has set
+static bool run(const Sequence& seq, const Width& w, State& s) {
+    for (const auto& in : seq) {
+        uint32_t src = in.src == IMMEDIATE ? static_cast<uint32_t>(in.imm) & w.mask : in.src >= 0 ? s.reg[in.src] : 0;
+        uint32_t& d = s.reg[in.dst >= 0 ? in.dst : 0];
+        uint32_t old = d;
+        uint32_t count = in.imm == TOP_SHIFT ? w.bits - 1 : in.imm;
+        switch (in.op) {
+            case Op::MOV: d = src; break;
+            case Op::MOVZX: d = src & w.byteMask; break;
+            case Op::NEG: d = (0u - old) & w.mask; s.flagsKnown = true; s.flagX = 0; s.flagY = old; break;
+            case Op::NOT: d = ~old & w.mask; break;
+            case Op::ADD: d = (old + src) & w.mask; s.flagsKnown = false; break;
+            case Op::SUB: d = (old - src) & w.mask; s.flagsKnown = true; s.flagX = old; s.flagY = src; break;
+            case Op::IMUL: d = (old * src) & w.mask; s.flagsKnown = false; break;
+            case Op::AND: d = old & src; s.flagsKnown = true; s.flagX = d; s.flagY = 0; break;
+            case Op::OR: d = old | src; s.flagsKnown = true; s.flagX = d; s.flagY = 0; break;
+            case Op::XOR: d = old ^ src; s.flagsKnown = true; s.flagX = d; s.flagY = 0; break;
+            case Op::SHL: d = (old << count) & w.mask; s.flagsKnown = false; break;
+            case Op::SAR: d = static_cast<uint32_t>(signedValue(old, w) >> count) & w.mask; s.flagsKnown = false; break;
+            case Op::SHR: d = old >> count; s.flagsKnown = false; break;
+            case Op::LEA: {
+                uint32_t index = in.index >= 0 ? s.reg[in.index] * static_cast<uint32_t>(in.scale) : 0;
+                d = (src + index + static_cast<uint32_t>(in.imm)) & w.mask;
+                break;
+            }
+            case Op::CMP: s.flagsKnown = true; s.flagX = old; s.flagY = src; break;
+            case Op::TEST: s.flagsKnown = true; s.flagX = old & src; s.flagY = 0; break;
+            case Op::SETCC:
+                if (!s.flagsKnown) return false;
+                d = (old & ~w.byteMask) | (holds(in.cond, signedValue(s.flagX, w), signedValue(s.flagY, w)) ? 1u : 0u);
+                break;
+        }
+    }
+    return true;
+}
+
+// --- Costs ---
+static InstrClass classOf(const Instr& in) {
+    switch (in.op) {
+        case Op::MOV:
+        case Op::MOVZX:
+            return InstrClass::MOVE;
+        case Op::IMUL: return InstrClass::MULTIPLY;
+        case Op::SHL:
+        case Op::SAR:
+        case Op::SHR:
+            return InstrClass::SHIFT;
+        case Op::CMP:
+        case Op::TEST:
+            return InstrClass::COMPARE;
+        case Op::SETCC: return InstrClass::SET_CC;
+        case Op::LEA:
+            if (in.index >= 0 && in.imm != 0) return InstrClass::LEA_THREE_PART;
+            return in.index >= 0 && in.scale > 1 ? InstrClass::LEA_SCALED : InstrClass::LEA;
+        default:
+            return InstrClass::ALU;
+    }
+}
+
+static int costOf(const Sequence& seq) {
+    int latency = 0;
+    for (const auto& in : seq) latency += targetLatency(classOf(in));
+    return latency * 8 + static_cast<int>(seq.size());
+}
+
+// --- Alphabet ---
+static const int32_t immediates[] = {0, 1, -1, 2};
+
+static std::vector<Instr> alphabet() {
+    std::vector<Instr> out;
+    for (int8_t d = 0; d < SLOTS; ++d) {
+        std::vector<Instr> sources;
+        for (int8_t s = 0; s < SLOTS; ++s) sources.push_back({Op::MOV, s});
+        for (int32_t imm : immediates) sources.push_back({Op::MOV, IMMEDIATE, ABSENT, ABSENT, imm});
+
+        for (Op op : {Op::MOV, Op::ADD, Op::SUB, Op::IMUL, Op::AND, Op::OR, Op::XOR, Op::CMP}) {
+            for (Instr in : sources) {
+                in.op = op;
+                in.dst = d;
+                out.push_back(in);
+            }
+        }
+        for (int8_t s = 0; s < SLOTS; ++s) {
+            out.push_back({Op::MOVZX, s, ABSENT, d});
+            out.push_back({Op::TEST, s, ABSENT, d});
+        }
+        out.push_back({Op::NEG, ABSENT, ABSENT, d});
+        out.push_back({Op::NOT, ABSENT, ABSENT, d});
+        for (Op op : {Op::SHL, Op::SAR, Op::SHR}) {
+            for (int32_t count : {1, TOP_SHIFT}) out.push_back({op, ABSENT, ABSENT, d, count});
+        }
+        for (int c = 0; c < 6; ++c) out.push_back({Op::SETCC, ABSENT, ABSENT, d, 0, 1, static_cast<Cond>(c)});
+
+        for (int8_t index = 0; index < SLOTS; ++index) {
+            for (int32_t disp : {0, 1, -1}) {
+                for (int8_t scale : {2, 4, 8}) out.push_back({Op::LEA, ABSENT, index, d, disp, scale});
+            }
+        }
+        for (int8_t base = 0; base < SLOTS; ++base) {
+            for (int32_t disp : {0, 1, -1}) {
+                if (disp != 0) out.push_back({Op::LEA, base, ABSENT, d, disp});
+                for (int8_t index = 0; index < SLOTS; ++index) {
+                    for (int8_t scale : {1, 2, 4, 8}) out.push_back({Op::LEA, base, index, d, disp, scale});
+                }
+            }
+        }
+    }
+    return out;
+}
+
+static int slotsRead(const Instr& in, int8_t slots[3]) {
+    int n = 0;
+    if (in.src >= 0) slots[n++] = in.src;
+    if (in.index >= 0) slots[n++] = in.index;
+    return n;
+}
+
+// Bit set of the slots a sequence names
+static unsigned slotMask(const Sequence& seq) {
+    unsigned mask = 0;
+    for (const auto& in : seq) {
+        int8_t read[3];
+        for (int i = 0, n = slotsRead(in, read); i < n; ++i) mask |= 1u << read[i];
+        if (in.dst >= 0) mask |= 1u << in.dst;
+    }
+    return mask;
+}
+
+// Slots first appear as 0, then 1, then 2, so each window is enumerated once
+static bool isCanonical(const Sequence& seq) {
+    int next = 0;
+    auto see = [&](int8_t slot) {
+        if (slot < 0 || slot < next) return true;
+        if (slot > next) return false;
+        next++;
+        return true;
+    };
+    for (const auto& in : seq) {
+        if (!see(in.src) || !see(in.index) || !see(in.dst)) return false;
+    }
+    return true;
+}
+
+// A register or the flags overwritten before anything reads them, or flags that nothing
+// reads at all. Isel never leaves those behind, and they would only pad the table.
+static bool hasDeadWrite(const Sequence& seq) {
+    bool pending[SLOTS] = {false, false, false};
+    bool flagsPending = false;
+    for (const auto& in : seq) {
+        int8_t read[3];
+        for (int i = 0, n = slotsRead(in, read); i < n; ++i) pending[read[i]] = false;
+        bool readsDst = in.op != Op::MOV && in.op != Op::MOVZX && in.op != Op::LEA;
+        if (in.dst >= 0 && readsDst) pending[in.dst] = false;
+        if (in.op == Op::SETCC) flagsPending = false;
+
+        if (writesDst(in.op) && in.dst >= 0) {
+            if (pending[in.dst]) return true;
+            pending[in.dst] = true;
+        }
+        if (in.op == Op::CMP || in.op == Op::TEST) {
+            if (flagsPending) return true;
+            flagsPending = true;
+        } else if (writesFlags(in.op)) {
+            if (flagsPending) return true;
+        }
+    }
+    return flagsPending;
+}
+
+// Every instruction has to be tied to the others through the registers or flags it reads
+// or writes, otherwise the window is two unrelated windows side by side
+static bool isConnected(const Sequence& seq) {
+    std::vector<int> group(seq.size());
+    for (size_t i = 0; i < seq.size(); ++i) group[i] = static_cast<int>(i);
+    auto root = [&](int i) {
+        while (group[i] != i) i = group[i];
+        return i;
+    };
+    auto touches = [](const Instr& in, int8_t slot) {
+        return in.src == slot || in.index == slot || in.dst == slot;
+    };
+    for (size_t i = 0; i < seq.size(); ++i) {
+        for (size_t j = i + 1; j < seq.size(); ++j) {
+            bool linked = seq[j].op == Op::SETCC && writesFlags(seq[i].op);
+            for (int8_t slot = 0; slot < SLOTS && !linked; ++slot) linked = touches(seq[i], slot) && touches(seq[j], slot);
+            if (linked) group[root(static_cast<int>(j))] = root(static_cast<int>(i));
+        }
+    }
+    for (size_t i = 1; i < seq.size(); ++i) {
+        if (root(static_cast<int>(i)) != root(0)) return false;
+    }
+    return true;
+}
+
+// --- Fingerprints ---
+struct TestInputs {
+    std::vector<std::array<uint32_t, SLOTS>> vectors;
+};
+
+static uint32_t interesting(std::mt19937& rng) {
+    static const uint32_t edges[] = {0, 1, 2, 3, 0xffffffffu, 0xfffffffeu, 0x7fffffffu, 0x80000000u, 0x80000001u, 0xff, 0x100};
+    switch (rng() % 4) {
+        case 0: return edges[rng() % (sizeof(edges) / sizeof(edges[0]))];
+        case 1: return rng() % 16 - 8;
+        default: return rng();
+    }
+}
+
+static TestInputs makeInputs(int count, uint32_t seed) {
+    std::mt19937 rng(seed);
+    TestInputs inputs;
+    for (int i = 0; i < count; ++i) {
+        std::array<uint32_t, SLOTS> v;
+        for (auto& value : v) value = interesting(rng);
+        inputs.vectors.push_back(v);
+    }
+    return inputs;
+}
+
+// 0 for a sequence that reads flags it never set
+static uint64_t fingerprint(const Sequence& seq, const TestInputs& inputs) {
+    static const Width w = widthOf(32);
+    uint64_t hash = 1469598103934665603ull;
+    for (const auto& v : inputs.vectors) {
+        State s;
+        std::copy(v.begin(), v.end(), s.reg);
+        if (!run(seq, w, s)) return 0;
+        for (uint32_t r : s.reg) hash = (hash ^ r) * 1099511628211ull;
+    }
+    return hash | 1;
+}
+
+// --- Proof ---
+/*
+    The tests only sample the 32-bit behaviour, so a rule is kept once both sequences build
+    the same binary decision diagram for every bit of every slot at 32 bits. Diagrams are
+    canonical: equal functions get equal node ids. Variables are ordered by bit position,
+    lowest first, which keeps adders, shifts and comparators linear in the width. A product
+    of two registers has no small diagram, so its bits are fresh variables shared by every
+    product of the same two operands in either order; that can only reject a rule, never
+    accept a wrong one.
+*/
+class Bdd {
+public:
+    static constexpr int ZERO = 0;
+    static constexpr int ONE = 1;
+    bool exhausted = false; // grew past maxNodes; every answer since is meaningless
+
+    Bdd() : nodes{{terminal, 0, 0}, {terminal, 1, 1}} {}
+
+    int variable(int var) { return make(var, ZERO, ONE); }
+    int ite(int f, int g, int h);
+    int negate(int f) { return ite(f, ZERO, ONE); }
+    int both(int f, int g) { return ite(f, g, ZERO); }
+    int either(int f, int g) { return ite(f, ONE, g); }
+    int differ(int f, int g) { return ite(f, negate(g), g); }
+
+private:
+    struct Node {
+        int var, low, high;
+    };
+    static constexpr int terminal = 1 << 20;
+    static constexpr size_t maxNodes = 1 << 20;
+    std::vector<Node> nodes;
+    std::unordered_map<uint64_t, int> unique;
+    std::unordered_map<uint64_t, int> computed;
+
+    int make(int var, int low, int high);
+    int cofactor(int f, int var, bool value) const {
+        if (nodes[f].var != var) return f;
+        return value ? nodes[f].high : nodes[f].low;
+    }
+};
+
+int Bdd::make(int var, int low, int high) {
+    if (low == high) return low;
+    uint64_t k = static_cast<uint64_t>(var) << 42 | static_cast<uint64_t>(low) << 21 | static_cast<uint64_t>(high);
+    auto it = unique.find(k);
+    if (it != unique.end()) return it->second;
+    if (nodes.size() >= maxNodes) {
+        exhausted = true;
+        return ZERO;
+    }
+    nodes.push_back({var, low, high});
+    return unique[k] = static_cast<int>(nodes.size() - 1);
+}
+
+int Bdd::ite(int f, int g, int h) {
+    if (exhausted) return ZERO;
+    if (f == ONE || g == h) return g;
+    if (f == ZERO) return h;
+    if (g == ONE && h == ZERO) return f;
+    uint64_t k = static_cast<uint64_t>(f) << 42 | static_cast<uint64_t>(g) << 21 | static_cast<uint64_t>(h);
+    auto it = computed.find(k);
+    if (it != computed.end()) return it->second;
+    int var = std::min({nodes[f].var, nodes[g].var, nodes[h].var});
+    int high = ite(cofactor(f, var, true), cofactor(g, var, true), cofactor(h, var, true));
+    int low = ite(cofactor(f, var, false), cofactor(g, var, false), cofactor(h, var, false));
+    return computed[k] = make(var, low, high);
+}
+
+using Word = std::array<int, 32>; // node per bit, lowest first
+
+// Bit i of slot s is variable i * VARIABLES_PER_BIT + s; products take the ones after the slots
+constexpr int MAX_PRODUCTS = 8;
+constexpr int VARIABLES_PER_BIT = SLOTS + MAX_PRODUCTS;
+
+struct SymbolicState {
+    Word reg[SLOTS];
+    bool flagsKnown = false;
+    Word flagX{}, flagY{};
+};
+
+struct Circuit {
+    Bdd bdd;
+    std::map<std::pair<Word, Word>, int> products;
+    bool outOfProducts = false;
+
+    Word constant(uint32_t value) {
+        Word w;
+        for (int i = 0; i < 32; ++i) w[i] = value >> i & 1 ? Bdd::ONE : Bdd::ZERO;
+        return w;
+    }
+
+    Word input(int slot) {
+        Word w;
+        for (int i = 0; i < 32; ++i) w[i] = bdd.variable(i * VARIABLES_PER_BIT + slot);
+        return w;
+    }
+
+    Word invert(const Word& a) {
+        Word w;
+        for (int i = 0; i < 32; ++i) w[i] = bdd.negate(a[i]);
+        return w;
+    }
+
+    Word add(const Word& a, const Word& b, int carry = Bdd::ZERO) {
+        Word w;
+        for (int i = 0; i < 32; ++i) {
+            w[i] = bdd.differ(bdd.differ(a[i], b[i]), carry);
+            carry = bdd.either(bdd.both(a[i], b[i]), bdd.both(carry, bdd.differ(a[i], b[i])));
+        }
+        return w;
+    }
+
+    Word subtract(const Word& a, const Word& b) { return add(a, invert(b), Bdd::ONE); }
+
+    // Shifts by a constant count; arithmetic copies the top bit into the vacated ones
+    Word shiftLeft(const Word& a, int count) {
+        Word w;
+        for (int i = 0; i < 32; ++i) w[i] = i >= count ? a[i - count] : Bdd::ZERO;
+        return w;
+    }
+
+    Word shiftRight(const Word& a, int count, bool arithmetic) {
+        Word w;
+        for (int i = 0; i < 32; ++i) w[i] = i + count < 32 ? a[i + count] : arithmetic ? a[31] : Bdd::ZERO;
+        return w;
+    }
+
+    Word bitwise(const Word& a, const Word& b, Op op) {
+        Word w;
+        for (int i = 0; i < 32; ++i) {
+            w[i] = op == Op::AND ? bdd.both(a[i], b[i]) : op == Op::OR ? bdd.either(a[i], b[i]) : bdd.differ(a[i], b[i]);
+        }
+        return w;
+    }
+
+    static bool isConstant(const Word& a) {
+        return std::all_of(a.begin(), a.end(), [](int bit) { return bit == Bdd::ZERO || bit == Bdd::ONE; });
+    }
+
+    Word multiply(const Word& a, const Word& b) {
+        if (isConstant(a) && !isConstant(b)) return multiply(b, a);
+        if (isConstant(b)) {
+            // a sum of many shifted copies of one word has no small diagram, so a negative
+            // factor is applied as -(a * -b), which turns imul $-1 into one negation
+            Word negated = subtract(constant(0), b);
+            if (b[31] == Bdd::ONE && negated[31] == Bdd::ZERO) return subtract(constant(0), multiply(a, negated));
+            Word sum = constant(0);
+            for (int i = 0; i < 32; ++i) {
+                if (b[i] == Bdd::ONE) sum = add(sum, shiftLeft(a, i));
+            }
+            return sum;
+        }
+        auto key = a < b ? std::make_pair(a, b) : std::make_pair(b, a);
+        auto it = products.find(key);
+        int product = it != products.end() ? it->second : static_cast<int>(products.size());
+        if (product >= MAX_PRODUCTS) {
+            outOfProducts = true;
+            return constant(0);
+        }
+        products[key] = product;
+        Word w;
+        for (int i = 0; i < 32; ++i) w[i] = bdd.variable(i * VARIABLES_PER_BIT + SLOTS + product);
+        return w;
+    }
+
+    int holds(Cond cond, const Word& x, const Word& y) {
+        int equal = Bdd::ONE, less = Bdd::ZERO;
+        for (int i = 0; i < 32; ++i) {
+            int same = bdd.negate(bdd.differ(x[i], y[i]));
+            // the sign bit counts the other way round
+            int lower = i == 31 ? bdd.both(x[i], bdd.negate(y[i])) : bdd.both(bdd.negate(x[i]), y[i]);
+            less = bdd.either(lower, bdd.both(same, less));
+            equal = bdd.both(equal, same);
+        }
+        switch (cond) {
+            case Cond::E: return equal;
+            case Cond::NE: return bdd.negate(equal);
+            case Cond::L: return less;
+            case Cond::LE: return bdd.either(less, equal);
+            case Cond::G: return bdd.negate(bdd.either(less, equal));
+            default: return bdd.negate(less);
+        }
+    }
+};
+
+// run at 32 bits, over diagrams instead of values
+static bool runSymbolic(const Sequence& seq, Circuit& c, SymbolicState& s) {
+    for (const auto& in : seq) {
+        Word src = in.src == IMMEDIATE ? c.constant(static_cast<uint32_t>(in.imm)) : in.src >= 0 ? s.reg[in.src] : c.constant(0);
+        Word& d = s.reg[in.dst >= 0 ? in.dst : 0];
+        Word old = d;
+        int count = in.imm == TOP_SHIFT ? 31 : in.imm;
+        switch (in.op) {
+            case Op::MOV: d = src; break;
+            case Op::MOVZX: d = c.bitwise(src, c.constant(0xff), Op::AND); break;
+            case Op::NEG:
+                d = c.subtract(c.constant(0), old);
+                s.flagsKnown = true;
+                s.flagX = c.constant(0);
+                s.flagY = old;
+                break;
+            case Op::NOT: d = c.invert(old); break;
+            case Op::ADD: d = c.add(old, src); s.flagsKnown = false; break;
+            case Op::SUB: d = c.subtract(old, src); s.flagsKnown = true; s.flagX = old; s.flagY = src; break;
+            case Op::IMUL: d = c.multiply(old, src); s.flagsKnown = false; break;
+            case Op::AND:
+            case Op::OR:
+            case Op::XOR:
+                d = c.bitwise(old, src, in.op);
+                s.flagsKnown = true;
+                s.flagX = d;
+                s.flagY = c.constant(0);
+                break;
+            case Op::SHL: d = c.shiftLeft(old, count); s.flagsKnown = false; break;
+            case Op::SAR: d = c.shiftRight(old, count, true); s.flagsKnown = false; break;
+            case Op::SHR: d = c.shiftRight(old, count, false); s.flagsKnown = false; break;
+            case Op::LEA: {
+                Word index = in.index >= 0 ? c.multiply(s.reg[in.index], c.constant(static_cast<uint32_t>(in.scale))) : c.constant(0);
+                d = c.add(c.add(src, index), c.constant(static_cast<uint32_t>(in.imm)));
+                break;
+            }
+            case Op::CMP: s.flagsKnown = true; s.flagX = old; s.flagY = src; break;
+            case Op::TEST: s.flagsKnown = true; s.flagX = c.bitwise(old, src, Op::AND); s.flagY = c.constant(0); break;
+            case Op::SETCC:
+                if (!s.flagsKnown) return false;
+                d = c.bitwise(old, c.constant(~0xffu), Op::AND);
+                d[0] = c.holds(in.cond, s.flagX, s.flagY);
+                break;
+        }
+    }
+    return true;
+}
+
+static bool proveEquivalent(const Sequence& source, const Sequence& candidate) {
+    Circuit c;
+    SymbolicState a, b;
+    for (int slot = 0; slot < SLOTS; ++slot) a.reg[slot] = b.reg[slot] = c.input(slot);
+    if (!runSymbolic(source, c, a) || !runSymbolic(candidate, c, b)) return false;
+    if (c.bdd.exhausted || c.outOfProducts) return false;
+    return std::equal(a.reg, a.reg + SLOTS, b.reg);
+}
+
+// --- Checker ---
+static bool sameResult(const Sequence& a, const Sequence& b, const Width& w, const uint32_t inputs[SLOTS]) {
+    State sa, sb;
+    std::copy(inputs, inputs + SLOTS, sa.reg);
+    std::copy(inputs, inputs + SLOTS, sb.reg);
+    if (!run(a, w, sa) || !run(b, w, sb)) return false;
+    return std::equal(sa.reg, sa.reg + SLOTS, sb.reg);
+}
+
+static bool equivalent(const Sequence& source, const Sequence& candidate) {
+    // every input at 8 bits, for the slots the source names
+    const Width narrow = widthOf(8);
+    unsigned mask = slotMask(source);
+    uint32_t limit[SLOTS];
+    for (int i = 0; i < SLOTS; ++i) limit[i] = mask & (1u << i) ? 256 : 1;
+    uint32_t v[SLOTS];
+    for (v[0] = 0; v[0] < limit[0]; ++v[0]) {
+        for (v[1] = 0; v[1] < limit[1]; ++v[1]) {
+            for (v[2] = 0; v[2] < limit[2]; ++v[2]) {
+                if (!sameResult(source, candidate, narrow, v)) return false;
+            }
+        }
+    }
+
+    const Width wide = widthOf(32);
+    static const TestInputs random = makeInputs(200000, 0x5eed);
+    for (const auto& vector : random.vectors) {
+        if (!sameResult(source, candidate, wide, vector.data())) return false;
+    }
+    return proveEquivalent(source, candidate);
+}
+
+// --- Search ---
+struct Rule {
+    Sequence source;
+    Sequence replacement;
+    int seen; // times the source turned up in the samples
+};
+
+// Only the cheapest few of each fingerprint are kept; equal fingerprints can still differ
+constexpr size_t CANDIDATES_PER_FINGERPRINT = 6;
+
+struct CandidateTable {
+    std::unordered_map<uint64_t, std::vector<Sequence>> byFingerprint;
+
+    void add(const Sequence& seq, uint64_t fp) {
+        auto& bucket = byFingerprint[fp];
+        int cost = costOf(seq);
+        auto at = std::find_if(bucket.begin(), bucket.end(), [&](const Sequence& other) { return costOf(other) > cost; });
+        if (bucket.size() >= CANDIDATES_PER_FINGERPRINT && at == bucket.end()) return;
+        bucket.insert(at, seq);
+        if (bucket.size() > CANDIDATES_PER_FINGERPRINT) bucket.pop_back();
+    }
+};
+
+static std::string key(const Sequence& seq) {
+    std::string k;
+    for (const auto& in : seq) {
+        k += std::to_string(static_cast<int>(in.op)) + "," + std::to_string(in.src) + "," + std::to_string(in.index) + "," +
+             std::to_string(in.dst) + "," + std::to_string(in.imm) + "," + std::to_string(in.scale) + "," +
+             std::to_string(static_cast<int>(in.cond)) + ";";
+    }
+    return k;
+}
+
+// Renames slots in order of first appearance
+static Sequence canonicalize(Sequence seq) {
+    int8_t rename[SLOTS] = {ABSENT, ABSENT, ABSENT};
+    int8_t next = 0;
+    auto map = [&](int8_t& slot) {
+        if (slot < 0) return;
+        if (rename[slot] == ABSENT) rename[slot] = next++;
+        slot = rename[slot];
+    };
+    for (auto& in : seq) {
+        map(in.src);
+        map(in.index);
+        map(in.dst);
+    }
+    return seq;
+}
+
+// seq is a rule's source already, or has one inside it; a sampled window can repeat a
+// single instruction rule found before the samples were read
+static bool containsRule(const Sequence& seq, const std::set<std::string>& ruleSources) {
+    for (size_t length = 1; length <= seq.size(); ++length) {
+        for (size_t start = 0; start + length <= seq.size(); ++start) {
+            Sequence window(seq.begin() + start, seq.begin() + start + length);
+            if (ruleSources.count(key(canonicalize(window)))) return true;
+        }
+    }
+    return false;
+}
+
+// --- Samples ---
+/*
+    Source windows come from assembly antcc has emitted, so the table covers the shapes
+    that actually turn up. Any instruction outside the alphabet - a stack slot, a label,
+    cdq, an immediate other than 0, 1, -1 or 2 - ends the windows running through it.
+*/
+struct Window {
+    Sequence sequence;
+    int seen;
+};
+
+static std::string trim(const std::string& text) {
+    size_t first = text.find_first_not_of(" \t");
+    size_t last = text.find_last_not_of(" \t\r");
+    return first == std::string::npos ? "" : text.substr(first, last - first + 1);
+}
+
+// eax, rax and al all name the same register
+static std::string registerName(std::string name) {
+    if (name.size() > 1 && name[0] == 'r' && std::isdigit(static_cast<unsigned char>(name[1]))) {
+        while (!name.empty() && !std::isdigit(static_cast<unsigned char>(name.back()))) name.pop_back();
+        return name;
+    }
+    if (name == "al") return "ax";
+    if (name == "cl") return "cx";
+    if (name == "dl") return "dx";
+    if (name == "sil") return "si";
+    if (name == "dil") return "di";
+    if (name.size() == 3 && (name[0] == 'e' || name[0] == 'r')) return name.substr(1);
+    return "";
+}
+
+struct SampleInstr {
+    bool valid = false;
+    Instr instr{Op::MOV};
+    std::string registers[3]; // src, index, dst, before they're mapped to slots
+};
+
+static bool parseRegister(const std::string& text, std::string& name) {
+    if (text.size() < 2 || text[0] != '%') return false;
+    name = registerName(text.substr(1));
+    return !name.empty();
+}
+
+static bool parseImmediate(const std::string& text, int32_t& value) {
+    if (text.size() < 2 || text[0] != '$') return false;
+    value = std::stoi(text.substr(1));
+    return true;
+}
+
+static bool isAlphabetImmediate(int32_t value) {
+    return std::find(std::begin(immediates), std::end(immediates), value) != std::end(immediates);
+}
+
+// src, dst operands split at the top-level comma
+static std::vector<std::string> operandList(const std::string& text) {
+    std::vector<std::string> operands;
+    int depth = 0;
+    std::string current;
+    for (char ch : text) {
+        if (ch == '(') depth++;
+        if (ch == ')') depth--;
+        if (ch == ',' && depth == 0) {
+            operands.push_back(trim(current));
+            current.clear();
+        } else {
+            current += ch;
+        }
+    }
+    if (!trim(current).empty()) operands.push_back(trim(current));
+    return operands;
+}
+
+static bool parseLea(const std::string& address, SampleInstr& out) {
+    size_t open = address.find('('), close = address.find(')');
+    if (open == std::string::npos || close == std::string::npos) return false;
+    out.instr.imm = open == 0 ? 0 : std::stoi(address.substr(0, open));
+    if (out.instr.imm < -1 || out.instr.imm > 1) return false;
+
+    std::vector<std::string> parts;
+    std::string inner = address.substr(open + 1, close - open - 1), part;
+    for (char ch : inner + ",") {
+        if (ch == ',') {
+            parts.push_back(trim(part));
+            part.clear();
+        } else {
+            part += ch;
+        }
+    }
+    if (!parts[0].empty() && !parseRegister(parts[0], out.registers[0])) return false;
+    if (parts.size() >= 2 && !parseRegister(parts[1], out.registers[1])) return false;
+    out.instr.scale = parts.size() >= 3 ? static_cast<int8_t>(std::stoi(parts[2])) : 1;
+    return parts.size() == 1 || parts.size() == 3;
+}
+
+static SampleInstr parseSample(const std::string& line) {
+    static const std::vector<std::pair<std::string, Op>> mnemonics = {
+        {"movl", Op::MOV}, {"movzbl", Op::MOVZX}, {"negl", Op::NEG}, {"notl", Op::NOT}, {"addl", Op::ADD},
+        {"subl", Op::SUB}, {"imull", Op::IMUL}, {"andl", Op::AND}, {"orl", Op::OR}, {"xorl", Op::XOR},
+        {"sall", Op::SHL}, {"shll", Op::SHL}, {"sarl", Op::SAR}, {"shrl", Op::SHR}, {"leal", Op::LEA},
+        {"cmpl", Op::CMP}, {"testl", Op::TEST},
+    };
+    static const char* const conditions[] = {"e", "ne", "l", "le", "g", "ge"};
+
+    SampleInstr out;
+    std::string text = trim(line);
+    size_t space = text.find(' ');
+    if (space == std::string::npos) return out;
+    std::string mnemonic = text.substr(0, space);
+    std::vector<std::string> operands = operandList(text.substr(space + 1));
+
+    if (mnemonic.compare(0, 3, "set") == 0) {
+        for (int c = 0; c < 6; ++c) {
+            if (mnemonic.substr(3) != conditions[c]) continue;
+            out.instr = {Op::SETCC, ABSENT, ABSENT, ABSENT, 0, 1, static_cast<Cond>(c)};
+            out.valid = operands.size() == 1 && parseRegister(operands[0], out.registers[2]);
+        }
+        return out;
+    }
+
+    auto it = std::find_if(mnemonics.begin(), mnemonics.end(), [&](const auto& entry) { return entry.first == mnemonic; });
+    if (it == mnemonics.end()) return out;
+    out.instr.op = it->second;
+    if (out.instr.op == Op::NEG || out.instr.op == Op::NOT) {
+        out.valid = operands.size() == 1 && parseRegister(operands[0], out.registers[2]);
+        return out;
+    }
+    if (operands.size() != 2 || !parseRegister(operands[1], out.registers[2])) return out;
+
+    if (out.instr.op == Op::LEA) {
+        out.valid = parseLea(operands[0], out);
+    } else if (isShift(out.instr.op)) {
+        out.valid = parseImmediate(operands[0], out.instr.imm) && (out.instr.imm == 1 || out.instr.imm == TOP_SHIFT);
+    } else if (parseImmediate(operands[0], out.instr.imm)) {
+        out.instr.src = IMMEDIATE;
+        out.valid = isAlphabetImmediate(out.instr.imm);
+    } else {
+        out.valid = parseRegister(operands[0], out.registers[0]);
+    }
+    return out;
+}
+
+// Names the registers of a run of instructions as slots, if three are enough
+static bool toSequence(const std::vector<SampleInstr>& run, Sequence& seq) {
+    std::vector<std::string> names;
+    auto slotOf = [&](const std::string& name) -> int8_t {
+        if (name.empty()) return ABSENT;
+        auto it = std::find(names.begin(), names.end(), name);
+        if (it != names.end()) return static_cast<int8_t>(it - names.begin());
+        names.push_back(name);
+        return static_cast<int8_t>(names.size() - 1);
+    };
+    seq.clear();
+    for (const auto& sample : run) {
+        Instr in = sample.instr;
+        if (in.src != IMMEDIATE) in.src = slotOf(sample.registers[0]);
+        in.index = slotOf(sample.registers[1]);
+        in.dst = slotOf(sample.registers[2]);
+        seq.push_back(in);
+    }
+    return names.size() <= SLOTS;
+}
+
+static std::vector<Window> readSamples(int count, char* paths[]) {
+    std::unordered_map<std::string, Window> windows;
+    for (int i = 0; i < count; ++i) {
+        std::ifstream file(paths[i]);
+        if (!file) {
+            std::cerr << "cannot read " << paths[i] << "\n";
+            continue;
+        }
+        std::vector<SampleInstr> instrs;
+        std::string line;
+        while (std::getline(file, line)) instrs.push_back(parseSample(line));
+
+        for (size_t start = 0; start < instrs.size(); ++start) {
+            for (size_t length = 1; length <= 3 && start + length <= instrs.size(); ++length) {
+                if (!instrs[start + length - 1].valid) break;
+                std::vector<SampleInstr> run(instrs.begin() + start, instrs.begin() + start + length);
+                Sequence seq;
+                if (!toSequence(run, seq)) break;
+                seq = canonicalize(seq);
+                auto& window = windows[key(seq)];
+                window.sequence = seq;
+                window.seen++;
+            }
+        }
+    }
+
+    std::vector<Window> sorted;
+    for (auto& entry : windows) sorted.push_back(entry.second);
+    std::sort(sorted.begin(), sorted.end(), [](const Window& a, const Window& b) {
+        return a.seen != b.seen ? a.seen > b.seen : key(a.sequence) < key(b.sequence);
+    });
+    return sorted;
+}
+
+static std::vector<Rule> search(const std::vector<Window>& windows) {
+    TestInputs inputs = makeInputs(12, 0xa17cc);
+    std::vector<Instr> full = alphabet();
+
+    CandidateTable table;
+    table.add({}, fingerprint({}, inputs));
+    for (const auto& a : full) {
+        uint64_t fp = fingerprint({a}, inputs);
+        if (fp) table.add({a}, fp);
+        for (const auto& b : full) {
+            fp = fingerprint({a, b}, inputs);
+            if (fp) table.add({a, b}, fp);
+        }
+    }
+
+    std::vector<Rule> rules;
+    std::set<std::string> ruleSources;
+    auto consider = [&](const Sequence& source, int seen) {
+        if (!isConnected(source) || hasDeadWrite(source) || containsRule(source, ruleSources)) return;
+        uint64_t fp = fingerprint(source, inputs);
+        if (!fp) return;
+        auto it = table.byFingerprint.find(fp);
+        if (it == table.byFingerprint.end()) return;
+        int cost = costOf(source);
+        unsigned mask = slotMask(source);
+        for (const auto& candidate : it->second) {
+            if (costOf(candidate) >= cost) break;
+            // trading one instruction for two cheaper ones is the scheduler's business
+            if (candidate.size() > source.size()) continue;
+            if ((slotMask(candidate) & ~mask) != 0 || !equivalent(source, candidate)) continue;
+            rules.push_back({source, candidate, seen});
+            ruleSources.insert(key(source));
+            return;
+        }
+    };
+
+    // every single instruction, then the sampled windows, shortest and most common first
+    for (const auto& a : full) {
+        if (isCanonical({a})) consider({a}, 0);
+    }
+    for (size_t length = 1; length <= 3; ++length) {
+        for (const auto& window : windows) {
+            if (window.sequence.size() == length) consider(window.sequence, window.seen);
+        }
+    }
+    return rules;
+}
+
+// --- Output ---
+static const char* asmOpName(Op op) {
+    switch (op) {
+        case Op::MOV: return "MOV";
+        case Op::MOVZX: return "MOVZX";
+        case Op::NEG: return "NEG";
+        case Op::NOT: return "NOT";
+        case Op::ADD: return "ADD";
+        case Op::SUB: return "SUBTRACT";
+        case Op::IMUL: return "MULTIPLY";
+        case Op::AND: return "AND";
+        case Op::OR: return "OR";
+        case Op::XOR: return "XOR";
+        case Op::SHL: return "SHL";
+        case Op::SAR: return "SAR";
+        case Op::SHR: return "SHR";
+        case Op::LEA: return "LEA";
+        case Op::CMP: return "CMP";
+        case Op::TEST: return "TEST";
+        default: return "SET_CC";
+    }
+}
+
+static const char* const condNames[] = {"E", "NE", "L", "LE", "G", "GE"};
+
+static std::string operandText(int8_t slot, int32_t imm) {
+    if (slot == IMMEDIATE) return "$" + std::to_string(imm);
+    return "%" + std::to_string(slot);
+}
+
+// AT&T-ish rendering for the comments, with %N for slot N
+static std::string text(const Instr& in) {
+    static const char* const mnemonics[] = {"movl", "movzbl", "negl", "notl", "addl", "subl", "imull", "andl", "orl", "xorl",
+                                            "sall", "sarl", "shrl", "leal", "cmpl", "testl", "set"};
+    std::string m = mnemonics[static_cast<int>(in.op)];
+    std::string dst = operandText(in.dst, 0);
+    switch (in.op) {
+        case Op::NEG:
+        case Op::NOT:
+            return m + " " + dst;
+        case Op::SETCC: {
+            std::string cc = condNames[static_cast<int>(in.cond)];
+            for (auto& ch : cc) ch = static_cast<char>(std::tolower(ch));
+            return m + cc + " " + dst;
+        }
+        case Op::SHL:
+        case Op::SAR:
+        case Op::SHR:
+            return m + " $" + std::to_string(in.imm) + ", " + dst;
+        case Op::LEA: {
+            std::string address = (in.imm ? std::to_string(in.imm) : "") + "(" + (in.src >= 0 ? operandText(in.src, 0) : "");
+            if (in.index >= 0) address += ", " + operandText(in.index, 0) + ", " + std::to_string(in.scale);
+            return m + " " + address + "), " + dst;
+        }
+        default:
+            return m + " " + operandText(in.src, in.imm) + ", " + dst;
+    }
+}
+
+static std::string text(const Sequence& seq) {
+    if (seq.empty()) return "(nothing)";
+    std::string out;
+    for (const auto& in : seq) out += (out.empty() ? "" : "; ") + text(in);
+    return out;
+}
+
+static std::string initializer(const Instr& in) {
+    return "{AsmIRNodeType::" + std::string(asmOpName(in.op)) + ", " + std::to_string(in.src) + ", " + std::to_string(in.index) +
+           ", " + std::to_string(in.dst) + ", " + std::to_string(in.imm) + ", " + std::to_string(in.scale) +
+           ", AsmIRCondCode::" + condNames[static_cast<int>(in.cond)] + "}";
+}
+
+static std::string initializer(const Sequence& seq, size_t capacity) {
+    std::string out = "{";
+    for (size_t i = 0; i < capacity; ++i) {
+        if (i) out += ", ";
+        out += i < seq.size() ? initializer(seq[i]) : "{}";
+    }
+    return out + "}";
+}
+
+static bool touchesFlags(const Sequence& seq) {
+    return std::any_of(seq.begin(), seq.end(), [](const Instr& in) { return writesFlags(in.op); });
+}
+
+static void writeHeader(const std::vector<Rule>& rules, const std::string& samplesFrom, size_t windows, std::ostream& out) {
+    out << "// Generated by tools/superopt.cpp; rerun it rather than editing. " << rules.size() << " rules.\n"
+        << "// Samples: " << (samplesFrom.empty() ? "none" : samplesFrom) << ", " << windows << " distinct windows.\n"
+        << "#ifndef SUPEROPT_RULES_H\n"
+        << "#define SUPEROPT_RULES_H\n\n"
+        << "#include \"asm_ir.h\"\n\n"
+        << "// Operands name slots 0-2, which bind to distinct registers, or take imm instead\n"
+        << "constexpr int8_t SUPEROPT_IMMEDIATE = " << static_cast<int>(IMMEDIATE) << ";\n"
+        << "constexpr int8_t SUPEROPT_NONE = " << static_cast<int>(ABSENT) << ";\n\n"
+        << "struct SuperoptInstr {\n"
+        << "    AsmIRNodeType op = AsmIRNodeType::NONE; // MOV, MOVZX, LEA, CMP, TEST, SET_CC or the Unary/Binary operator\n"
+        << "    int8_t src = SUPEROPT_NONE;             // Lea's base\n"
+        << "    int8_t index = SUPEROPT_NONE;           // Lea only\n"
+        << "    int8_t dst = SUPEROPT_NONE;\n"
+        << "    int32_t imm = 0;                        // immediate source, shift count or Lea displacement\n"
+        << "    int8_t scale = 1;\n"
+        << "    AsmIRCondCode cond = AsmIRCondCode::E;\n"
+        << "};\n\n"
+        << "// replacement leaves every slot as source does. Unless neither touches the flags, the\n"
+        << "// flags must be dead afterwards.\n"
+        << "struct SuperoptRule {\n"
+        << "    int sourceLength;\n"
+        << "    SuperoptInstr source[3];\n"
+        << "    int replacementLength;\n"
+        << "    SuperoptInstr replacement[2];\n"
+        << "    bool clobbersFlags;\n"
+        << "};\n\n"
+        << "static const SuperoptRule superoptRules[] = {\n";
+    for (const auto& rule : rules) {
+        out << "    // " << text(rule.source) << "  =>  " << text(rule.replacement);
+        if (rule.seen) out << "  (seen " << rule.seen << "x)";
+        out << "\n"
+            << "    {" << rule.source.size() << ", " << initializer(rule.source, 3) << ",\n"
+            << "     " << rule.replacement.size() << ", " << initializer(rule.replacement, 2) << ", "
+            << (touchesFlags(rule.source) || touchesFlags(rule.replacement) ? "true" : "false") << "},\n";
+    }
+    out << "};\n\n#endif\n";
+}
+
+int main(int argc, char* argv[]) {
+    // --samples-from=<text> records in the header where the samples came from
+    std::string samplesFrom;
+    int first = 1;
+    if (argc > 1 && std::string(argv[1]).compare(0, 15, "--samples-from=") == 0) samplesFrom = std::string(argv[first++]).substr(15);
+    if (argc <= first) {
+        std::cerr << "usage: antcc-superopt [--samples-from=<text>] <output header> [sample.s ...]\n";
+        return 1;
+    }
+    const char* header = argv[first];
+    std::vector<Window> windows = readSamples(argc - first - 1, argv + first + 1);
+    std::vector<Rule> rules = search(windows);
+    std::ofstream out(header);
+    if (!out) {
+        std::cerr << "cannot write " << header << "\n";
+        return 1;
+    }
+    writeHeader(rules, samplesFrom, windows.size(), out);
+    std::cerr << rules.size() << " rules from " << windows.size() << " sampled windows written to " << header << "\n";
+    return 0;
+}
@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+# Regenerates src/superopt_rules.h from a fixed sample corpus: writes PROGRAMS random int-only
+# programs from SEED, compiles each with antcc under every flag set in FLAG_SETS, and hands the
+# assembly to antcc-superopt. The samples are compiled with -fno-superopt-rules so they don't
+# depend on the rules being regenerated; the same antcc and seed always give the same header.
+# usage: tools/superopt_corpus.py <path to antcc> <path to antcc-superopt> <output header>
+import os
+import random
+import subprocess
+import sys
+import tempfile
+
+SEED = 48
+PROGRAMS = 300
+MAX_VARIABLES = 4
+FLAG_SETS = {
+    "fold": ["-fno-superopt-rules"],
+    "nofold": ["-fno-superopt-rules", "-fpass=-partial-eval,-sccp,-value-range,-gvn,-reassociate,-dce"],
+}
+CONSTANTS = [0, 1, 2, 3, 4, 5, 7, 8, 10, 16, 31, 100, 1000, 65536, 2147483647]
+BINARY_OPERATORS = ["+", "-", "*", "/", "%", "==", "!=", "<", "<=", ">", ">=", "&&", "||", "+", "*", "-"]
+
+
+def expression(rng, variables, depth):
+    if depth <= 0 or rng.random() < 0.2:
+        if variables and rng.random() < 0.6:
+            return rng.choice(variables)
+        return str(rng.choice(CONSTANTS + [rng.randint(0, 200)]))
+    if rng.random() < 0.15:
+        return "%s(%s)" % (rng.choice(["-", "~", "!"]), expression(rng, variables, depth - 1))
+    operator = rng.choice(BINARY_OPERATORS)
+    return "(%s %s %s)" % (expression(rng, variables, depth - 1), operator, expression(rng, variables, depth - 1))
+
+
+def program(rng):
+    variables, lines = [], []
+    for _ in range(rng.randint(1, MAX_VARIABLES)):
+        if variables and rng.random() < 0.35:
+            lines.append("    %s = %s;" % (rng.choice(variables), expression(rng, variables, rng.randint(1, 4))))
+        else:
+            name = "v%d" % len(variables)
+            lines.append("    int %s = %s;" % (name, expression(rng, variables, rng.randint(0, 4))))
+            variables.append(name)
+    lines.append("    return %s;" % expression(rng, variables, rng.randint(1, 5)))
+    return "int main(void) {\n" + "\n".join(lines) + "\n}\n"
+
+
+def main():
+    if len(sys.argv) != 4:
+        sys.exit("usage: superopt_corpus.py <antcc> <antcc-superopt> <output header>")
+    antcc, superopt, header = (os.path.abspath(arg) for arg in sys.argv[1:])
+    rng = random.Random(SEED)
+    samples = []
+    with tempfile.TemporaryDirectory() as work:
+        for i in range(PROGRAMS):
+            source = program(rng)
+            for name, flags in FLAG_SETS.items():
+                # antcc writes <name>.s into the working directory
+                directory = os.path.join(work, name)
+                os.makedirs(directory, exist_ok=True)
+                path = os.path.join(directory, "p%03d.c" % i)
+                with open(path, "w") as out:
+                    out.write(source)
+                subprocess.run([antcc, path, "--emit"] + flags, cwd=directory, check=True, stdout=subprocess.DEVNULL)
+                samples.append(path[:-2] + ".s")
+        provenance = "tools/superopt_corpus.py, seed %d, %d programs x %s" % (SEED, PROGRAMS, " + ".join(FLAG_SETS))
+        subprocess.run([superopt, "--samples-from=" + provenance, header] + samples, check=True)
+
+
+main()